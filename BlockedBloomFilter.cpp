@@ -0,0 +1,241 @@
+/** Filename: BlockedBloomFilter.cpp
+ *  Name: Loc Chuong
+ *  Userid: cs100sp19aj
+ *  Description: Bloom filter whose probes for an item all fall in one
+ *               64-byte block, so a lookup touches a single cache line.
+ *               Small amount of false positives is possible but there will
+ *               be no false negatives.
+ *  Date: 5/2/2019
+ */
+
+#include "BlockedBloomFilter.hpp"
+#include <algorithm>
+#include <cmath>
+#if defined(__SSE__) || defined(_M_X64)
+#include <xmmintrin.h>
+#define BLOOM_PREFETCH /** Blocks are prefetched with _mm_prefetch */
+#endif
+
+/** Odd multipliers that spread the low half of a hash over the words of a
+ *  block, one per word */
+static const uint32_t WORD_SALTS[BLOCK_WORDS] = {
+    0x47b6137bU, 0x44974d91U, 0x8824ad5bU, 0xa2b7289dU,
+    0x705495c7U, 0x2df1424bU, 0x9efc4947U, 0x5c6bfb31U
+};
+
+/* Constructor
+ * Description: Create a new blocked bloom filter with the size in bytes,
+ *              rounded up to whole blocks
+ * Parameters: numBytes - The number of bytes the bloom filter will have
+ */
+BlockedBloomFilter::BlockedBloomFilter(size_t numBytes) {
+    /** At least one block, so every hash has somewhere to go */
+    numBlocks = (numBytes + BLOCK_BYTES - 1) / BLOCK_BYTES;
+    if( numBlocks == 0) {
+        numBlocks = 1;
+    }
+    allocate();
+}
+
+/* Constructor
+ * Description: Create a new blocked bloom filter sized for a false positive
+ *              rate: the fewest blocks whose estimated rate, from the
+ *              number of items falling in each block, meets it. That takes
+ *              more bytes than a BloomFilter of the same rate.
+ * Parameters: expectedItems - The number of items to be inserted
+ *             fpRate - The false positive rate wanted once they are,
+ *                      clamped by BloomFilter::clampRate
+ */
+BlockedBloomFilter::BlockedBloomFilter(size_t expectedItems, double fpRate) {
+    fpRate = BloomFilter::clampRate(fpRate);
+    double items = expectedItems > 0 ? expectedItems : 1;
+    /** Blocks are never better than the classic -n ln(p) / ln(2)^2 bits,
+     *  which makes a lower bound to search up from */
+    double bits = -items * std::log(fpRate) / (std::log(2.0) * std::log(2.0));
+    uint64_t low = std::max(1.0, std::floor(bits / (BLOCK_BYTES *
+                    BYTE_WIDTH)));
+    uint64_t high = low;
+    while( falsePositiveRate(items / high) > fpRate) {
+        low = high;
+        high *= 2;
+    }
+    /** Fewest blocks meeting the rate, the rate falls as blocks are added */
+    while( low < high) {
+        uint64_t middle = low + (high - low) / 2;
+        if( falsePositiveRate(items / middle) > fpRate) {
+            low = middle + 1;
+        }
+        else {
+            high = middle;
+        }
+    }
+    numBlocks = high;
+    allocate();
+}
+
+/** Function Name: allocate()
+ *  Description: Creates the table of numBlocks blocks, all bits 0
+ */
+void BlockedBloomFilter::allocate() {
+    /** Aligned new keeps every block on its own cache line */
+    blocks = new BloomBlock[numBlocks];
+    for( uint64_t b = 0; b < numBlocks; b++) {
+        for( unsigned int i = 0; i < BLOCK_WORDS; i++) {
+            blocks[b].words[i].store(0, std::memory_order_relaxed);
+        }
+    }
+}
+
+/** Function Name: falsePositiveRate(double load)
+ *  Description: Estimated false positive rate of the filter. The items of a
+ *               block follow a Poisson law of mean load, and a block
+ *               holding c of them gives a false positive with probability
+ *               (1 - (1 - 1/64)^c)^8.
+ *  Parameters: load - Mean number of items per block
+ *  Return Value: The estimated false positive rate
+ */
+double BlockedBloomFilter::falsePositiveRate(double load) {
+    /** Loads further out than LOAD_SPREAD deviations add nothing visible */
+    double spread = LOAD_SPREAD * std::sqrt(load) + LOAD_SPREAD;
+    double first = std::max(0.0, std::floor(load - spread));
+    double rate = 0;
+    for( double c = first; c <= load + spread; c++) {
+        /** Poisson weight, in logs so large loads do not underflow */
+        double weight = std::exp(c * std::log(load) - load -
+                std::lgamma(c + 1));
+        double wordRate = 1 - std::pow(1 - 1.0 / TABLE_WORD_BITS, c);
+        rate += weight * std::pow(wordRate, BLOCK_WORDS);
+    }
+    return rate;
+}
+
+/* Function Name: insert(std::string_view item)
+ * Description: Insert an item into the bloom filter, setting one bit in
+ *              each word of its block
+ * Parameters: item - the string to hash and put into the bloom filter
+ * Return Value: None
+ */
+void BlockedBloomFilter::insert(std::string_view item) {
+    uint64_t hashValue = BloomFilter::hash(item);
+    BloomBlock & target = blocks[blockOf(hashValue)];
+    for( unsigned int i = 0; i < BLOCK_WORDS; i++) {
+        std::atomic<uint64_t> & word = target.words[i];
+        word.store(word.load(std::memory_order_relaxed) |
+                mask((uint32_t) hashValue, i), std::memory_order_relaxed);
+    }
+}
+
+/* Function Name: insertAtomic(std::string_view item)
+ * Description: insert that may run on several threads at once, ORing each
+ *              mask in with an atomic fetch_or, so the table ends the same
+ *              whatever the order of the inserts
+ * Parameters: item - the string to hash and put into the bloom filter
+ * Return Value: None
+ */
+void BlockedBloomFilter::insertAtomic(std::string_view item) {
+    uint64_t hashValue = BloomFilter::hash(item);
+    BloomBlock & target = blocks[blockOf(hashValue)];
+    for( unsigned int i = 0; i < BLOCK_WORDS; i++) {
+        target.words[i].fetch_or(mask((uint32_t) hashValue, i),
+                std::memory_order_relaxed);
+    }
+}
+
+/* Function Name: find(const std::string & item) const
+ * Description: Determine whether an item is in the bloom filter
+ * Parameters: item - the string to find in the bloom filter
+ * Return Value: True if item is found in bloom filter, false otherwise
+ */
+bool BlockedBloomFilter::find(const std::string & item) const {
+    uint64_t hashValue = BloomFilter::hash(item);
+    return contains(blocks[blockOf(hashValue)], hashValue);
+}
+
+/* Function Name: findBatch(const std::vector<std::string_view> & items)
+ *                      const
+ * Description: find for a block of items at once. Each BATCH_KEYS items are
+ *              hashed together and their blocks prefetched before any is
+ *              tested, so their cache misses overlap.
+ * Parameters: items - the strings to find in the bloom filter
+ * Return Value: Bitmap of the results, bit j % BITMAP_WORD_BITS of word
+ *               j / BITMAP_WORD_BITS set if items[j] is found
+ */
+std::vector<uint64_t> BlockedBloomFilter::findBatch(
+        const std::vector<std::string_view> & items) const {
+    std::vector<uint64_t> found((items.size() + BITMAP_WORD_BITS - 1) /
+            BITMAP_WORD_BITS, 0);
+    uint64_t hashes[BATCH_KEYS];
+    uint64_t targets[BATCH_KEYS];
+    for( size_t first = 0; first < items.size(); first += BATCH_KEYS) {
+        size_t count = min(items.size() - first, (size_t) BATCH_KEYS);
+        BloomFilter::hashBatch(items.data() + first, count, hashes);
+        for( size_t j = 0; j < count; j++) {
+            targets[j] = blockOf(hashes[j]);
+#ifdef BLOOM_PREFETCH
+            _mm_prefetch((const char *) &blocks[targets[j]], _MM_HINT_T0);
+#endif
+        }
+        for( size_t j = 0; j < count; j++) {
+            found[(first + j) / BITMAP_WORD_BITS] |=
+                (uint64_t) contains(blocks[targets[j]], hashes[j]) <<
+                (first + j) % BITMAP_WORD_BITS;
+        }
+    }
+    return found;
+}
+
+/* Function Name: memoryUsage() const
+ * Description: Size of the table of blocks
+ * Return Value: The number of bytes of the table
+ */
+size_t BlockedBloomFilter::memoryUsage() const {
+    return numBlocks * sizeof(BloomBlock);
+}
+
+/** Function Name: blockOf(uint64_t hashValue) const
+ *  Description: Block an item falls in, from the high half of its hash
+ *               scaled to the number of blocks without a division
+ *  Parameters: hashValue - The hash of the item
+ *  Return Value: Index of the block of the item
+ */
+uint64_t BlockedBloomFilter::blockOf(uint64_t hashValue) const {
+    return ((hashValue >> HALF_SHIFT) * numBlocks) >> HALF_SHIFT;
+}
+
+/** Function Name: contains(const BloomBlock & target, uint64_t hashValue)
+ *  Description: Whether every bit of an item is set in its block. Every
+ *               word is tested against its mask and the misses are ORed
+ *               together, so the loop has no branch to mispredict.
+ *  Parameters: target - The block of the item
+ *              hashValue - The hash of the item
+ *  Return Value: True if the item may be in the filter
+ */
+bool BlockedBloomFilter::contains(const BloomBlock & target,
+        uint64_t hashValue) {
+    uint64_t missing = 0;
+    for( unsigned int i = 0; i < BLOCK_WORDS; i++) {
+        uint64_t bit = mask((uint32_t) hashValue, i);
+        missing |= (target.words[i].load(std::memory_order_relaxed) & bit) ^
+            bit;
+    }
+    return missing == 0;
+}
+
+/** Function Name: mask(uint32_t key, unsigned int word)
+ *  Description: Bit of one word of the block set for an item, the top 6
+ *               bits of the key times the word's salt
+ *  Parameters: key - The low half of the item's hash
+ *              word - Index of the word in the block
+ *  Return Value: A word with that one bit set
+ */
+uint64_t BlockedBloomFilter::mask(uint32_t key, unsigned int word) {
+    uint32_t position = (uint32_t) (key * WORD_SALTS[word]) >> WORD_BIT_SHIFT;
+    return (uint64_t) 1 << position;
+}
+
+/* Destructor
+ * Description: Destructor for the blocked bloom filter
+ */
+BlockedBloomFilter::~BlockedBloomFilter() {
+    delete[] blocks;
+}
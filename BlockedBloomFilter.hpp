@@ -0,0 +1,161 @@
+/** Filename: BlockedBloomFilter.hpp
+ *  Name: Loc Chuong
+ *  Userid: cs100sp19aj
+ *  Description: Bloom filter whose probes for an item all fall in one
+ *               64-byte block, so a lookup touches a single cache line.
+ *               Small amount of false positives is possible but there will
+ *               be no false negatives.
+ *  Date: 5/2/2019
+ */
+
+#ifndef BLOCKED_BLOOM_FILTER_HPP
+#define BLOCKED_BLOOM_FILTER_HPP
+
+#include "BloomFilter.hpp"
+#include <atomic>
+#include <cstdint>
+#include <string>
+#include <string_view>
+#include <vector>
+#define BLOCK_BYTES 64 /** Size of a block, one cache line */
+#define BLOCK_WORDS 8 /** 64-bit words of a block, one probe bit in each */
+#define WORD_BIT_SHIFT 26 /** Shift leaving the top 6 bits of a salted key */
+#define LOAD_SPREAD 12 /** Standard deviations of block load summed over */
+
+using namespace std;
+
+/** Struct BloomBlock
+ *  Description: One cache line of the filter, aligned so it never
+ *               straddles two
+ */
+struct alignas(BLOCK_BYTES) BloomBlock {
+    std::atomic<uint64_t> words[BLOCK_WORDS]; /** Bits of the block */
+};
+
+/** Class Name: BlockedBloomFilter
+ *  Description: Split block Bloom filter. The 64-bit hash of an item, the
+ *               one BloomFilter uses, picks its block with its high half,
+ *               and its low half is multiplied by BLOCK_WORDS odd salts to
+ *               pick one bit in each word of the block. An insert ORs a
+ *               mask into every word and a lookup tests every word against
+ *               its mask, one cache miss in all where BloomFilter takes up
+ *               to k.
+ */
+class BlockedBloomFilter {
+
+    public:
+
+        /* Constructor
+         * Description: Create a new blocked bloom filter with the size in
+         *              bytes, rounded up to whole blocks
+         * Parameters: numBytes - The number of bytes the bloom filter will
+         *                        have
+         */
+        BlockedBloomFilter(size_t numBytes);
+
+        /* Constructor
+         * Description: Create a new blocked bloom filter sized for a false
+         *              positive rate: the fewest blocks whose estimated
+         *              rate, from the number of items falling in each
+         *              block, meets it. That takes more bytes than a
+         *              BloomFilter of the same rate.
+         * Parameters: expectedItems - The number of items to be inserted
+         *             fpRate - The false positive rate wanted once they
+         *                      are, clamped by BloomFilter::clampRate
+         */
+        BlockedBloomFilter(size_t expectedItems, double fpRate);
+
+        /* Function Name: insert(std::string_view item)
+         * Description: Insert an item into the bloom filter, setting one bit
+         *              in each word of its block
+         * Parameters: item - the string to hash and put into the bloom filter
+         * Return Value: None
+         */
+        void insert(std::string_view item);
+
+        /* Function Name: insertAtomic(std::string_view item)
+         * Description: insert that may run on several threads at once,
+         *              ORing each mask in with an atomic fetch_or
+         * Parameters: item - the string to hash and put into the bloom filter
+         * Return Value: None
+         */
+        void insertAtomic(std::string_view item);
+
+        /* Function Name: find(const std::string & item) const
+         * Description: Determine whether an item is in the bloom filter
+         * Parameters: item - the string to find in the bloom filter
+         * Return Value: True if item is found in bloom filter, false otherwise
+         */
+        bool find(const std::string & item) const;
+
+        /* Function Name: findBatch(const std::vector<std::string_view> &
+         *                      items) const
+         * Description: find for a block of items at once, the blocks of
+         *              BATCH_KEYS items prefetched before any is tested
+         * Parameters: items - the strings to find in the bloom filter
+         * Return Value: Bitmap of the results, bit j % BITMAP_WORD_BITS of
+         *               word j / BITMAP_WORD_BITS set if items[j] is found
+         */
+        std::vector<uint64_t> findBatch(
+                const std::vector<std::string_view> & items) const;
+
+        /* Function Name: memoryUsage() const
+         * Description: Size of the table of blocks
+         * Return Value: The number of bytes of the table
+         */
+        size_t memoryUsage() const;
+
+        BlockedBloomFilter(const BlockedBloomFilter &) = delete;
+        BlockedBloomFilter & operator=(const BlockedBloomFilter &) = delete;
+
+        /* Destructor
+         * Description: Destructor for the blocked bloom filter
+         */
+        ~BlockedBloomFilter();
+
+    private:
+
+        BloomBlock* blocks; /** Table of blocks */
+        uint64_t numBlocks; /** Number of blocks in the table */
+
+        /** Function Name: allocate()
+         *  Description: Creates the table of numBlocks blocks, all bits 0
+         */
+        void allocate();
+
+        /** Function Name: falsePositiveRate(double load)
+         *  Description: Estimated false positive rate of the filter. The
+         *               items of a block follow a Poisson law of mean load,
+         *               and a block holding c of them gives a false
+         *               positive with probability (1 - (1 - 1/64)^c)^8.
+         *  Parameters: load - Mean number of items per block
+         *  Return Value: The estimated false positive rate
+         */
+        static double falsePositiveRate(double load);
+
+        /** Function Name: blockOf(uint64_t hashValue) const
+         *  Description: Block an item falls in, from the high half of its
+         *               hash scaled to the number of blocks
+         *  Parameters: hashValue - The hash of the item
+         *  Return Value: Index of the block of the item
+         */
+        uint64_t blockOf(uint64_t hashValue) const;
+
+        /** Function Name: contains(const BloomBlock & target,
+         *                      uint64_t hashValue)
+         *  Description: Whether every bit of an item is set in its block
+         *  Parameters: target - The block of the item
+         *              hashValue - The hash of the item
+         *  Return Value: True if the item may be in the filter
+         */
+        static bool contains(const BloomBlock & target, uint64_t hashValue);
+
+        /** Function Name: mask(uint32_t key, unsigned int word)
+         *  Description: Bit of one word of the block set for an item
+         *  Parameters: key - The low half of the item's hash
+         *              word - Index of the word in the block
+         *  Return Value: A word with that one bit set
+         */
+        static uint64_t mask(uint32_t key, unsigned int word);
+};
+#endif // BLOCKED_BLOOM_FILTER_HPP
@@ -9,127 +9,480 @@
  */
 
 #include "BloomFilter.hpp"
+#include <algorithm>
 #include <iostream>
 #include <string.h>
+#include <cmath>
+#ifdef __AVX2__
+#include <immintrin.h>
+#define BLOOM_AVX2 /** Items are hashed in the lanes of AVX2 registers */
+#define REGISTER_LANES 4 /** 64-bit lanes of an AVX2 register */
+#define LANE_REGISTERS 4 /** Registers hashed side by side */
+#define HASH_LANES 16 /** Items hashed at once, REGISTER_LANES in each of
+                       *  LANE_REGISTERS registers */
+#define WORD_BYTES 8 /** Chars of an item loaded into a lane at once */
+#endif
+#if defined(__SSE__) || defined(_M_X64)
+#include <xmmintrin.h>
+#define BLOOM_PREFETCH /** Bits are prefetched with _mm_prefetch */
+#endif
+#define FNV64_PRIME_SHIFT 40 /** FNV64_PRIME is 2^40 plus its low word */
+#define FMIX_SHIFT 33 /** Shift of the MurmurHash3 finalizer */
+#define FMIX_MULT1 0xff51afd7ed558ccdULL /** First finalizer multiplier */
+#define FMIX_MULT2 0xc4ceb9fe1a85ec53ULL /** Second finalizer multiplier */
+
+/** Function Name: prefetch(const void * address)
+ *  Description: Asks for the cache line of address ahead of its use, a
+ *               no-op where the target has no prefetch instruction
+ *  Parameters: address - Memory about to be read
+ */
+static inline void prefetch(const void * address) {
+#ifdef BLOOM_PREFETCH
+    _mm_prefetch((const char *) address, _MM_HINT_T0);
+#else
+    (void) address;
+#endif
+}
+
+#ifdef BLOOM_AVX2
+/** Function Name: mulFnvPrime(__m256i x)
+ *  Description: x * FNV64_PRIME in every lane. AVX2 has no 64-bit multiply,
+ *               but the prime is 2^40 + 0x1b3, so it takes a shift and two
+ *               32-bit multiplies.
+ *  Parameters: x - Four 64-bit values
+ *  Return Value: The products, modulo 2^64
+ */
+static inline __m256i mulFnvPrime(__m256i x) {
+    const __m256i low = _mm256_set1_epi64x(FNV64_PRIME & 0xffffffffULL);
+    __m256i product = _mm256_mul_epu32(x, low);
+    __m256i high = _mm256_mul_epu32(_mm256_srli_epi64(x, HALF_SHIFT), low);
+    product = _mm256_add_epi64(product, _mm256_slli_epi64(high, HALF_SHIFT));
+    return _mm256_add_epi64(product, _mm256_slli_epi64(x, FNV64_PRIME_SHIFT));
+}
+
+/** Function Name: mul64(__m256i x, uint64_t y)
+ *  Description: x * y in every lane from three 32-bit multiplies
+ *  Parameters: x - Four 64-bit values
+ *              y - The multiplier
+ *  Return Value: The products, modulo 2^64
+ */
+static inline __m256i mul64(__m256i x, uint64_t y) {
+    const __m256i low = _mm256_set1_epi64x(y & 0xffffffffULL);
+    const __m256i high = _mm256_set1_epi64x(y >> HALF_SHIFT);
+    __m256i cross = _mm256_add_epi64(
+            _mm256_mul_epu32(_mm256_srli_epi64(x, HALF_SHIFT), low),
+            _mm256_mul_epu32(x, high));
+    return _mm256_add_epi64(_mm256_mul_epu32(x, low),
+            _mm256_slli_epi64(cross, HALF_SHIFT));
+}
+
+/** Function Name: fnvStep(__m256i hashValue, __m256i word, unsigned int i)
+ *  Description: One FNV-1A step in every lane, on char i of its word
+ *  Parameters: hashValue - Four hashes so far
+ *              word - Four words of chars, the first in the lowest byte
+ *              i - Which char of the words
+ *  Return Value: The hashes with the chars added
+ */
+static inline __m256i fnvStep(__m256i hashValue, __m256i word,
+        unsigned int i) {
+    __m256i c = _mm256_and_si256(_mm256_srli_epi64(word, i * BYTE_WIDTH),
+            _mm256_set1_epi64x(0xff));
+    return mulFnvPrime(_mm256_xor_si256(hashValue, c));
+}
+
+/** Function Name: finalize(__m256i hashValue)
+ *  Description: Finalizer of MurmurHash3 in every lane, as in hash
+ *  Parameters: hashValue - Four FNV-1A hashes
+ *  Return Value: The mixed hashes
+ */
+static inline __m256i finalize(__m256i hashValue) {
+    hashValue = _mm256_xor_si256(hashValue,
+            _mm256_srli_epi64(hashValue, FMIX_SHIFT));
+    hashValue = mul64(hashValue, FMIX_MULT1);
+    hashValue = _mm256_xor_si256(hashValue,
+            _mm256_srli_epi64(hashValue, FMIX_SHIFT));
+    hashValue = mul64(hashValue, FMIX_MULT2);
+    return _mm256_xor_si256(hashValue,
+            _mm256_srli_epi64(hashValue, FMIX_SHIFT));
+}
+
+/** Function Name: loadChars(std::string_view item, size_t pos)
+ *  Description: Up to WORD_BYTES chars of an item from pos, the first in
+ *               the lowest byte and zeros past its end
+ *  Parameters: item - The string to read
+ *              pos - Index of the first char
+ *  Return Value: The chars packed in a word
+ */
+static inline uint64_t loadChars(std::string_view item, size_t pos) {
+    uint64_t word = 0;
+    if( item.size() >= pos + WORD_BYTES) {
+        memcpy(&word, item.data() + pos, WORD_BYTES);
+    }
+    else if( item.size() > pos && item.size() >= WORD_BYTES) {
+        /** The last WORD_BYTES chars, shifted down past those before pos */
+        memcpy(&word, item.data() + item.size() - WORD_BYTES, WORD_BYTES);
+        word >>= (pos + WORD_BYTES - item.size()) * BYTE_WIDTH;
+    }
+    else {
+        for( size_t i = pos; i < item.size(); i++) {
+            word |= (uint64_t) (unsigned char) item[i] <<
+                (i - pos) * BYTE_WIDTH;
+        }
+    }
+    return word;
+}
+
+/** Function Name: laneWords(const std::string_view * items, size_t pos)
+ *  Description: WORD_BYTES chars from pos of REGISTER_LANES items, one per
+ *               lane. Built in a register, as a store of the lanes read
+ *               back as a vector would stall store forwarding.
+ *  Parameters: items - REGISTER_LANES strings
+ *              pos - Index of the first char
+ *  Return Value: The words of chars of the items
+ */
+static inline __m256i laneWords(const std::string_view * items, size_t pos) {
+    return _mm256_set_epi64x(loadChars(items[3], pos),
+            loadChars(items[2], pos), loadChars(items[1], pos),
+            loadChars(items[0], pos));
+}
+
+/** Function Name: laneLeft(const std::string_view * items, size_t pos)
+ *  Description: Chars of REGISTER_LANES items from pos, one per lane
+ *  Parameters: items - REGISTER_LANES strings
+ *              pos - Index of the first char
+ *  Return Value: The size of each item less pos, negative past its end
+ */
+static inline __m256i laneLeft(const std::string_view * items, size_t pos) {
+    return _mm256_sub_epi64(_mm256_set_epi64x(items[3].size(),
+                items[2].size(), items[1].size(), items[0].size()),
+            _mm256_set1_epi64x(pos));
+}
+
+/** Function Name: hashLanes(const std::string_view * items,
+ *                      uint64_t * hashes)
+ *  Description: BloomFilter::hash of HASH_LANES items, one per lane of
+ *               LANE_REGISTERS registers. Each lane loads WORD_BYTES chars
+ *               of its item at a time and feeds them to FNV-1A one by one;
+ *               past the end of a shorter item its lane keeps its hash
+ *               unchanged. The registers are independent, so the latency
+ *               of one's multiplies is hidden behind the others'. They are
+ *               named one by one rather than looped over so they stay in
+ *               registers without relying on the compiler to unroll.
+ *  Parameters: items - HASH_LANES strings to hash
+ *              hashes - Where the hash of each item is written
+ */
+static void hashLanes(const std::string_view * items, uint64_t * hashes) {
+    size_t longest = 0;
+    size_t shortest = items[0].size();
+    for( unsigned int lane = 0; lane < HASH_LANES; lane++) {
+        longest = max(longest, items[lane].size());
+        shortest = min(shortest, items[lane].size());
+    }
+    const std::string_view * items1 = items + REGISTER_LANES;
+    const std::string_view * items2 = items1 + REGISTER_LANES;
+    const std::string_view * items3 = items2 + REGISTER_LANES;
+    __m256i hash0 = _mm256_set1_epi64x(FNV64_OFFSET);
+    __m256i hash1 = hash0;
+    __m256i hash2 = hash0;
+    __m256i hash3 = hash0;
+    for( size_t pos = 0; pos < longest; pos += WORD_BYTES) {
+        __m256i word0 = laneWords(items, pos);
+        __m256i word1 = laneWords(items1, pos);
+        __m256i word2 = laneWords(items2, pos);
+        __m256i word3 = laneWords(items3, pos);
+        if( shortest >= pos + WORD_BYTES) {
+            /** Every lane has a whole word left, no lane stops */
+            for( unsigned int i = 0; i < WORD_BYTES; i++) {
+                hash0 = fnvStep(hash0, word0, i);
+                hash1 = fnvStep(hash1, word1, i);
+                hash2 = fnvStep(hash2, word2, i);
+                hash3 = fnvStep(hash3, word3, i);
+            }
+            continue;
+        }
+        __m256i left0 = laneLeft(items, pos);
+        __m256i left1 = laneLeft(items1, pos);
+        __m256i left2 = laneLeft(items2, pos);
+        __m256i left3 = laneLeft(items3, pos);
+        for( unsigned int i = 0; i < WORD_BYTES; i++) {
+            /** Only lanes with a char at this position move on */
+            __m256i position = _mm256_set1_epi64x(i);
+            hash0 = _mm256_blendv_epi8(hash0, fnvStep(hash0, word0, i),
+                    _mm256_cmpgt_epi64(left0, position));
+            hash1 = _mm256_blendv_epi8(hash1, fnvStep(hash1, word1, i),
+                    _mm256_cmpgt_epi64(left1, position));
+            hash2 = _mm256_blendv_epi8(hash2, fnvStep(hash2, word2, i),
+                    _mm256_cmpgt_epi64(left2, position));
+            hash3 = _mm256_blendv_epi8(hash3, fnvStep(hash3, word3, i),
+                    _mm256_cmpgt_epi64(left3, position));
+        }
+    }
+    _mm256_storeu_si256((__m256i *) hashes, finalize(hash0));
+    _mm256_storeu_si256((__m256i *) (hashes + REGISTER_LANES),
+            finalize(hash1));
+    _mm256_storeu_si256((__m256i *) (hashes + 2 * REGISTER_LANES),
+            finalize(hash2));
+    _mm256_storeu_si256((__m256i *) (hashes + 3 * REGISTER_LANES),
+            finalize(hash3));
+}
+#endif
 
 /* Constructor
- * Description: Create a new bloom filter with the size in bytes
+ * Description: Create a new bloom filter with the size in bytes, setting
+ *              DEFAULT_HASHES bits per item
  * Parameters: numBytes - The number of bytes the bloom filter will have
  */
-BloomFilter::BloomFilter(size_t numBytes) {
+BloomFilter::BloomFilter(size_t numBytes) : numHashes(DEFAULT_HASHES) {
+    /** At least one byte, so every hash has somewhere to go */
+    if( numBytes == 0) {
+        numBytes = 1;
+    }
     /** Transfer numBytes to number of bits and assign to numSlots in table */
     numSlots = (numBytes * BYTE_WIDTH);
-    /** Initialize new unsigned char array to table with size numBytes */
-    table = new unsigned char[numBytes];
-    /** Set all elements in table to be 0 */
-    memset(table, 0, numBytes);
+    /** Initialize the words of the table to be 0 */
+    allocate();
+}
+
+/* Constructor
+ * Description: Create a new bloom filter sized for a false positive rate:
+ *              m = -n ln(p) / ln(2)^2 bits and k = m/n ln(2) bits per item,
+ *              the optimum for n items
+ * Parameters: expectedItems - The number of items to be inserted
+ *             fpRate - The false positive rate wanted once they are,
+ *                      clamped by clampRate
+ */
+BloomFilter::BloomFilter(size_t expectedItems, double fpRate) {
+    fpRate = clampRate(fpRate);
+    double items = expectedItems > 0 ? expectedItems : 1;
+    double bits = std::ceil(-items * std::log(fpRate) /
+            (std::log(2.0) * std::log(2.0)));
+    /** Whole bytes, at least one */
+    size_t numBytes = bits > BYTE_WIDTH ?
+        (size_t) std::ceil(bits / BYTE_WIDTH) : 1;
+    numSlots = (uint64_t) numBytes * BYTE_WIDTH;
+    double hashes = std::round((double) numSlots / items * std::log(2.0));
+    numHashes = hashes < 1 ? 1 : hashes > MAX_HASHES ? MAX_HASHES :
+        (unsigned int) hashes;
+    allocate();
 }
 
-/* Function Name: insert(std::string item)
- * Description: Insert an item into the bloom filter using hashing funcs
+/* Function Name: insert(std::string_view item)
+ * Description: Insert an item into the bloom filter, setting its k bits.
+ *              Each word is read and written back, cheaper than an atomic
+ *              OR but losing bits if another thread writes it in between.
  * Parameters: item - the string to hash and put into the bloom filter
  * Return Value: None
  */
-void BloomFilter::insert(std::string item) {
-    /** Find the hash value for the hash function FNV-1A */
-    unsigned int hashVal_FNV = FNV1AHash(item) % numSlots;
-    /** Set the bit using FNV-1A hash value*/
-    table[hashVal_FNV/BYTE_WIDTH] |= (UNSIGNED_INT_BIT 
-            << (hashVal_FNV%BYTE_WIDTH));
-    /** Find the hash value for the hash function CRC */
-    unsigned int hashVal_CRC = CRCHash(item) % numSlots;
-    /** Set the bit using CRC hash value*/
-    table[hashVal_CRC/BYTE_WIDTH] |= (UNSIGNED_INT_BIT 
-            << (hashVal_CRC%BYTE_WIDTH));
-    /** Find the hash value for the hash function SBDM */
-    unsigned int hashVal_SBDM = SBDMHash(item) % numSlots;
-    /** Set the bit using SBDM hash value*/
-    table[hashVal_SBDM/BYTE_WIDTH] |= (UNSIGNED_INT_BIT 
-            << (hashVal_SBDM%BYTE_WIDTH));
-}
-
-/* Function Name: find(std::string item)
- * Description: Determine whether an item is in the bloom filter
+void BloomFilter::insert(std::string_view item) {
+    /** One pass over the item gives every bit */
+    uint64_t hashValue = hash(item);
+    for( unsigned int i = 0; i < numHashes; i++) {
+        uint64_t bit = slot(hashValue, i);
+        std::atomic<uint64_t> & word = table[bit/TABLE_WORD_BITS];
+        word.store(word.load(std::memory_order_relaxed) |
+                (uint64_t) 1 << bit%TABLE_WORD_BITS,
+                std::memory_order_relaxed);
+    }
+}
+
+/* Function Name: insertAtomic(std::string_view item)
+ * Description: insert that may run on several threads at once, each bit
+ *              set with an atomic fetch_or on its word. OR is commutative,
+ *              so the table ends the same whatever the order of the
+ *              inserts. Relaxed order is enough: the bits are only read
+ *              once the inserting threads are joined.
+ * Parameters: item - the string to hash and put into the bloom filter
+ * Return Value: None
+ */
+void BloomFilter::insertAtomic(std::string_view item) {
+    uint64_t hashValue = hash(item);
+    for( unsigned int i = 0; i < numHashes; i++) {
+        uint64_t bit = slot(hashValue, i);
+        table[bit/TABLE_WORD_BITS].fetch_or(
+                (uint64_t) 1 << bit%TABLE_WORD_BITS,
+                std::memory_order_relaxed);
+    }
+}
+
+/* Function Name: find(const std::string & item) const
+ * Description: Determine whether an item is in the bloom filter, stopping
+ *              at the first of its bits that is not set
  * Parameters: item - the string to find in the bloom filter
  * Return Value: True if item is found in bloom filter, false otherwise
  */
-bool BloomFilter::find(std::string item) {
-    /** Find the hash value for the hash function FNV-1A */
-    unsigned int hashVal_FNV = FNV1AHash(item) % numSlots;
-    if( ((table[hashVal_FNV/BYTE_WIDTH] >> hashVal_FNV%BYTE_WIDTH) & 
-                UNSIGNED_INT_BIT) != UNSIGNED_INT_BIT) {
-        return false;
-    }
-    /** Find the hash value for the hash function CRC */
-    unsigned int hashVal_CRC = CRCHash(item) % numSlots;
-    if( ((table[hashVal_CRC/BYTE_WIDTH] >> hashVal_CRC%BYTE_WIDTH) & 
-                UNSIGNED_INT_BIT) != UNSIGNED_INT_BIT) {
-        return false;
-    }
-    /** Find the hash value for the hash function SBDM */
-    unsigned int hashVal_SBDM = SBDMHash(item) % numSlots;
-    if( ((table[hashVal_SBDM/BYTE_WIDTH] >> hashVal_SBDM%BYTE_WIDTH) & 
-                UNSIGNED_INT_BIT) != UNSIGNED_INT_BIT) {
-        return false;
+bool BloomFilter::find(const std::string & item) const {
+    uint64_t hashValue = hash(item);
+    for( unsigned int i = 0; i < numHashes; i++) {
+        uint64_t bit = slot(hashValue, i);
+        if( ((table[bit/TABLE_WORD_BITS].load(std::memory_order_relaxed) >>
+                        bit%TABLE_WORD_BITS) & 1U) != 1U) {
+            return false;
+        }
     }
     return true;
 }
 
-/** Function Name: FNV1AHash(const std::string & item)
- *  Description: Uses the FNV1A-Hash algorithm to hash a string object into an
- *               unsigned int
- *  Parameters: item - String object to hash into an unsigned int
- *  Return Value: A hash key created using item in the form of an unsigned int
+/* Function Name: findBatch(const std::vector<std::string_view> & items)
+ *                      const
+ * Description: find for a block of items at once. Each BATCH_KEYS items
+ *              are hashed together, the k bits of every one of them are
+ *              prefetched, and only then are the bits tested, so up to
+ *              BATCH_KEYS * k cache misses are in flight at once where
+ *              find waits for each in turn.
+ * Parameters: items - the strings to find in the bloom filter
+ * Return Value: Bitmap of the results, bit j % BITMAP_WORD_BITS of word
+ *               j / BITMAP_WORD_BITS set if items[j] is found
+ */
+std::vector<uint64_t> BloomFilter::findBatch(
+        const std::vector<std::string_view> & items) const {
+    std::vector<uint64_t> found((items.size() + BITMAP_WORD_BITS - 1) /
+            BITMAP_WORD_BITS, 0);
+    uint64_t hashes[BATCH_KEYS];
+    /** Bits of the batch, found once and used to prefetch and to test */
+    uint64_t bits[BATCH_KEYS * MAX_HASHES];
+    for( size_t first = 0; first < items.size(); first += BATCH_KEYS) {
+        size_t count = min(items.size() - first, (size_t) BATCH_KEYS);
+        hashBatch(items.data() + first, count, hashes);
+        for( size_t j = 0; j < count; j++) {
+            for( unsigned int i = 0; i < numHashes; i++) {
+                uint64_t bit = slot(hashes[j], i);
+                bits[j * numHashes + i] = bit;
+                prefetch(table + bit/TABLE_WORD_BITS);
+            }
+        }
+        for( size_t j = 0; j < count; j++) {
+            /** Every bit is tested, the misses already overlap */
+            unsigned int all = 1U;
+            for( unsigned int i = 0; i < numHashes; i++) {
+                uint64_t bit = bits[j * numHashes + i];
+                all &= table[bit/TABLE_WORD_BITS].load(
+                        std::memory_order_relaxed) >> bit%TABLE_WORD_BITS;
+            }
+            found[(first + j) / BITMAP_WORD_BITS] |=
+                (uint64_t) (all & 1U) << (first + j) % BITMAP_WORD_BITS;
+        }
+    }
+    return found;
+}
+
+/* Function Name: hashCount() const
+ * Description: Number of bits set per item
+ * Return Value: k
+ */
+unsigned int BloomFilter::hashCount() const {
+    return numHashes;
+}
+
+/* Function Name: memoryUsage() const
+ * Description: Size of the hash table
+ * Return Value: The number of bytes of the table
+ */
+size_t BloomFilter::memoryUsage() const {
+    return numWords * sizeof(std::atomic<uint64_t>);
+}
+
+/** Function Name: hash(std::string_view item)
+ *  Description: FNV-1A over the item in 64 bits, then mixed so both halves
+ *               depend on every char
+ *  Parameters: item - String to hash
+ *  Return Value: A 64-bit hash of item
  *  Source(s) of Help: isthe.com/chongo/tech/comp/fnv/
  */
-unsigned int BloomFilter::FNV1AHash(const std::string & item) {
-    /** Initialize initial FNV hash value */
-    unsigned int hashValue = INITIAL_FNV;
-    /** Perform hashing operation on each character of the string */
-    for( string::const_iterator i = item.begin(); i != item.end(); i++) {
-        hashValue = hashValue ^ *i;
-        hashValue = hashValue * FNV_PRIME;
+uint64_t BloomFilter::hash(std::string_view item) {
+    uint64_t hashValue = FNV64_OFFSET;
+    for( std::string_view::const_iterator i = item.begin(); i != item.end();
+            i++) {
+        hashValue = (hashValue ^ (unsigned char) *i) * FNV64_PRIME;
     }
+    /** Finalizer of MurmurHash3, the low chars barely reach the high bits
+     *  of FNV-1A otherwise */
+    hashValue ^= hashValue >> FMIX_SHIFT;
+    hashValue *= FMIX_MULT1;
+    hashValue ^= hashValue >> FMIX_SHIFT;
+    hashValue *= FMIX_MULT2;
+    hashValue ^= hashValue >> FMIX_SHIFT;
     return hashValue;
 }
 
-/** Function Name: CRCHash(const std::string & item)
- *  Description: Uses the CRC hash algorithmn to hash a string object into an
- *               unsigned int
- *  Parameters: item - String object to hash into an unsigned int
- *  Return Value: A hash key created using item in the form of an unsigned int
- *  Source(s) of Help: Sample_hash_functions.docx from PA2 writeup (First link)
- *                     https://drive.google.com/file/d/1elgi1e1nU9gZxmJcl9Rax
- *                     gryZBnxooVT/view
- */
-unsigned int BloomFilter::CRCHash(const std::string & item) {
-    /** Initialize initial CRC hash value */
-    unsigned int hashValue = 0;
-    /** Perform hashing operation on each character of the string */
-    for( string::const_iterator i = item.begin(); i != item.end(); i++) {
-        unsigned int leftShift = hashValue << CRC_HASH_SHIFT;
-        unsigned int rightShift = hashValue >> (WORD_WIDTH - CRC_HASH_SHIFT);
-        hashValue = (leftShift | rightShift) ^ (unsigned)*i;
+/** Function Name: hashBatch(const std::string_view * items, size_t count,
+ *                      uint64_t * hashes)
+ *  Description: hash of several items, HASH_LANES at a time with AVX2 and
+ *               the rest one by one
+ *  Parameters: items - Strings to hash
+ *              count - Number of items
+ *              hashes - Where the hash of each item is written
+ */
+void BloomFilter::hashBatch(const std::string_view * items, size_t count,
+        uint64_t * hashes) {
+    size_t j = 0;
+#ifdef BLOOM_AVX2
+    for( ; j + HASH_LANES <= count; j += HASH_LANES) {
+        hashLanes(items + j, hashes + j);
+    }
+#endif
+    for( ; j < count; j++) {
+        hashes[j] = hash(items[j]);
     }
-    return hashValue;
 }
 
-/** Function Name: SBDMHash(const std::string & item)
- *  Description: Uses the SBDM hash algorithmn to hash a string object into an
- *               unsigned int
- *  Parameters: item - String object to hash into an unsigned int
- *  Return Value: A hash key created using item in the form of an unsigned int
- *  Source(s) of Help: www.cse.yorku.ca/~oz/hash.html
+/* Function Name: operator==(const BloomFilter & other) const
+ * Description: Whether two filters have the same size, number of hashes
+ *              and bits, so hold the same items as far as find can tell
+ * Parameters: other - The filter to compare with
+ * Return Value: True if every bit of the tables matches
  */
-unsigned int BloomFilter::SBDMHash(const std::string & item) {
-    /** Initialize initial SBDM hash value */
-    unsigned int hashValue = 0;
-    /** Perform hasing operation on each character of the string */
-    for( string::const_iterator i = item.begin(); i != item.end(); i++) {
-        hashValue = (*i) + (hashValue << SBDM_HASH_FIRST_SHIFT) 
-            + (hashValue << SBDM_HASH_SECOND_SHIFT) - hashValue;
+bool BloomFilter::operator==(const BloomFilter & other) const {
+    if( numSlots != other.numSlots || numHashes != other.numHashes) {
+        return false;
     }
-    return hashValue;
+    for( size_t i = 0; i < numWords; i++) {
+        if( table[i].load(std::memory_order_relaxed) !=
+                other.table[i].load(std::memory_order_relaxed)) {
+            return false;
+        }
+    }
+    return true;
+}
+
+/** Function Name: allocate()
+ *  Description: Creates the table of numSlots bits, all 0, in whole words
+ */
+void BloomFilter::allocate() {
+    numWords = (numSlots + TABLE_WORD_BITS - 1) / TABLE_WORD_BITS;
+    table = new std::atomic<uint64_t>[numWords];
+    for( size_t i = 0; i < numWords; i++) {
+        table[i].store(0, std::memory_order_relaxed);
+    }
+}
+
+/** Function Name: slot(uint64_t hashValue, unsigned int i) const
+ *  Description: Bit i of an item, h1 + i * h2 wrapped to the table. h1 is
+ *               the whole hash, so bit 0 reaches every slot of a table over
+ *               2^32 bits, and h2 its high half made odd so the bits of an
+ *               item differ even when the table size is a power of two.
+ *  Parameters: hashValue - The hash of the item
+ *              i - Which of its k bits
+ *  Return Value: The index of the bit in the table
+ */
+uint64_t BloomFilter::slot(uint64_t hashValue, unsigned int i) const {
+    uint64_t h1 = hashValue;
+    uint64_t h2 = (hashValue >> HALF_SHIFT) | 1U;
+    return (h1 + i * h2) % numSlots;
+}
+
+/** Function Name: clampRate(double fpRate)
+ *  Description: A false positive rate moved into [MIN_FP_RATE,
+ *               MAX_FP_RATE], so a rate of 0, 1 or out of range still sizes
+ *               a finite table
+ *  Parameters: fpRate - The rate asked for
+ *  Return Value: The rate a filter is sized for
+ */
+double BloomFilter::clampRate(double fpRate) {
+    /** Written so a NaN rate fails the test and is clamped too */
+    if( !(fpRate >= MIN_FP_RATE)) {
+        return MIN_FP_RATE;
+    }
+    return fpRate > MAX_FP_RATE ? MAX_FP_RATE : fpRate;
 }
 
 /* Destructor
@@ -11,15 +11,26 @@
 #ifndef BLOOM_FILTER_HPP
 #define BLOOM_FILTER_HPP
 
+#include <atomic>
+#include <cstdint>
 #include <string>
+#include <string_view>
+#include <vector>
 #define BYTE_WIDTH 8 /** Num of bits for one byte */
 #define INITIAL_FNV 216613621 /** Inital hash value for FNV-1A hash func */
 #define FNV_PRIME 16777619 /** Multiplication value for FNV-1A hash func */
-#define CRC_HASH_SHIFT 5 /** Shift value for CRC hash func */
-#define SBDM_HASH_FIRST_SHIFT 6 /** First shift value for SBDM hash func */
-#define SBDM_HASH_SECOND_SHIFT 16 /** Second shift value for SBDM hash func */
-#define UNSIGNED_INT_BIT 1U /** Unsigned int with first bit set */
-#define WORD_WIDTH sizeof(int)*BYTE_WIDTH /** Num of bits in a machine word */
+#define FNV64_OFFSET 14695981039346656037ULL /** FNV-1A 64-bit basis */
+#define FNV64_PRIME 1099511628211ULL /** FNV-1A 64-bit multiplier */
+#define HALF_SHIFT 32 /** Shift from the low to the high half of a hash */
+#define DEFAULT_HASHES 3 /** Bits per item of a filter sized in bytes */
+#define MAX_HASHES 32 /** Most bits per item of a filter sized for a rate */
+#define BATCH_KEYS 16 /** Keys whose bits findBatch prefetches together */
+#define BITMAP_WORD_BITS 64 /** Results held by one word of a bitmap */
+#define TABLE_WORD_BITS 64 /** Bits of the table held by one word */
+#define MIN_FP_RATE 1e-15 /** Lowest false positive rate a filter is sized
+                           *  for */
+#define MAX_FP_RATE 0.5 /** Highest false positive rate a filter is sized
+                         *  for */
 
 using namespace std;
 
@@ -27,33 +38,126 @@ using namespace std;
  *  Description: The class for bloom filter that provides memory efficient
  *               check of whether an item has been inserted before. Small
  *               amount of false positives is possible but there will be no
- *               false negatives.
+ *               false negatives. Each item sets k bits, all derived from
+ *               one 64-bit hash by double hashing (Kirsch-Mitzenmacher):
+ *               bit i is h1 + i * h2, where h1 and h2 are the halves of the
+ *               hash, so an item is read once whatever k is. The table
+ *               is kept in 64-bit atomic words so several threads can fill
+ *               it at once with insertAtomic.
  */
 class BloomFilter {
 
     public:
 
         /* Constructor
-         * Description: Create a new bloom filter with the size in bytes
+         * Description: Create a new bloom filter with the size in bytes,
+         *              setting DEFAULT_HASHES bits per item
          * Parameters: numBytes - The number of bytes the bloom filter will
          *                        have
          */
         BloomFilter(size_t numBytes);
 
-        /* Function Name: insert(std::string item)
-         * Description: Insert an item into the bloom filter using hashing
-         *              funcs
+        /* Constructor
+         * Description: Create a new bloom filter sized for a false positive
+         *              rate: m = -n ln(p) / ln(2)^2 bits and k = m/n ln(2)
+         *              bits per item, the optimum for n items
+         * Parameters: expectedItems - The number of items to be inserted
+         *             fpRate - The false positive rate wanted once they
+         *                      are, clamped by clampRate
+         */
+        BloomFilter(size_t expectedItems, double fpRate);
+
+        /* Function Name: insert(std::string_view item)
+         * Description: Insert an item into the bloom filter, setting its k
+         *              bits. Not safe alongside other inserts.
+         * Parameters: item - the string to hash and put into the bloom filter
+         * Return Value: None
+         */
+        void insert(std::string_view item);
+
+        /* Function Name: insertAtomic(std::string_view item)
+         * Description: insert that may run on several threads at once,
+         *              setting each bit with an atomic fetch_or. The table
+         *              ends bit-identical to inserting the same items one
+         *              by one, in any order.
          * Parameters: item - the string to hash and put into the bloom filter
          * Return Value: None
          */
-        void insert(std::string item);
+        void insertAtomic(std::string_view item);
 
-        /* Function Name: find(std::string item)
+        /* Function Name: find(const std::string & item) const
          * Description: Determine whether an item is in the bloom filter
          * Parameters: item - the string to find in the bloom filter
          * Return Value: True if item is found in bloom filter, false otherwise
          */
-        bool find(std::string item);
+        bool find(const std::string & item) const;
+
+        /* Function Name: findBatch(const std::vector<std::string_view> &
+         *                      items) const
+         * Description: find for a block of items at once. The items are
+         *              hashed several at a time, then the bits of
+         *              BATCH_KEYS of them are all prefetched before any is
+         *              tested, so their cache misses overlap instead of
+         *              following one another.
+         * Parameters: items - the strings to find in the bloom filter
+         * Return Value: Bitmap of the results, bit j % BITMAP_WORD_BITS of
+         *               word j / BITMAP_WORD_BITS set if items[j] is found
+         */
+        std::vector<uint64_t> findBatch(
+                const std::vector<std::string_view> & items) const;
+
+        /* Function Name: hashCount() const
+         * Description: Number of bits set per item
+         * Return Value: k
+         */
+        unsigned int hashCount() const;
+
+        /* Function Name: memoryUsage() const
+         * Description: Size of the hash table
+         * Return Value: The number of bytes of the table
+         */
+        size_t memoryUsage() const;
+
+        /** Function Name: hash(std::string_view item)
+         *  Description: FNV-1A over the item in 64 bits, then mixed so both
+         *               halves depend on every char
+         *  Parameters: item - String to hash
+         *  Return Value: A 64-bit hash of item
+         *  Source(s) of Help: isthe.com/chongo/tech/comp/fnv/
+         */
+        static uint64_t hash(std::string_view item);
+
+        /** Function Name: hashBatch(const std::string_view * items,
+         *                      size_t count, uint64_t * hashes)
+         *  Description: hash of several items, with AVX2 a lane of 64 bits
+         *               per item where the target has it
+         *  Parameters: items - Strings to hash
+         *              count - Number of items
+         *              hashes - Where the hash of each item is written
+         */
+        static void hashBatch(const std::string_view * items, size_t count,
+                uint64_t * hashes);
+
+        /** Function Name: clampRate(double fpRate)
+         *  Description: A false positive rate moved into [MIN_FP_RATE,
+         *               MAX_FP_RATE], so a rate of 0, 1 or out of range
+         *               still sizes a finite table
+         *  Parameters: fpRate - The rate asked for
+         *  Return Value: The rate a filter is sized for
+         */
+        static double clampRate(double fpRate);
+
+        /* Function Name: operator==(const BloomFilter & other) const
+         * Description: Whether two filters have the same size, number of
+         *              hashes and bits
+         * Parameters: other - The filter to compare with
+         * Return Value: True if every bit of the tables matches
+         */
+        bool operator==(const BloomFilter & other) const;
+
+        /** The table belongs to the filter, it cannot be copied */
+        BloomFilter(const BloomFilter &) = delete;
+        BloomFilter & operator=(const BloomFilter &) = delete;
 
         /* Destructor
          * Description: Destructor for the bloom filter
@@ -62,40 +166,23 @@ class BloomFilter {
 
     private:
 
-        unsigned char* table; /** Char array as the hash table */
-        unsigned int numSlots; /** Size of hash table */
+        std::atomic<uint64_t>* table; /** Words of the hash table */
+        uint64_t numSlots; /** Size of hash table in bits */
+        size_t numWords; /** Size of hash table in words */
+        unsigned int numHashes; /** Bits set per item, k */
 
-        /** Function Name: FNV1AHash(const std::string & item)
-         *  Description: Uses the FNV1A-Hash algorithm to hash a string object
-         *               into an unsigned int
-         *  Parameters: item - String object to hash into an unsigned int
-         *  Return Value: A hash key created using item in the form of an
-         *                unsigned int
-         *  Source(s) of Help: isthe.com/chongo/tech/comp/fnv/
-         */
-        unsigned int FNV1AHash(const std::string & item);
-
-        /** Function Name: CRCHash(const std::string & item)
-         *  Description: Uses the CRC hash algorithmn to hash a string object
-         *               into an unsigned int
-         *  Parameters: item - String object to hash into an unsigned int
-         *  Return Value: A hash key created using item in the form of an
-         *                unsigned int
-         *  Source(s) of Help: Sample_hash_functions.docx from PA2 writeup
-         *                     (First link in reference)
-         *                     https://drive.google.com/file/d/1elgi1e1nU9gZxm
-         *                     Jcl9RaxgryZBnxooVT/view
+        /** Function Name: allocate()
+         *  Description: Creates the table of numSlots bits, all 0, in whole
+         *               words
          */
-        unsigned int SBDMHash(const std::string & item);
-
-        /** Function Name: SBDMHash(const std::string & item)
-         *  Description: Uses the SBDM hash algorithmn to hash a string object
-         *               into an unsigned int
-         *  Parameters: item - String object to hash into an unsigned int
-         *  Return Value: A hash key created using item in the form of an
-         *                unsigned int
-         *  Source(s) of Help: www.cse.yorku.ca/~oz/hash.html
+        void allocate();
+
+        /** Function Name: slot(uint64_t hashValue, unsigned int i) const
+         *  Description: Bit i of an item, h1 + i * h2 wrapped to the table
+         *  Parameters: hashValue - The hash of the item
+         *              i - Which of its k bits
+         *  Return Value: The index of the bit in the table
          */
-        unsigned int CRCHash(const std::string & item);
+        uint64_t slot(uint64_t hashValue, unsigned int i) const;
 };
 #endif // BLOOM_FILTER
@@ -0,0 +1,255 @@
+/** Filename: DictionaryHandle.cpp
+ *  Name: Loc Chuong
+ *  Userid: cs100sp19aj
+ *  Description: Handle to the current snapshot of a DictionaryTrie. A new
+ *               dictionary is built in the background and published with an
+ *               atomic pointer swap, so queries never wait on a reload.
+ *  Date: 5/2/2019
+ */
+
+#include "DictionaryHandle.hpp"
+#include "util.hpp"
+#include <chrono>
+#include <climits>
+#include <fstream>
+
+/** Index of the reader slot the calling thread tries first */
+static thread_local unsigned int slotHint = MAX_READERS;
+
+/** Source of the first slot hint of every thread */
+static std::atomic<unsigned int> nextHint(0);
+
+/** Constructor
+ *  Description: Holds the snapshot for a query
+ */
+DictionaryHandle::Snapshot::Snapshot(const DictionaryHandle * handle,
+        unsigned int slot, const DictionaryTrie * dict) : handle(handle),
+        slot(slot), dict(dict) {}
+
+/** Constructor
+ *  Description: Takes over the hold of other
+ */
+DictionaryHandle::Snapshot::Snapshot(Snapshot && other) :
+        handle(other.handle), slot(other.slot), dict(other.dict) {
+    other.handle = nullptr;
+}
+
+/** Destructor
+ *  Description: Releases the reader slot
+ */
+DictionaryHandle::Snapshot::~Snapshot() {
+    if( handle != nullptr) {
+        handle->readers[slot].epoch.store(IDLE_EPOCH,
+                std::memory_order_release);
+    }
+}
+
+/** Constructor
+ *  Description: Starts with an empty dictionary
+ *  Parameters: num_threads - Threads used to build each reload
+ */
+DictionaryHandle::DictionaryHandle(unsigned int num_threads) :
+        current(new DictionaryTrie()), epoch(IDLE_EPOCH + 1),
+        buildThreads(num_threads), reloading(false), reloaded(true) {
+    for( unsigned int i = 0; i < MAX_READERS; i++) {
+        readers[i].epoch.store(IDLE_EPOCH);
+    }
+}
+
+/** Function Name: acquire() const
+ *  Description: Holds the current snapshot for a query. Spins only if
+ *               MAX_READERS queries are already running.
+ *  Return Value: The hold on the current snapshot
+ */
+DictionaryHandle::Snapshot DictionaryHandle::acquire() const {
+    if( slotHint == MAX_READERS) {
+        slotHint = nextHint++ % MAX_READERS;
+    }
+    unsigned int slot = slotHint;
+    while(1) {
+        /** An epoch read before a publish only delays the reclaim */
+        unsigned long long idle = IDLE_EPOCH;
+        if( readers[slot].epoch.compare_exchange_strong(idle, epoch.load())) {
+            break;
+        }
+        slot = (slot + 1) % MAX_READERS;
+        if( slot == slotHint) {
+            std::this_thread::yield();
+        }
+    }
+    slotHint = slot;
+    /** Stamped before the load, so a publish that misses the stamp
+     *  swapped the pointer before this load */
+    return Snapshot(this, slot, current.load());
+}
+
+/** Function Name: publish(DictionaryTrie * next)
+ *  Description: Makes next the current snapshot and retires the old one,
+ *               freeing whatever retired snapshots no query holds anymore.
+ *               Queries already running keep their snapshot.
+ *  Parameters: next - The new dictionary, owned by the handle
+ */
+void DictionaryHandle::publish(DictionaryTrie * next) {
+    {
+        std::lock_guard<std::mutex> guard(retireLock);
+        DictionaryTrie * old = current.exchange(next);
+        /** Queries stamped with this epoch or before may still hold old */
+        retired.push_back(std::make_pair(old, epoch.fetch_add(1)));
+    }
+    reclaim();
+}
+
+/** Function Name: reload(const std::string & filename)
+ *  Description: Builds a dictionary from a dictionary file on the calling
+ *               thread, with its completion cache, and publishes it
+ *  Parameters: filename - The dictionary file to read
+ *  Return Value: False if the file could not be read
+ */
+bool DictionaryHandle::reload(const std::string & filename) {
+    std::error_code error;
+    /** Taken first, so a write during the read triggers another reload */
+    std::filesystem::file_time_type written =
+        std::filesystem::last_write_time(filename, error);
+    ifstream in(filename, ios::binary);
+    if( !in || error) {
+        return false;
+    }
+    DictionaryTrie * next = new DictionaryTrie();
+    Utils::load_dict(*next, in, UINT_MAX, buildThreads);
+    next->buildCompletionCache(DEFAULT_CACHE_K);
+    loadedTime = written;
+    publish(next);
+    return true;
+}
+
+/** Function Name: reloadAsync(const std::string & filename)
+ *  Description: Runs reload on a background thread, then waits for the old
+ *               snapshot to drain and frees it. Waits for a reload already
+ *               running first.
+ *  Parameters: filename - The dictionary file to read
+ */
+void DictionaryHandle::reloadAsync(const std::string & filename) {
+    waitForReload();
+    reloading.store(true);
+    reloader = std::thread([this, filename]() {
+        reloaded = reload(filename);
+        while( reclaim() > 0) {
+            std::this_thread::sleep_for(std::chrono::milliseconds(1));
+        }
+        reloading.store(false, std::memory_order_release);
+    });
+}
+
+/** Function Name: reloadIfChanged(const std::string & filename)
+ *  Description: Starts reloadAsync if the file was written since it was last
+ *               loaded and no reload is running
+ *  Parameters: filename - The dictionary file to watch
+ *  Return Value: True if a reload was started
+ */
+bool DictionaryHandle::reloadIfChanged(const std::string & filename) {
+    if( reloading.load(std::memory_order_acquire)) {
+        return false;
+    }
+    std::error_code error;
+    std::filesystem::file_time_type written =
+        std::filesystem::last_write_time(filename, error);
+    if( error || written == loadedTime) {
+        return false;
+    }
+    reloadAsync(filename);
+    return true;
+}
+
+/** Function Name: waitForReload()
+ *  Description: Waits for the background reload, if any, to finish
+ *  Return Value: False if the last reload could not read its file
+ */
+bool DictionaryHandle::waitForReload() {
+    if( reloader.joinable()) {
+        reloader.join();
+    }
+    return reloaded;
+}
+
+/** Function Name: reclaim()
+ *  Description: Frees the retired snapshots no query holds anymore
+ *  Return Value: The number of retired snapshots still held
+ */
+unsigned int DictionaryHandle::reclaim() {
+    /** Oldest epoch a running query announced */
+    unsigned long long oldest = ULLONG_MAX;
+    for( unsigned int i = 0; i < MAX_READERS; i++) {
+        unsigned long long stamp = readers[i].epoch.load();
+        if( stamp != IDLE_EPOCH && stamp < oldest) {
+            oldest = stamp;
+        }
+    }
+    std::vector<DictionaryTrie *> drained;
+    unsigned int held;
+    {
+        std::lock_guard<std::mutex> guard(retireLock);
+        unsigned int kept = 0;
+        for( unsigned int i = 0; i < retired.size(); i++) {
+            if( retired[i].second < oldest) {
+                drained.push_back(retired[i].first);
+            }
+            else {
+                retired[kept++] = retired[i];
+            }
+        }
+        retired.resize(kept);
+        held = kept;
+    }
+    /** Freed outside the lock, a big trie takes a while */
+    for( unsigned int i = 0; i < drained.size(); i++) {
+        delete drained[i];
+    }
+    return held;
+}
+
+/** Function Name: generation() const
+ *  Description: Number of snapshots published so far
+ *  Return Value: The generation of the current snapshot
+ */
+unsigned long long DictionaryHandle::generation() const {
+    return epoch.load() - (IDLE_EPOCH + 1);
+}
+
+/** Function Name: predictCompletions(std::string prefix,
+ *                      unsigned int num_completions) const
+ *  Description: DictionaryTrie::predictCompletions on the current snapshot
+ */
+std::vector<std::string> DictionaryHandle::predictCompletions(
+        std::string prefix, unsigned int num_completions) const {
+    return acquire()->predictCompletions(prefix, num_completions);
+}
+
+/** Function Name: predictUnderscore(std::string pattern,
+ *                      unsigned int num_completions) const
+ *  Description: DictionaryTrie::predictUnderscore on the current snapshot
+ */
+std::vector<std::string> DictionaryHandle::predictUnderscore(
+        std::string pattern, unsigned int num_completions) const {
+    return acquire()->predictUnderscore(pattern, num_completions);
+}
+
+/** Function Name: predictPattern(std::string pattern,
+ *                      unsigned int num_completions) const
+ *  Description: DictionaryTrie::predictPattern on the current snapshot
+ */
+std::vector<std::string> DictionaryHandle::predictPattern(
+        std::string pattern, unsigned int num_completions) const {
+    return acquire()->predictPattern(pattern, num_completions);
+}
+
+/** Destructor
+ *  Description: Waits for a running reload and frees every snapshot. No
+ *               query may hold a snapshot anymore.
+ */
+DictionaryHandle::~DictionaryHandle() {
+    waitForReload();
+    for( unsigned int i = 0; i < retired.size(); i++) {
+        delete retired[i].first;
+    }
+    delete current.load();
+}
@@ -0,0 +1,209 @@
+/** Filename: DictionaryHandle.hpp
+ *  Name: Loc Chuong
+ *  Userid: cs100sp19aj
+ *  Description: Handle to the current snapshot of a DictionaryTrie. A new
+ *               dictionary is built in the background and published with an
+ *               atomic pointer swap, so queries never wait on a reload.
+ *  Date: 5/2/2019
+ */
+
+#ifndef DICTIONARY_HANDLE_HPP
+#define DICTIONARY_HANDLE_HPP
+
+#include "DictionaryTrie.hpp"
+#include <atomic>
+#include <filesystem>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <utility>
+#include <vector>
+#define MAX_READERS 64 /** Queries that may hold a snapshot at once */
+#define IDLE_EPOCH 0 /** Epoch of a reader slot no query holds */
+
+using namespace std;
+
+/** Class Name: DictionaryHandle
+ *  Description: Owns every snapshot of a dictionary. Queries run on the
+ *               snapshot that was current when they began; a reload builds
+ *               the next one off to the side and swaps it in.
+ *
+ *               Old snapshots are freed by epoch based reclamation. A query
+ *               claims a reader slot and stamps it with the global epoch
+ *               before it loads the snapshot pointer. Publishing swaps the
+ *               pointer, then advances the epoch, and retires the old
+ *               snapshot under the epoch it replaced. Only a query stamped
+ *               with that epoch or an earlier one could still be reading
+ *               it, so it is freed once no slot holds such a stamp.
+ */
+class DictionaryHandle
+{
+    public:
+
+        /** Class Name: Snapshot
+         *  Description: A query's hold on one snapshot. The snapshot is not
+         *               freed while the hold lives; holds should be short,
+         *               as a retired snapshot waits for every one of them.
+         */
+        class Snapshot
+        {
+            public:
+
+                /** A hold is moved, never copied */
+                Snapshot(Snapshot && other);
+                Snapshot(const Snapshot &) = delete;
+                Snapshot & operator=(const Snapshot &) = delete;
+
+                /** Function Name: operator->() const
+                 *  Description: Gives access to the held dictionary
+                 *  Return Value: The snapshot held
+                 */
+                const DictionaryTrie * operator->() const { return dict; }
+
+                /** Function Name: operator*() const
+                 *  Description: Gives access to the held dictionary
+                 *  Return Value: The snapshot held
+                 */
+                const DictionaryTrie & operator*() const { return *dict; }
+
+                /** Destructor
+                 *  Description: Releases the reader slot
+                 */
+                ~Snapshot();
+
+            private:
+
+                const DictionaryHandle * handle; /** Owner of the slot */
+                unsigned int slot; /** Reader slot stamped by this hold */
+                const DictionaryTrie * dict; /** The snapshot held */
+
+                /** Holds are only made by acquire() */
+                Snapshot(const DictionaryHandle * handle, unsigned int slot,
+                        const DictionaryTrie * dict);
+
+                friend class DictionaryHandle;
+        };
+
+        /** Constructor
+         *  Description: Starts with an empty dictionary
+         *  Parameters: num_threads - Threads used to build each reload
+         */
+        DictionaryHandle(unsigned int num_threads = 1);
+
+        /** The snapshots belong to the handle, it cannot be copied */
+        DictionaryHandle(const DictionaryHandle &) = delete;
+        DictionaryHandle & operator=(const DictionaryHandle &) = delete;
+
+        /** Function Name: acquire() const
+         *  Description: Holds the current snapshot for a query. Spins only if
+         *               MAX_READERS queries are already running.
+         *  Return Value: The hold on the current snapshot
+         */
+        Snapshot acquire() const;
+
+        /** Function Name: publish(DictionaryTrie * next)
+         *  Description: Makes next the current snapshot and retires the old
+         *               one, freeing whatever retired snapshots no query
+         *               holds anymore. Queries already running keep their
+         *               snapshot.
+         *  Parameters: next - The new dictionary, owned by the handle
+         */
+        void publish(DictionaryTrie * next);
+
+        /** Function Name: reload(const std::string & filename)
+         *  Description: Builds a dictionary from a dictionary file on the
+         *               calling thread, with its completion cache, and
+         *               publishes it
+         *  Parameters: filename - The dictionary file to read
+         *  Return Value: False if the file could not be read
+         */
+        bool reload(const std::string & filename);
+
+        /** Function Name: reloadAsync(const std::string & filename)
+         *  Description: Runs reload on a background thread, then waits for
+         *               the old snapshot to drain and frees it. Waits for a
+         *               reload already running first.
+         *  Parameters: filename - The dictionary file to read
+         */
+        void reloadAsync(const std::string & filename);
+
+        /** Function Name: reloadIfChanged(const std::string & filename)
+         *  Description: Starts reloadAsync if the file was written since it
+         *               was last loaded and no reload is running
+         *  Parameters: filename - The dictionary file to watch
+         *  Return Value: True if a reload was started
+         */
+        bool reloadIfChanged(const std::string & filename);
+
+        /** Function Name: waitForReload()
+         *  Description: Waits for the background reload, if any, to finish
+         *  Return Value: False if the last reload could not read its file
+         */
+        bool waitForReload();
+
+        /** Function Name: reclaim()
+         *  Description: Frees the retired snapshots no query holds anymore
+         *  Return Value: The number of retired snapshots still held
+         */
+        unsigned int reclaim();
+
+        /** Function Name: generation() const
+         *  Description: Number of snapshots published so far
+         *  Return Value: The generation of the current snapshot
+         */
+        unsigned long long generation() const;
+
+        /** Function Name: predictCompletions(std::string prefix,
+         *                      unsigned int num_completions) const
+         *  Description: DictionaryTrie::predictCompletions on the current
+         *               snapshot
+         */
+        std::vector<std::string> predictCompletions(std::string prefix,
+                unsigned int num_completions) const;
+
+        /** Function Name: predictUnderscore(std::string pattern,
+         *                      unsigned int num_completions) const
+         *  Description: DictionaryTrie::predictUnderscore on the current
+         *               snapshot
+         */
+        std::vector<std::string> predictUnderscore(std::string pattern,
+                unsigned int num_completions) const;
+
+        /** Function Name: predictPattern(std::string pattern,
+         *                      unsigned int num_completions) const
+         *  Description: DictionaryTrie::predictPattern on the current
+         *               snapshot
+         */
+        std::vector<std::string> predictPattern(std::string pattern,
+                unsigned int num_completions) const;
+
+        /** Destructor
+         *  Description: Waits for a running reload and frees every snapshot.
+         *               No query may hold a snapshot anymore.
+         */
+        ~DictionaryHandle();
+
+    private:
+
+        /** Struct ReaderSlot
+         *  Description: Epoch a query announced, alone on its cache line so
+         *               queries on different cores do not share lines
+         */
+        struct alignas(64) ReaderSlot {
+            std::atomic<unsigned long long> epoch; /** IDLE_EPOCH if free */
+        };
+
+        std::atomic<DictionaryTrie *> current; /** Snapshot new queries get */
+        std::atomic<unsigned long long> epoch; /** Advances on each publish */
+        mutable ReaderSlot readers[MAX_READERS]; /** Announced query epochs */
+        /** Old snapshots with the epoch they were replaced in */
+        std::vector<std::pair<DictionaryTrie *, unsigned long long>> retired;
+        std::mutex retireLock; /** Guards retired and publishing */
+        unsigned int buildThreads; /** Threads used to build a reload */
+        std::thread reloader; /** The background reload, if any */
+        std::atomic<bool> reloading; /** True while reloader runs */
+        bool reloaded; /** Whether the last reload read its file */
+        std::filesystem::file_time_type loadedTime; /** Write time loaded */
+};
+
+#endif // DICTIONARY_HANDLE_HPP
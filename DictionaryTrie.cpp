@@ -11,126 +11,650 @@
 #include "util.hpp"
 #include "TrieNode.hpp"
 #include "DictionaryTrie.hpp"
+#include "PatternMatcher.hpp"
 #include <iostream>
 #include <algorithm>
 #include <string>
-
-/** Struct Word
- *  Description: Used to hold a string and its frequency in the TST
- */
-struct Word {
-
-    int freq; /** Frequency of the string s in the TST */
-    string s; /** The string created by traversing the TST */
-
-    /** Default construct
-     *  Description: Initializes s and freq to zero-like values
-     */
-    Word() : freq(0), s() {}
-
-    /** Constructor
-     *  Description: Initalizes instance variables s and freq to the passed
-     *               in parameters s and freq
-     */
-    Word(const string s, const unsigned int freq) {
-        this->s = s;
-        this->freq = freq;
-    }
-
-    /** Operator()
-     *  Description: Used to compare two Word structs based first on freq,
-     *               but if freq is the same, then it is based alphabetically
-     *  Return Value: True if w1 is less than w2, False otherwise
-     */
-    bool operator() (const Word & w1, const Word & w2) {
-        /** Frequency is the same, sort by alphabetical order */
-        if( w1.freq == w2.freq) {
-            return w1.s < w2.s;
-        }
-        /** Frequency differ, sort by frequency */
-        return w1.freq > w2.freq;
-    }
-};
+#include <atomic>
+#include <memory>
+#include <new>
+#include <thread>
+#include <climits>
+#define SHARD_COUNT 256 /** Shards of a parallel build, one per first char */
 
 /** Constructor
  *  Description: Create a new Dictionary that uses a Trie back end
  */
-DictionaryTrie::DictionaryTrie() : root(nullptr), isize(0), iheight(0) {
+DictionaryTrie::DictionaryTrie() : root(NULL_NODE), isize(0), iheight(0),
+    engine(EXHAUSTIVE_DFS), cacheK(0), cacheStale(false) {
 }
 
-/** Function Name: insert(std::string word, unsigned int freq)
- *  Description: Insert a word with its frequency into the dictionary
- *  Parameters: word - The word to insert into the dictionary
- *              freq - The frequency of the word to insert into the dictionary
- *  Return Value: Return true if the word was inserted, and false if it
- *                was not (i.e. it was already in the dictionary or it was
- *                invalid (empty string). This might be useful for testing
- *                when you want to test a certain case, but don't want to
- *                write out a specific word 300 times.
+/** Function Name: setCompletionEngine(CompletionEngine engine)
+ *  Description: Selects the traversal used by predictCompletions. Both
+ *               engines return identical completions.
+ *  Parameters: engine - The traversal to use from now on
  */
-bool DictionaryTrie::insert(std::string word, unsigned int freq) {
-    /** Delegates to private instance of insert */
-    return insert(word, freq, root, 0);
+void DictionaryTrie::setCompletionEngine(CompletionEngine engine) {
+    this->engine = engine;
 }
 
-/** Function Name: insert(std::string word, unsigned int freq,
- *                      TrieNode * & root, unsigned int height)
- *  Description: Private instance helper to insert. Insert a word with its
- *               frequency into the dictionary.
+/** Function Name: insert(std::string_view word, unsigned int freq)
+ *  Description: Insert a word with its frequency into the dictionary. The
+ *               TST is walked iteratively, so no stack frame is used per
+ *               character or per sibling. Lock-free, see findOrCreateNode.
  *  Parameters: word - The word to insert into the dictionary
  *              freq - The frequency of the word to insert into the dictionary
- *              root - A pointer reference to the root of the TST
- *              height - height of the TST, used to determine new height and
- *                       as the index of the word
  *  Return Value: Return true if the word was inserted, and false if it
  *                was not (i.e. it was already in the dictionary or it was
  *                invalid (empty string). This might be useful for testing
  *                when you want to test a certain case, but don't want to
  *                write out a specific word 300 times.
  */
-bool DictionaryTrie::insert(std::string word, unsigned int freq,
-        TrieNode * & root, unsigned int height) {
-    /** Base Case: current node is null */
-    if( root == nullptr) {
-        /** Create new node for corresponding char in word */
-        root = new TrieNode(word[height]);
+bool DictionaryTrie::insert(std::string_view word, unsigned int freq) {
+    /** Empty string is not a valid word */
+    if( word.empty()) {
+        return false;
+    }
+    unsigned int currNode = findOrCreateNode(word);
+    TrieNode & node = nodes[currNode];
+    /** Word is already in Trie, don't add it */
+    if( node.freq.load(std::memory_order_acquire) != NO_WORD) {
+        return false;
+    }
+    raiseBounds(word, freq);
+    /** Only one of several threads inserting the word gets it in */
+    int expected = NO_WORD;
+    if( !node.freq.compare_exchange_strong(expected, freq,
+                std::memory_order_acq_rel)) {
+        return false;
+    }
+    countWord(word.size() - 1);
+    return true;
+}
+
+/** Function Name: increment(std::string_view word, unsigned int delta)
+ *  Description: Adds delta to the frequency of a word, inserting the word
+ *               with frequency delta if it is not in the dictionary.
+ *               Frequencies saturate at INT_MAX. Lock-free, concurrent
+ *               increments of one word all count.
+ *  Parameters: word - The word whose frequency grows
+ *              delta - The amount to add
+ *  Return Value: True if the word was inserted, false if it was already
+ *                there or is invalid (empty string)
+ */
+bool DictionaryTrie::increment(std::string_view word, unsigned int delta) {
+    if( word.empty()) {
+        return false;
+    }
+    unsigned int currNode = findOrCreateNode(word);
+    TrieNode & node = nodes[currNode];
+    int freq = node.freq.load(std::memory_order_acquire);
+    int updated;
+    do {
+        long long sum = (freq == NO_WORD ? 0LL : freq) + (long long) delta;
+        updated = sum > INT_MAX ? INT_MAX : (int) sum;
+        raiseBounds(word, updated);
+    } while( !node.freq.compare_exchange_weak(freq, updated,
+                std::memory_order_acq_rel));
+    if( freq == NO_WORD) {
+        countWord(word.size() - 1);
+        return true;
+    }
+    return false;
+}
+
+/** Function Name: upsert(std::string_view word, unsigned int freq)
+ *  Description: Sets the frequency of a word, inserting the word if it is
+ *               not in the dictionary. Lock-free, the last write wins.
+ *  Parameters: word - The word to insert or update
+ *              freq - The new frequency of the word
+ *  Return Value: True if the word was inserted, false if it was already
+ *                there or is invalid (empty string)
+ */
+bool DictionaryTrie::upsert(std::string_view word, unsigned int freq) {
+    if( word.empty()) {
+        return false;
+    }
+    unsigned int currNode = findOrCreateNode(word);
+    raiseBounds(word, freq);
+    if( nodes[currNode].freq.exchange(freq, std::memory_order_acq_rel) ==
+            NO_WORD) {
+        countWord(word.size() - 1);
+        return true;
+    }
+    return false;
+}
+
+/** Function Name: findOrCreateNode(std::string_view word)
+ *  Description: Walks word down the TST, linking a new node with a CAS
+ *               wherever a child is missing. A node is complete before it
+ *               is linked, and a thread losing the CAS walks on from the
+ *               node that won. A node built for a lost CAS and not needed
+ *               further down is released to the pool.
+ *  Parameters: word - The non-empty word to find or create
+ *  Return Value: The pool index of the node ending word
+ */
+unsigned int DictionaryTrie::findOrCreateNode(std::string_view word) {
+    /** Readers may hold the completion index, stop them using it before
+     *  anything they could find changes */
+    cacheStale.store(true);
+    /** Child link to follow, slabs never move so the link stays valid */
+    std::atomic<unsigned int> * link = &root;
+    unsigned int height = 0;
+    /** Node built for a lost CAS, reused for the next missing child */
+    unsigned int spare = NULL_NODE;
+    while(1) {
+        unsigned int currNode = link->load(std::memory_order_acquire);
+        /** Current node is null, create it for the corresponding char */
+        if( currNode == NULL_NODE) {
+            if( spare == NULL_NODE) {
+                spare = nodes.allocate(word[height]);
+            }
+            else {
+                nodes[spare].data = word[height];
+            }
+            if( link->compare_exchange_strong(currNode, spare,
+                        std::memory_order_acq_rel)) {
+                currNode = spare;
+                spare = NULL_NODE;
+            }
+        }
+        TrieNode & node = nodes[currNode];
+        /** Current character greater than current node's char */
+        if( word[height] > node.data) {
+            link = &node.right;
+        }
+        /** Current character less than current node's char */
+        else if( word[height] < node.data) {
+            link = &node.left;
+        }
+        /** There exists another character in word, go down */
+        else if( height+1 < word.size()) {
+            link = &node.down;
+            height++;
+        }
+        else {
+            /** Never linked, so no reader can reach it */
+            if( spare != NULL_NODE) {
+                nodes.release(spare);
+            }
+            return currNode;
+        }
     }
-    /** Current character greater than current node's char */
-    if (word[height] > root->data) {
-        /** Traverse right with current height (Keep current char) */
-        return insert(word, freq, root->right, height);
+}
+
+/** Function Name: raiseBounds(std::string_view word, int freq)
+ *  Description: Raises maxFreq to at least freq and widens the word length
+ *               bounds to cover word on every node above and at the node
+ *               ending word, which must exist. Done before freq is
+ *               published, so readers never see a subtree bound that
+ *               excludes a word.
+ *  Parameters: word - The word whose path is raised
+ *              freq - The frequency the word is about to get
+ */
+void DictionaryTrie::raiseBounds(std::string_view word, int freq) {
+    /** The new word lies in the subtree of every node on its path */
+    unsigned int currNode = root;
+    unsigned int height = 0;
+    while( currNode != NULL_NODE) {
+        TrieNode & node = nodes[currNode];
+        int maxFreq = node.maxFreq.load(std::memory_order_relaxed);
+        while( maxFreq < freq && !node.maxFreq.compare_exchange_weak(maxFreq,
+                    freq, std::memory_order_release)) {
+        }
+        /** Chars of word from this node's level on */
+        unsigned char length = std::min<size_t>(word.size() - height,
+                MAX_LENGTH_BOUND);
+        unsigned char bound = node.minLength.load(std::memory_order_relaxed);
+        while( bound > length && !node.minLength.compare_exchange_weak(bound,
+                    length, std::memory_order_release)) {
+        }
+        bound = node.maxLength.load(std::memory_order_relaxed);
+        while( bound < length && !node.maxLength.compare_exchange_weak(bound,
+                    length, std::memory_order_release)) {
+        }
+        if( word[height] > node.data) {
+            currNode = node.right;
+        }
+        else if( word[height] < node.data) {
+            currNode = node.left;
+        }
+        else if( ++height < word.size()) {
+            currNode = node.down;
+        }
+        else {
+            break;
+        }
+    }
+}
+
+/** Function Name: countWord(unsigned int height)
+ *  Description: Updates size and height for a newly added word
+ *  Parameters: height - Index of the word's last char
+ */
+void DictionaryTrie::countWord(unsigned int height) {
+    isize.fetch_add(1, std::memory_order_relaxed);
+    unsigned int current = iheight.load(std::memory_order_relaxed);
+    while( current < height && !iheight.compare_exchange_weak(current,
+                height, std::memory_order_relaxed)) {
     }
-    /** Current character less than current node's char */
-    else if (word[height] < root->data) {
-        /** Traverse left with current height (Keep current char) */
-        return insert(word, freq, root->left, height);
+}
+
+/** Function Name: lessSigned(
+ *                      const std::pair<std::string_view, unsigned int> & a,
+ *                      const std::pair<std::string_view, unsigned int> & b)
+ *  Description: Orders entries by word the same way the TST orders chars
+ *               (plain char comparison), unlike std::string's unsigned order
+ *  Return Value: True if a's word sorts before b's word
+ */
+static bool lessSigned(const std::pair<std::string_view, unsigned int> & a,
+        const std::pair<std::string_view, unsigned int> & b) {
+    return std::lexicographical_compare(a.first.begin(), a.first.end(),
+            b.first.begin(), b.first.end());
+}
+
+/** Function Name: build(std::vector<std::pair<std::string_view,
+ *                      unsigned int>> entries, unsigned int num_threads)
+ *  Description: Bulk insert of (word, freq) entries. The entries are sorted
+ *               and, on an empty dictionary, every sibling BST is built from
+ *               the median char of its range down, so it is balanced even if
+ *               the input was sorted. With several threads the entries are
+ *               sharded by first char and the shards are sorted and built
+ *               concurrently, then stitched under the root sibling BST; the
+ *               TST is the same either way. On a non-empty dictionary the
+ *               entries are inserted in median order by this thread instead.
+ *               As with insert, empty words and repeats of a word already
+ *               present are skipped.
+ *  Parameters: entries - The (word, freq) pairs to insert, the words only
+ *                      need to outlive the call
+ *              num_threads - The number of threads building shards
+ */
+void DictionaryTrie::build(
+        std::vector<std::pair<std::string_view, unsigned int>> entries,
+        unsigned int num_threads) {
+    if( root == NULL_NODE && num_threads > 1) {
+        buildSharded(entries, num_threads);
     }
-    /** Current character is equal to current node's char */
     else {
-        /** There exists another character in word */
-        if(height+1 < word.size()) {
-            /** Traverse down with height + 1 (Use next char in word) */
-            return insert(word, freq, root->down, height+1);
+        /** Stable so the first of repeated words wins, like repeated
+         *  inserts */
+        std::stable_sort(entries.begin(), entries.end(), lessSigned);
+        unsigned int lo = 0;
+        /** Empty words sort first and are never stored */
+        while( lo < entries.size() && entries[lo].first.empty()) {
+            lo++;
+        }
+        if( root == NULL_NODE) {
+            unsigned int words = 0;
+            unsigned int height = 0;
+            buildSiblings(nodes, entries, &root, lo, entries.size(), words,
+                    height);
+            sweepBounds(nodes);
+            isize = words;
+            iheight = height;
         }
-        /** There does not exist another character in word */
         else {
-            /** Word is already in Trie, don't add it */
-            if( root->word) {
-                return false;
+            /** Drop later repeats first, the median walk below would keep
+             *  whichever copy it reached first */
+            entries.erase(std::unique(entries.begin() + lo, entries.end(),
+                        [](const std::pair<std::string_view, unsigned int> & a,
+                            const std::pair<std::string_view, unsigned int> &
+                            b) { return a.first == b.first; }),
+                    entries.end());
+            /** Insert medians first so new siblings still hang balanced */
+            std::vector<std::pair<unsigned int, unsigned int>> ranges;
+            ranges.push_back(std::make_pair(lo,
+                        (unsigned int) entries.size()));
+            while( !ranges.empty()) {
+                unsigned int first = ranges.back().first;
+                unsigned int last = ranges.back().second;
+                ranges.pop_back();
+                if( first >= last) {
+                    continue;
+                }
+                unsigned int mid = first + (last - first) / 2;
+                insert(entries[mid].first, entries[mid].second);
+                ranges.push_back(std::make_pair(first, mid));
+                ranges.push_back(std::make_pair(mid + 1, last));
             }
-            /** Word not in Trie, add it */
-            else {
-                /** Current node is a word node, set instance variables */
-                root->word = true;
-                root->freq = freq;
-                if( iheight < height) {
-                    iheight = height;
+        }
+    }
+    /** The completion index no longer reflects the dictionary */
+    if( cacheK > 0) {
+        dropCompletionCache();
+    }
+}
+
+/** Function Name: buildSiblings(TrieNodePool & pool,
+ *                      const std::vector<std::pair<std::string_view,
+ *                      unsigned int>> & entries,
+ *                      std::atomic<unsigned int> * link,
+ *                      unsigned int from, unsigned int to,
+ *                      unsigned int & words, unsigned int & height)
+ *  Description: Builds the balanced TST of the sorted, non-empty entries in
+ *               [from, to) out of pool and stores its root in link.
+ *               maxFreq and the length bounds are left for sweepBounds.
+ *  Parameters: pool - The pool the nodes are allocated from
+ *              entries - The entries, sorted by lessSigned
+ *              link - Where the root of the new TST is stored
+ *              from - Index of the first entry to build
+ *              to - Index past the last entry to build
+ *              words - Incremented for every word stored
+ *              height - Raised to the height of the new TST
+ */
+void DictionaryTrie::buildSiblings(TrieNodePool & pool,
+        const std::vector<std::pair<std::string_view, unsigned int>> &
+        entries, std::atomic<unsigned int> * link, unsigned int from,
+        unsigned int to, unsigned int & words, unsigned int & height) {
+    /** Work left, run last pushed first: a sibling set to split into
+     *  groups (first and last are entries), a span of groups to hang as a
+     *  balanced BST (first and last are indices into groups), or the end
+     *  of a sibling set, whose groups are then dropped */
+    enum TaskKind { LEVEL, SPAN, DROP };
+    struct Task {
+        TaskKind kind;
+        std::atomic<unsigned int> * link;
+        unsigned int first;
+        unsigned int last;
+        unsigned int depth;
+    };
+    std::vector<Task> tasks;
+    /** Start of each run of entries sharing the char at depth, for every
+     *  sibling set under construction, the innermost one last */
+    std::vector<unsigned int> groups;
+    if( from < to) {
+        tasks.push_back({ LEVEL, link, from, to, 0 });
+    }
+    while( !tasks.empty()) {
+        Task task = tasks.back();
+        tasks.pop_back();
+        if( task.kind == DROP) {
+            groups.resize(task.first);
+            continue;
+        }
+        if( task.kind == LEVEL) {
+            unsigned int base = groups.size();
+            for( unsigned int i = task.first; i < task.last; i++) {
+                if( i == task.first || entries[i].first[task.depth] !=
+                        entries[i-1].first[task.depth]) {
+                    groups.push_back(i);
                 }
-                return true;
+            }
+            groups.push_back(task.last);
+            /** Balanced BST over the groups, median group at every
+             *  subtree */
+            tasks.push_back({ DROP, nullptr, base, 0, 0 });
+            tasks.push_back({ SPAN, task.link, base,
+                    (unsigned int) groups.size() - 1, task.depth });
+            continue;
+        }
+        if( task.first >= task.last) {
+            continue;
+        }
+        unsigned int mid = task.first + (task.last - task.first) / 2;
+        unsigned int first = groups[mid];
+        unsigned int last = groups[mid+1];
+        unsigned int currNode =
+            pool.allocate(entries[first].first[task.depth]);
+        /** Nothing is shared before the build returns */
+        task.link->store(currNode, std::memory_order_relaxed);
+        TrieNode & node = pool[currNode];
+        /** Words ending at this char sort first, the first one wins */
+        if( entries[first].first.size() == task.depth + 1) {
+            node.freq.store(entries[first].second,
+                    std::memory_order_relaxed);
+            words++;
+            if( height < task.depth) {
+                height = task.depth;
+            }
+            while( first < last &&
+                    entries[first].first.size() == task.depth + 1) {
+                first++;
+            }
+        }
+        /** Nodes are allocated in the order a completion search visits
+         *  them: the node, everything below it, then its right and left
+         *  siblings, so a subtree walk reads the pool front to back */
+        tasks.push_back({ SPAN, &node.left, task.first, mid, task.depth });
+        tasks.push_back({ SPAN, &node.right, mid + 1, task.last,
+                task.depth });
+        /** The longer words form the sibling set below */
+        if( first < last) {
+            tasks.push_back({ LEVEL, &node.down, first, last,
+                    task.depth + 1 });
+        }
+    }
+}
+
+/** Function Name: sweepBounds(TrieNodePool & pool)
+ *  Description: Sets maxFreq and the word length bounds of every node of
+ *               pool, which must have been filled by buildSiblings
+ *  Parameters: pool - The pool to sweep
+ */
+void DictionaryTrie::sweepBounds(TrieNodePool & pool) {
+    /** Children are allocated after their parents, so a reverse sweep over
+     *  the pool sees every subtree before the node above it */
+    for( unsigned int currNode = pool.size(); currNode > NULL_NODE;
+            currNode--) {
+        TrieNode & node = pool[currNode];
+        int maxFreq = node.freq.load(std::memory_order_relaxed);
+        unsigned int minLength = MAX_LENGTH_BOUND;
+        unsigned int maxLength = 0;
+        if( maxFreq == NO_WORD) {
+            maxFreq = 0;
+        }
+        else {
+            minLength = maxLength = 1;
+        }
+        unsigned int children[3] = {
+            node.left.load(std::memory_order_relaxed),
+            node.right.load(std::memory_order_relaxed),
+            node.down.load(std::memory_order_relaxed) };
+        for( unsigned int i = 0; i < 3; i++) {
+            if( children[i] == NULL_NODE) {
+                continue;
+            }
+            const TrieNode & child = pool[children[i]];
+            maxFreq = std::max(maxFreq, child.maxFreq.load(
+                        std::memory_order_relaxed));
+            /** Words below are one char longer from this node's level */
+            unsigned int below = i == 2 ? 1 : 0;
+            minLength = std::min(minLength, child.minLength.load(
+                        std::memory_order_relaxed) + below);
+            maxLength = std::max(maxLength, child.maxLength.load(
+                        std::memory_order_relaxed) + below);
+        }
+        node.maxFreq.store(maxFreq, std::memory_order_relaxed);
+        node.minLength.store(std::min(minLength, MAX_LENGTH_BOUND + 0U),
+                std::memory_order_relaxed);
+        node.maxLength.store(std::min(maxLength, MAX_LENGTH_BOUND + 0U),
+                std::memory_order_relaxed);
+    }
+}
+
+/** Function Name: shardOf(char c)
+ *  Description: Shard of the words starting with c. Shards are numbered in
+ *               the TST's (signed) char order.
+ *  Return Value: The shard index, 0 to SHARD_COUNT - 1
+ */
+static inline unsigned int shardOf(char c) {
+    return (unsigned char) c ^ 0x80;
+}
+
+/** Function Name: rebase(unsigned int link, unsigned int offset)
+ *  Description: Moves a child link by offset, keeping NULL_NODE as it is
+ *  Return Value: The link in the pool the node is copied into
+ */
+static inline unsigned int rebase(unsigned int link, unsigned int offset) {
+    return link != NULL_NODE ? link + offset : NULL_NODE;
+}
+
+/** Function Name: buildSharded(std::vector<std::pair<std::string_view,
+ *                      unsigned int>> & entries, unsigned int num_threads)
+ *  Description: Parallel build of an empty dictionary, see build. Every
+ *               thread builds whole shards into a pool of its own; the pools
+ *               are then copied side by side into the dictionary's pool,
+ *               again one thread per pool, and the shard roots are linked
+ *               into the root sibling BST.
+ *  Parameters: entries - The unsorted (word, freq) pairs to insert
+ *              num_threads - The number of threads building shards
+ */
+void DictionaryTrie::buildSharded(
+        std::vector<std::pair<std::string_view, unsigned int>> & entries,
+        unsigned int num_threads) {
+    /** Stable counting sort by first char keeps repeats in input order */
+    std::vector<unsigned int> starts(SHARD_COUNT + 1, 0);
+    for( unsigned int i = 0; i < entries.size(); i++) {
+        if( !entries[i].first.empty()) {
+            starts[shardOf(entries[i].first[0]) + 1]++;
+        }
+    }
+    for( unsigned int i = 0; i < SHARD_COUNT; i++) {
+        starts[i+1] += starts[i];
+    }
+    std::vector<std::pair<std::string_view, unsigned int>>
+        sharded(starts[SHARD_COUNT]);
+    std::vector<unsigned int> next(starts.begin(), starts.end() - 1);
+    for( unsigned int i = 0; i < entries.size(); i++) {
+        if( !entries[i].first.empty()) {
+            sharded[next[shardOf(entries[i].first[0])]++] = entries[i];
+        }
+    }
+    /** Non-empty shards in char order, each built by one thread */
+    struct Shard {
+        unsigned int first;
+        unsigned int last;
+        unsigned int root;
+        unsigned int owner;
+    };
+    std::vector<Shard> shards;
+    for( unsigned int i = 0; i < SHARD_COUNT; i++) {
+        if( starts[i] < starts[i+1]) {
+            Shard shard = { starts[i], starts[i+1], NULL_NODE, 0 };
+            shards.push_back(shard);
+        }
+    }
+    if( shards.empty()) {
+        return;
+    }
+    if( num_threads > shards.size()) {
+        num_threads = shards.size();
+    }
+    /** Biggest shards are claimed first so the threads finish together */
+    std::vector<unsigned int> order(shards.size());
+    for( unsigned int i = 0; i < order.size(); i++) {
+        order[i] = i;
+    }
+    std::sort(order.begin(), order.end(), [&](unsigned int a, unsigned int b)
+            { return shards[a].last - shards[a].first >
+                     shards[b].last - shards[b].first; });
+    std::vector<std::unique_ptr<TrieNodePool>> pools(num_threads);
+    std::vector<unsigned int> words(num_threads, 0);
+    std::vector<unsigned int> heights(num_threads, 0);
+    std::atomic<unsigned int> claimed(0);
+    std::vector<std::thread> threads;
+    for( unsigned int t = 0; t < num_threads; t++) {
+        pools[t].reset(new TrieNodePool());
+        threads.push_back(std::thread([&, t]() {
+            unsigned int i;
+            while( (i = claimed++) < order.size()) {
+                Shard & shard = shards[order[i]];
+                std::stable_sort(sharded.begin() + shard.first,
+                        sharded.begin() + shard.last, lessSigned);
+                std::atomic<unsigned int> shardRoot(NULL_NODE);
+                buildSiblings(*pools[t], sharded, &shardRoot, shard.first,
+                        shard.last, words[t], heights[t]);
+                shard.root = shardRoot;
+                shard.owner = t;
+            }
+            sweepBounds(*pools[t]);
+        }));
+    }
+    for( unsigned int t = 0; t < num_threads; t++) {
+        threads[t].join();
+    }
+    threads.clear();
+    /** Every pool lands in its own range, rebased by the range's offset */
+    std::vector<unsigned int> offsets(num_threads);
+    for( unsigned int t = 0; t < num_threads; t++) {
+        offsets[t] = nodes.allocateRange(pools[t]->size()) - 1;
+        isize += words[t];
+        if( iheight < heights[t]) {
+            iheight = heights[t];
+        }
+    }
+    for( unsigned int t = 0; t < num_threads; t++) {
+        threads.push_back(std::thread([&, t]() {
+            TrieNodePool & pool = *pools[t];
+            unsigned int offset = offsets[t];
+            for( unsigned int i = 1; i <= pool.size(); i++) {
+                const TrieNode & node = pool[i];
+                TrieNode * copy = new (&nodes[i + offset]) TrieNode(node.data);
+                copy->left.store(rebase(node.left, offset),
+                        std::memory_order_relaxed);
+                copy->right.store(rebase(node.right, offset),
+                        std::memory_order_relaxed);
+                copy->down.store(rebase(node.down, offset),
+                        std::memory_order_relaxed);
+                copy->freq.store(node.freq, std::memory_order_relaxed);
+                copy->maxFreq.store(node.maxFreq, std::memory_order_relaxed);
+                copy->minLength.store(node.minLength,
+                        std::memory_order_relaxed);
+                copy->maxLength.store(node.maxLength,
+                        std::memory_order_relaxed);
+            }
+            pools[t].reset();
+        }));
+    }
+    for( unsigned int t = 0; t < num_threads; t++) {
+        threads[t].join();
+    }
+    /** Root sibling BST over the shard roots, median shard at every
+     *  subtree, parents recorded before their children */
+    std::vector<unsigned int> linked;
+    std::vector<std::pair<std::atomic<unsigned int> *,
+        std::pair<unsigned int, unsigned int>>> spans;
+    spans.push_back(std::make_pair(&root,
+                std::make_pair(0U, (unsigned int) shards.size())));
+    while( !spans.empty()) {
+        std::atomic<unsigned int> * link = spans.back().first;
+        unsigned int first = spans.back().second.first;
+        unsigned int last = spans.back().second.second;
+        spans.pop_back();
+        if( first >= last) {
+            continue;
+        }
+        unsigned int mid = first + (last - first) / 2;
+        Shard & shard = shards[mid];
+        unsigned int currNode = shard.root + offsets[shard.owner];
+        link->store(currNode, std::memory_order_relaxed);
+        linked.push_back(currNode);
+        TrieNode & node = nodes[currNode];
+        spans.push_back(std::make_pair(&node.left,
+                    std::make_pair(first, mid)));
+        spans.push_back(std::make_pair(&node.right,
+                    std::make_pair(mid + 1, last)));
+    }
+    /** Shard roots only know their own subtree, add their siblings' */
+    for( unsigned int i = linked.size(); i > 0; i--) {
+        TrieNode & node = nodes[linked[i-1]];
+        unsigned int siblings[2] = { node.left, node.right };
+        for( unsigned int j = 0; j < 2; j++) {
+            if( siblings[j] == NULL_NODE) {
+                continue;
+            }
+            const TrieNode & sibling = nodes[siblings[j]];
+            if( sibling.maxFreq > node.maxFreq) {
+                node.maxFreq.store(sibling.maxFreq);
+            }
+            if( sibling.minLength < node.minLength) {
+                node.minLength.store(sibling.minLength);
+            }
+            if( sibling.maxLength > node.maxLength) {
+                node.maxLength.store(sibling.maxLength);
             }
         }
     }
-    return false;
 }
 
 /** Function Name: find(std::string word)
@@ -139,142 +663,138 @@ bool DictionaryTrie::insert(std::string word, unsigned int freq,
  *  Return Value: Return true if word is in the dictionary, and false otherwise
  */
 bool DictionaryTrie::find(std::string word) const {
-    /** Delegates to private instance of find */
-    return find(word, root, 0);
-}
-
-/** Function Name: find(std::string word, TrieNode * root, unsigned int height)
- *                      const
- *  Description: Helper to the public find(std::string word) function. Finds
- *               if a word is in the dictionary. True if word is in the
- *               dictionary, false otherwise.
- *  Parameters: word - The word to find in the Trie
- *              root - The root of the Trie
- *              height - The height of the Trie
- *  Return Value: True if word is in the dictionary, false otherwise
- */
-bool DictionaryTrie::find(std::string word, TrieNode * root,
-        unsigned int height) const {
-    /** Letters of word were not found in TST, not found */
-    if( root == nullptr) {
+    /** Empty string is never inserted */
+    if( word.empty()) {
         return false;
     }
-    /** Traverse to right child */
-    if (word[height] > root->data) {
-        return find(word, root->right, height);
-    }
-    /** Traverse to left child */
-    else if (word[height] < root->data) {
-        return find(word, root->left, height);
+    /** Walk to the node of the last char, it must be a word node */
+    unsigned int currNode = findNode(word, root, 0);
+    return currNode != NULL_NODE && nodes[currNode].freq != NO_WORD;
+}
+
+/** Function Name: frequency(std::string word) const
+ *  Description: Frequency of a word in the dictionary
+ *  Parameters: word - The word to look up
+ *  Return Value: The frequency of word, 0 if it is not in the dictionary
+ */
+unsigned int DictionaryTrie::frequency(std::string word) const {
+    if( word.empty()) {
+        return 0;
     }
-    /** Traverse to child below it (Letter found) */
-    else {
-        /** Check if there exists another letter in the word to find */
-        if( height+1 < word.size()) {
-            return find(word, root->down, height+1);
-        }
-        /** Word may be in TST or just a prefix to a word in the TST */
-        else {
-            /** Word is found in TST*/
-            if( root->word) {
-                return true;
-            }
-            /** Word was just a prefix in TST, not found */
-            else {
-                return false;
-            }
-        }
+    unsigned int currNode = findNode(word, root, 0);
+    if( currNode == NULL_NODE) {
+        return 0;
     }
-    return false;
+    int freq = nodes[currNode].freq;
+    return freq == NO_WORD ? 0 : freq;
 }
 
-/** Function Name: findNode(std::string prefix, TrieNode * currNode,
- *                      unsigned int height)
+/** Function Name: findNode(const std::string & prefix, unsigned int currNode,
+ *                      unsigned int height) const
  *  Description: Used to find the node corresponding to the ending char in
  *               prefix in TST
  *  Parameters: prefix - The string used to search the dictionary with
- *              currNode - Presumed to be the root pointer
+ *              currNode - Presumed to be the pool index of the root
  *              height - Height of tree, also used as index of prefix
- *  Return Value: A pointer to the node corresponding to the ending char in
- *                prefix
+ *  Return Value: The pool index of the node corresponding to the ending char
+ *                in prefix, NULL_NODE if there is none
  */
-TrieNode* DictionaryTrie::findNode(std::string prefix, TrieNode * currNode, 
-        unsigned int height) {
-    /** Base Case: Current node is nullptr */
-    if( currNode == nullptr) {
-        return nullptr;
-    }
-    /** Traverse to right child */
-    if(prefix[height] > currNode->data) {
-        return findNode(prefix, currNode->right, height);
-    }
-    /** Traverse to left child */
-    else if (prefix[height] < currNode->data) {
-        return findNode(prefix, currNode->left, height);
-    }
-    else {
+unsigned int DictionaryTrie::findNode(const std::string & prefix,
+        unsigned int currNode, unsigned int height) const {
+    while( currNode != NULL_NODE) {
+        const TrieNode & node = nodes[currNode];
+        /** Traverse to right child */
+        if( prefix[height] > node.data) {
+            currNode = node.right;
+        }
+        /** Traverse to left child */
+        else if( prefix[height] < node.data) {
+            currNode = node.left;
+        }
         /** Check if there exists another letter in the word to find */
-        if( height+1 < prefix.size()) {
-            return findNode(prefix, currNode->down, height+1);
+        else if( height+1 < prefix.size()) {
+            currNode = node.down;
+            height++;
         }
         /** Found the prefix node, return it */
-        else  {
+        else {
             return currNode;
         }
     }
+    return NULL_NODE;
 }
-/** Function Name: findCompletions(std::string prefix,
- *                      unsigned int num_completions, TrieNode * currNode,
- *                      std::vector<Word> * wordNodes)
- *  Description: Used to find all the words starting form the currNode
- *  Parameters: prefix - The prefix of any searched word
+
+/** Function Name: findCompletions(std::string & path,
+ *                      unsigned int num_completions, unsigned int currNode,
+ *                      std::priority_queue<Word,vector<Word>,Word> &
+ *                      wordNodes) const
+ *  Description: Used to find all the words starting form the currNode. The
+ *               subtree is walked with an explicit stack, and the word of a
+ *               node is only copied out of path when it enters the top
+ *               num_completions held in wordNodes.
+ *  Parameters: path - The prefix of any searched word, grown and shrunk in
+ *                     place while traversing and restored on return
  *              num_completions - The number of words to find
- *              currNode - A node pointer used to traverse the trie
- *              wordNodes - A vector of Words with prefix in its word
- */
-void DictionaryTrie::findCompletions(std::string prefix,
-        unsigned int num_completions, TrieNode * currNode,
-        std::priority_queue<Word,vector<Word>,Word> & wordNodes) {
-    /** Base Case: Return if the current node does not exist */
-    if( currNode == nullptr) {
-        return;
+ *              currNode - A node index used to traverse the trie
+ *              wordNodes - The most frequent words found so far
+ */
+void DictionaryTrie::findCompletions(std::string & path,
+        unsigned int num_completions, unsigned int currNode,
+        std::priority_queue<Word,vector<Word>,Word> & wordNodes) const {
+    unsigned int base = path.size();
+    /** Stack of (node, length of the path leading to the node) */
+    std::vector<std::pair<unsigned int, unsigned int>> stack;
+    if( currNode != NULL_NODE) {
+        stack.push_back(std::make_pair(currNode, base));
     }
-    /** Adds the word if the current node is a word node */
-    if( currNode->word == true) {
-        /** wordNodes is full */
-        if( wordNodes.size() == num_completions) {
-            /** Sort alphabetically if freq is the same, otherwise by freq */
-            if( (wordNodes.top().freq == currNode->freq && 
-                        wordNodes.top().s > prefix+currNode->data) || 
-                    (wordNodes.top().freq < currNode->freq)) {
-                /** Pop top (lowest in freq and alpha) element */
-                wordNodes.pop();
-                /** Push new (higher than prev lowest) element */
-                wordNodes.push(Word(prefix+currNode->data, currNode->freq));
+    while( !stack.empty()) {
+        currNode = stack.back().first;
+        unsigned int depth = stack.back().second;
+        stack.pop_back();
+        const TrieNode & node = nodes[currNode];
+        /** Path now spells the word ending at this node */
+        path.resize(depth);
+        path.push_back(node.data);
+        /** Read once, writers may change it while we look */
+        int freq = node.freq;
+        /** Adds the word if the current node is a word node */
+        if( freq != NO_WORD) {
+            /** wordNodes is full */
+            if( wordNodes.size() == num_completions) {
+                /** Sort alphabetically if freq is the same, otherwise by
+                 *  freq. Frequencies are compared first so the word is
+                 *  rarely read */
+                if( (wordNodes.top().freq < freq) ||
+                        (wordNodes.top().freq == freq &&
+                         wordNodes.top().s > path)) {
+                    /** Pop top (lowest in freq and alpha) element */
+                    wordNodes.pop();
+                    /** Push new (higher than prev lowest) element */
+                    wordNodes.push(Word(path, freq));
+                }
+            }
+            /** Push if wordNodes is not of size num_completions yet */
+            else {
+                wordNodes.push(Word(path, freq));
             }
         }
-        /** Push if wordNodes is not of size num_completions yet */
-        else {
-            wordNodes.push(Word(prefix+currNode->data, currNode->freq));
+        /** Siblings share the prefix without this node's char */
+        if( node.left != NULL_NODE) {
+            stack.push_back(std::make_pair(node.left.load(), depth));
+        }
+        if( node.right != NULL_NODE) {
+            stack.push_back(std::make_pair(node.right.load(), depth));
+        }
+        /** Down is pushed last so it runs while path still ends in data */
+        if( node.down != NULL_NODE) {
+            stack.push_back(std::make_pair(node.down.load(), depth+1));
         }
     }
-    /** Traverse down the tree */
-    if( currNode->down != nullptr) {
-        findCompletions(prefix+currNode->data, num_completions, currNode->down,
-                wordNodes);
-    }
-    /** Traverse right of the current node */
-    if( currNode->right != nullptr) {
-        findCompletions(prefix, num_completions, currNode->right, wordNodes);
-    }
-    /** Traverse left of the current node */
-    if( currNode->left != nullptr) {
-        findCompletions(prefix, num_completions, currNode->left, wordNodes);
-    }
+    path.resize(base);
 }
 
 /** Function Name: predictCompletions(std::string prefix,
- *                      unsigned int num_completions) 
+ *                      unsigned int num_completions) const
  *  Description: Return up to num_completions of the most frequent completions
  *               of the prefix, such that the completions are words in the
  *               dictionary. These completions should be listed from most
@@ -284,27 +804,57 @@ void DictionaryTrie::findCompletions(std::string prefix,
  *               the function returns a vector of size 0. The prefix itself
  *               might be included in the returned words if the prefix is a
  *               word (and is among the num_completions most frequent
- *               completions of the prefix)
+ *               completions of the prefix). An empty prefix completes from
+ *               the root, i.e. returns the most frequent words overall.
  * Parameters: prefix - The prefix of any word to be searched
  *             num_completions - The number of words to find with the prefix
  * Return Value: A vector of strings of words that have the prefix
  */
 std::vector<std::string> DictionaryTrie::predictCompletions(std::string prefix,
-        unsigned int num_completions) {
-    /** Find the node corresponding to the last char in the prefix */
-    TrieNode * currNode = findNode(prefix, root, 0);
-    /** Handles the case where the prefix is not in the tree */
-    if( currNode == nullptr || num_completions == 0) {
+        unsigned int num_completions) const {
+    /** Handles the case where nothing is asked for or nothing is stored */
+    if( root == NULL_NODE || num_completions == 0) {
         return {};
     }
+    /** NULL_NODE stands for the empty prefix above the root */
+    unsigned int currNode = NULL_NODE;
+    if( !prefix.empty()) {
+        /** Find the node corresponding to the last char in the prefix */
+        currNode = findNode(prefix, root, 0);
+        /** Handles the case where the prefix is not in the tree */
+        if( currNode == NULL_NODE) {
+            return {};
+        }
+    }
+    /** Answer from the completion index when it holds enough completions
+     *  and no writer changed the dictionary since it was built */
+    if( num_completions <= cacheK && !cacheStale) {
+        /** Cached ranks of the node, already sorted from most frequent */
+        unsigned int first = cacheStart[currNode];
+        unsigned int last = cacheStart[currNode+1];
+        if( last - first > num_completions) {
+            last = first + num_completions;
+        }
+        std::vector<std::string> predictions;
+        predictions.reserve(last - first);
+        for( unsigned int i = first; i < last; i++) {
+            predictions.push_back(cacheWords[cacheIds[i]]);
+        }
+        return predictions;
+    }
+    /** Expand the most promising subtrees first and stop early */
+    if( engine == BEST_FIRST) {
+        return findBestCompletions(prefix, num_completions, currNode);
+    }
     /** Create a vector of TrieNode pointers to hold potential candidates */
     std::priority_queue<Word, vector<Word>, Word> wordNodes;
     /** Determine if the prefix is a word, if so add it, else don't add it */
-    if( currNode->word == true) {
-        wordNodes.push(Word(prefix, currNode->freq));
+    int freq = currNode != NULL_NODE ? nodes[currNode].freq.load() : NO_WORD;
+    if( freq != NO_WORD) {
+        wordNodes.push(Word(prefix, freq));
     }
     /** Move down to include the prefix regardless if it is a word */
-    currNode = currNode->down;
+    currNode = (currNode == NULL_NODE) ? root : nodes[currNode].down;
     /** Find predictions and place them into wordNodes */
     findCompletions(prefix, num_completions, currNode, wordNodes);
     /** Initialize size of return vector */
@@ -325,57 +875,228 @@ std::vector<std::string> DictionaryTrie::predictCompletions(std::string prefix,
     return predictions;
 }
 
-/* Function Name: findPattern(std::string pattern, std::string prefix,
- *                      std::string postUnderscore, TrieNode * currNode, 
+/** Function Name: predictCompletionsBatch(
+ *                      const std::vector<std::string> & prefixes,
+ *                      unsigned int num_completions) const
+ *  Description: predictCompletions for every prefix of a batch. The prefixes
+ *               are spread over the query threads set by setQueryThreads, or
+ *               answered by the calling thread if there are none.
+ *  Parameters: prefixes - The prefixes to complete
+ *              num_completions - The number of words to find with every
+ *                                prefix
+ *  Return Value: The completions of prefixes[i] at index i
+ */
+std::vector<std::vector<std::string>> DictionaryTrie::predictCompletionsBatch(
+        const std::vector<std::string> & prefixes,
+        unsigned int num_completions) const {
+    std::vector<std::vector<std::string>> predictions(prefixes.size());
+    /** Every thread writes only the slots of the indices it claimed */
+    std::function<void(unsigned int)> job = [&](unsigned int i) {
+        predictions[i] = predictCompletions(prefixes[i], num_completions);
+    };
+    if( queryPool) {
+        queryPool->parallelFor(prefixes.size(), job);
+    }
+    else {
+        for( unsigned int i = 0; i < prefixes.size(); i++) {
+            job(i);
+        }
+    }
+    return predictions;
+}
+
+/** Function Name: setQueryThreads(unsigned int num_threads)
+ *  Description: Sets the number of threads answering a batch, the calling
+ *               thread included. 1 answers batches on the calling thread
+ *               only.
+ *  Parameters: num_threads - The number of threads per batch
+ */
+void DictionaryTrie::setQueryThreads(unsigned int num_threads) {
+    queryPool.reset(num_threads > 1 ? new ThreadPool(num_threads) : nullptr);
+}
+
+/** Function Name: findBestCompletions(const std::string & prefix,
+ *                      unsigned int num_completions,
+ *                      unsigned int currNode) const
+ *  Description: Best-first search below the prefix node. Subtrees are
+ *               expanded in order of their maxFreq bound, so words come out
+ *               from most to least frequent and the search stops once
+ *               num_completions words are found.
+ *  Parameters: prefix - The prefix of any searched word
+ *              num_completions - The number of words to find
+ *              currNode - The node ending the prefix, NULL_NODE for the
+ *                         empty prefix above the root
+ *  Return Value: The completions from most to least frequent
+ */
+std::vector<std::string> DictionaryTrie::findBestCompletions(
+        const std::string & prefix, unsigned int num_completions,
+        unsigned int currNode) const {
+    std::priority_queue<Candidate, vector<Candidate>, Candidate> frontier;
+    /** Prefixes of subtrees as (parent trail, char) links back to entry 0,
+     *  which is the prefix itself. Only words are ever spelled out. */
+    std::vector<std::pair<unsigned int, char>> trails;
+    trails.push_back(std::make_pair(0U, '\0'));
+    unsigned int below = root;
+    if( currNode != NULL_NODE) {
+        const TrieNode & prefixNode = nodes[currNode];
+        /** The prefix itself competes with its completions */
+        int freq = prefixNode.freq;
+        if( freq != NO_WORD) {
+            frontier.push(Candidate(freq, prefix));
+        }
+        below = prefixNode.down;
+    }
+    if( below != NULL_NODE) {
+        frontier.push(Candidate(nodes[below].maxFreq, below, 0));
+    }
+    std::vector<std::string> predictions;
+    expandBest(prefix, num_completions, frontier, trails, predictions);
+    return predictions;
+}
+
+/** Function Name: expandBest(const std::string & prefix,
  *                      unsigned int num_completions,
- *                      std::priority_queue<Word,vector<Word>,Word> & 
- *                      wordNodes);
+ *                      std::priority_queue<Candidate,vector<Candidate>,
+ *                      Candidate> & frontier,
+ *                      std::vector<std::pair<unsigned int, char>> & trails,
+ *                      std::vector<std::string> & predictions) const
+ *  Description: Pops the frontier of a best-first search, emitting words and
+ *               splitting subtrees, until predictions holds num_completions
+ *               words or nothing is left
+ *  Parameters: prefix - Spelled before the trail of every subtree
+ *              num_completions - The size predictions grows to at most
+ *              frontier - Words and subtrees still to visit
+ *              trails - Prefixes of the subtrees as (parent trail, char)
+ *                       links back to entry 0, which spells prefix
+ *              predictions - Words emitted, from most to least frequent
+ */
+void DictionaryTrie::expandBest(const std::string & prefix,
+        unsigned int num_completions,
+        std::priority_queue<Candidate,vector<Candidate>,Candidate> & frontier,
+        std::vector<std::pair<unsigned int, char>> & trails,
+        std::vector<std::string> & predictions) const {
+    string word;
+    while( !frontier.empty() && predictions.size() < num_completions) {
+        Candidate top = frontier.top();
+        frontier.pop();
+        /** No remaining subtree can hold a better word, emit it */
+        if( !top.subtree) {
+            predictions.push_back(top.s);
+            continue;
+        }
+        /** Split the subtree into its word, siblings and children */
+        const TrieNode & node = nodes[top.node];
+        int freq = node.freq;
+        if( freq != NO_WORD) {
+            /** Spell the word backwards from its trail, then the prefix */
+            word.clear();
+            word.push_back(node.data);
+            for( unsigned int t = top.trail; t != 0; t = trails[t].first) {
+                word.push_back(trails[t].second);
+            }
+            word.append(prefix.rbegin(), prefix.rend());
+            std::reverse(word.begin(), word.end());
+            frontier.push(Candidate(freq, word));
+        }
+        if( node.left != NULL_NODE) {
+            frontier.push(Candidate(nodes[node.left].maxFreq, node.left,
+                        top.trail));
+        }
+        if( node.right != NULL_NODE) {
+            frontier.push(Candidate(nodes[node.right].maxFreq, node.right,
+                        top.trail));
+        }
+        if( node.down != NULL_NODE) {
+            trails.push_back(std::make_pair(top.trail, node.data));
+            frontier.push(Candidate(nodes[node.down].maxFreq, node.down,
+                        trails.size() - 1));
+        }
+    }
+}
+
+/* Function Name: findPattern(const std::string & pattern,
+ *                      std::string & path,
+ *                      const std::string & postUnderscore,
+ *                      unsigned int currNode,
+ *                      unsigned int num_completions,
+ *                      std::priority_queue<Word,vector<Word>,Word> &
+ *                      wordNodes) const
  * Description: Pushes up to num_completions of the most frequent
  *              completions of the pattern, such that the completions
- *              are words in the dictionary to the parameter wordNodes
+ *              are words in the dictionary to the parameter wordNodes. The
+ *              subtree is walked with an explicit stack, and the word of a
+ *              node is only copied out of path when it matches and enters
+ *              the top num_completions, so wordNodes never grows past them.
  * Parameters: pattern - The pattern to find in the TST
- *             prefix - The prefix to look for in the TST
+ *             path - The prefix to look for in the TST, grown and shrunk in
+ *                    place while traversing and restored on return
  *             postUnderscore - The string after the underscore char
- *             currNode - A pointer used to traverse the tree
+ *             currNode - A node index used to traverse the tree
  *             num_completions - The number of words to find via the pattern
  *             wordNodes - Vector holding the predictions from pattern
  * Return Value: None
  */
-void DictionaryTrie::findPattern(std::string pattern, std::string prefix,
-        std::string postUnderscore, TrieNode * currNode,
-        unsigned int num_completions, 
-        std::priority_queue<Word,vector<Word>,Word> & wordNodes) {
-    /** Base Case: Return if the current node does not exist */
-    if( currNode == nullptr) {
-        return;
-    }
-    /** Adds word if it is a word, of correct size, and matches the pattern */
-    if( currNode->word == true &&
-            (prefix+currNode->data).size() == pattern.size() &&
-            (prefix+currNode->data).substr(pattern.find(UNDERSCORE)+1,
-                string::npos) == postUnderscore) {
-        /** Push word to priority queue */
-        wordNodes.push(Word(prefix+currNode->data, currNode->freq));
+void DictionaryTrie::findPattern(const std::string & pattern,
+        std::string & path, const std::string & postUnderscore,
+        unsigned int currNode, unsigned int num_completions,
+        std::priority_queue<Word,vector<Word>,Word> & wordNodes) const {
+    unsigned int base = path.size();
+    /** Stack of (node, length of the path leading to the node) */
+    std::vector<std::pair<unsigned int, unsigned int>> stack;
+    if( currNode != NULL_NODE) {
+        stack.push_back(std::make_pair(currNode, base));
     }
-    /** Traverse down the tree */
-    if( currNode->down != nullptr) {
-        findPattern(pattern, prefix+currNode->data, postUnderscore, 
-                currNode->down, num_completions, wordNodes);
-    }
-    /** Traverse right of the current node */
-    if( currNode->right != nullptr) {
-        findPattern(pattern, prefix, postUnderscore, 
-                currNode->right, num_completions, wordNodes);
-    }
-    /** Traverse left of the current node */
-    if( currNode->left != nullptr) {
-        findPattern(pattern, prefix, postUnderscore, 
-                currNode->left, num_completions, wordNodes);
+    while( !stack.empty()) {
+        currNode = stack.back().first;
+        unsigned int depth = stack.back().second;
+        stack.pop_back();
+        const TrieNode & node = nodes[currNode];
+        /** Skip the subtree if none of its words is as long as pattern */
+        if( !PatternMatcher::reaches(node, pattern.size() - depth,
+                    pattern.size() - depth)) {
+            continue;
+        }
+        /** Path now spells the word ending at this node */
+        path.resize(depth);
+        path.push_back(node.data);
+        int freq = node.freq;
+        /** Adds word if it is a word, of correct size, could enter the top
+         *  num_completions and matches pattern. Frequencies are compared
+         *  first so the word is rarely read */
+        if( freq != NO_WORD && path.size() == pattern.size() &&
+                (wordNodes.size() < num_completions ||
+                 wordNodes.top().freq <= freq) &&
+                path.compare(path.size() - postUnderscore.size(),
+                    string::npos, postUnderscore) == 0) {
+            /** wordNodes is not of size num_completions yet */
+            if( wordNodes.size() < num_completions) {
+                wordNodes.push(Word(path, freq));
+            }
+            /** Replace the lowest word if this one sorts before it */
+            else if( wordNodes.top().freq < freq ||
+                    wordNodes.top().s > path) {
+                wordNodes.pop();
+                wordNodes.push(Word(path, freq));
+            }
+        }
+        /** Siblings share the prefix without this node's char */
+        if( node.left != NULL_NODE) {
+            stack.push_back(std::make_pair(node.left.load(), depth));
+        }
+        if( node.right != NULL_NODE) {
+            stack.push_back(std::make_pair(node.right.load(), depth));
+        }
+        /** Down is pushed last so it runs while path still ends in data.
+         *  Words below a node as long as the pattern are too long. */
+        if( node.down != NULL_NODE && path.size() < pattern.size()) {
+            stack.push_back(std::make_pair(node.down.load(), depth+1));
+        }
     }
+    path.resize(base);
 }
 
 /* Function Name: predictUnderscore(std::string pattern, unsigned int
- *                      num_completions)
+ *                      num_completions) const
  * Description: Return up to num_completions of the most frequent completions
  *              of the pattern, such that the completions are words in the
  *              dictionary. These completions should be listed from most
@@ -391,7 +1112,7 @@ void DictionaryTrie::findPattern(std::string pattern, std::string prefix,
  * Return Value: A vector of strings with words that are apart of the pattern
  */
 std::vector<string> DictionaryTrie::predictUnderscore(std::string pattern,
-        unsigned int num_completions) {
+        unsigned int num_completions) const {
     /** Validity test for num_completions */
     if( num_completions == 0 || pattern.empty()) {
         return {};
@@ -406,8 +1127,8 @@ std::vector<string> DictionaryTrie::predictUnderscore(std::string pattern,
     if( underScoreIdx+1 < pattern.size()) {
         postUnderscore = pattern.substr(underScoreIdx+1, string::npos);
     }
-    /** Create node pointer to find predictions */
-    TrieNode * currNode;
+    /** Create node index to find predictions */
+    unsigned int currNode;
     /** Underscore was the first character in the pattern */
     if( preUnderscore.empty()) {
         /** Set starting node to search as root */
@@ -419,11 +1140,11 @@ std::vector<string> DictionaryTrie::predictUnderscore(std::string pattern,
         currNode = findNode(preUnderscore, root, 0);
     }
     /** Did not find the characters before underscore in tree */
-    if( currNode == nullptr) {
+    if( currNode == NULL_NODE) {
         return {};
     }
     /** Take in the node corresponding to the first char before underscore */
-    currNode = currNode->down;
+    currNode = nodes[currNode].down;
     /** Create priority queue to hold and sort predictions */
     std::priority_queue<Word, vector<Word>, Word> wordNodes;
     /** Handles finding predictions for when underscore is the first char */
@@ -438,24 +1159,8 @@ std::vector<string> DictionaryTrie::predictUnderscore(std::string pattern,
         findPattern(pattern, preUnderscore, postUnderscore, currNode,
                 num_completions, wordNodes);
     }
-    /** Holds size of the vector to hold predictions */
-    unsigned int size = num_completions;
-    /** Int representing the diff in sizes of words found and words printed */
-    int diff = 0;
-    /** Found less elem than num_completions, size is how much we found*/
-    if( wordNodes.size() < num_completions) {
-        /** New size of return vector is wordNode's size */
-        size = wordNodes.size();
-    }
-    /** Found more/equal to num_completions elem, size is num_completions */
-    else {
-        /** Find the number of elements to pop */
-        diff = wordNodes.size()-num_completions;
-        /** Pop elements not printed out to user */
-        for( int i = 0; i < diff; i++) {
-            wordNodes.pop();
-        }
-    }
+    /** findPattern kept no more than num_completions words */
+    unsigned int size = wordNodes.size();
     /** Create vector to hold final strings printed to user */
     std::vector<std::string> predictions(size);
     /** Transfer strings from priority queue to vector */
@@ -468,22 +1173,357 @@ std::vector<string> DictionaryTrie::predictUnderscore(std::string pattern,
     return predictions;
 }
 
-/** Function Name: deleteTrie(TrieNode * currNode)
- *  Description: Helper to delete the tree from the root node
+/** Function Name: predictPattern(std::string pattern,
+ *                      unsigned int num_completions) const
+ *  Description: Return up to num_completions of the most frequent words
+ *               matching the pattern, listed from most frequent to least.
+ *               Every UNDERSCORE in the pattern stands for any one char and
+ *               every STAR for any run of chars, the empty run included.
+ *  Parameters: pattern - The pattern to match in the TST
+ *              num_completions - The number of words to find via the pattern
+ *  Return Value: A vector of strings of the words matching pattern
+ */
+std::vector<std::string> DictionaryTrie::predictPattern(std::string pattern,
+        unsigned int num_completions) const {
+    return PatternMatcher(pattern).match(nodes, root, num_completions);
+}
+
+/** Struct FuzzyStep
+ *  Description: Node still to visit in the edit distance walk of
+ *               predictFuzzy, with the state of the path leading to it
+ */
+struct FuzzyStep {
+    unsigned int node; /** The node to visit */
+    unsigned int depth; /** Length of the path leading to the node */
+    unsigned int trail; /** Trail entry spelling that path */
+    unsigned int best; /** Fewest edits from a prefix of the path to the
+                        *  whole prefix, maxEdits + 1 if too many */
+};
+
+/** Function Name: predictFuzzy(std::string prefix, unsigned int maxEdits,
+ *                      unsigned int num_completions) const
+ *  Description: Return up to num_completions words that complete a string
+ *               within maxEdits insertions, deletions or substitutions of
+ *               the prefix, so "helo" still suggests "hello". Words come
+ *               out by fewest edits, then from most to least frequent. The
+ *               TST is walked with one row of the edit distance table per
+ *               path char, skipping any subtree whose row is all over
+ *               maxEdits. Once no longer path can get closer to the prefix,
+ *               the whole subtree is left to the best-first search of its
+ *               edit distance.
+ *  Parameters: prefix - The mistyped prefix of any word to be searched
+ *              maxEdits - The most edits allowed between the prefix and a
+ *                         prefix of a returned word
+ *              num_completions - The number of words to find
+ *  Return Value: A vector of strings of words near the prefix
+ */
+std::vector<std::string> DictionaryTrie::predictFuzzy(std::string prefix,
+        unsigned int maxEdits, unsigned int num_completions) const {
+    if( num_completions == 0) {
+        return {};
+    }
+    /** Every word completes the empty prefix with no edits */
+    if( prefix.empty()) {
+        return predictCompletions(prefix, num_completions);
+    }
+    /** Deleting the whole prefix always matches, no word is further */
+    if( maxEdits > prefix.size()) {
+        maxEdits = prefix.size();
+    }
+    unsigned int width = prefix.size() + 1;
+    /** Row d holds the edit distances from the first d chars of the path to
+     *  every prefix of prefix. Row 0 is the empty path. */
+    std::vector<unsigned int> rows(width);
+    for( unsigned int j = 0; j < width; j++) {
+        rows[j] = j;
+    }
+    /** Best-first frontier of the words and subtrees at every distance */
+    std::vector<std::priority_queue<Candidate, vector<Candidate>, Candidate>>
+        levels(maxEdits + 1);
+    std::vector<std::pair<unsigned int, char>> trails;
+    trails.push_back(std::make_pair(0U, '\0'));
+    string path;
+    std::vector<FuzzyStep> stack;
+    if( root != NULL_NODE) {
+        stack.push_back({root, 0, 0, prefix.size() <= maxEdits ?
+                (unsigned int)prefix.size() : maxEdits + 1});
+    }
+    while( !stack.empty()) {
+        FuzzyStep step = stack.back();
+        stack.pop_back();
+        const TrieNode & node = nodes[step.node];
+        /** Siblings share the row above, pushed first so they run after the
+         *  subtree below this node is done with the rows past it */
+        if( node.left != NULL_NODE) {
+            stack.push_back({node.left, step.depth, step.trail, step.best});
+        }
+        if( node.right != NULL_NODE) {
+            stack.push_back({node.right, step.depth, step.trail, step.best});
+        }
+        if( rows.size() < (step.depth + 2) * width) {
+            rows.resize((step.depth + 2) * width);
+        }
+        const unsigned int * above = &rows[step.depth * width];
+        unsigned int * row = &rows[(step.depth + 1) * width];
+        row[0] = above[0] + 1;
+        unsigned int lowest = row[0];
+        for( unsigned int j = 1; j < width; j++) {
+            unsigned int edit = above[j-1] + (prefix[j-1] != node.data);
+            unsigned int gap = std::min(above[j], row[j-1]) + 1;
+            row[j] = std::min(edit, gap);
+            lowest = std::min(lowest, row[j]);
+        }
+        unsigned int best = std::min(step.best, row[width-1]);
+        /** No word through this node is close enough */
+        if( best > maxEdits && lowest > maxEdits) {
+            continue;
+        }
+        path.resize(step.depth);
+        path.push_back(node.data);
+        int freq = node.freq;
+        if( best <= maxEdits && freq != NO_WORD) {
+            levels[best].push(Candidate(freq, path));
+        }
+        if( node.down == NULL_NODE) {
+            continue;
+        }
+        trails.push_back(std::make_pair(step.trail, node.data));
+        /** A longer path only adds to every entry of the row */
+        if( best <= maxEdits && lowest >= best) {
+            levels[best].push(Candidate(nodes[node.down].maxFreq, node.down,
+                        trails.size() - 1));
+        }
+        else {
+            stack.push_back({node.down, step.depth + 1,
+                    (unsigned int)trails.size() - 1, best});
+        }
+    }
+    std::vector<std::string> predictions;
+    for( unsigned int edits = 0; edits <= maxEdits &&
+            predictions.size() < num_completions; edits++) {
+        expandBest("", num_completions, levels[edits], trails, predictions);
+    }
+    return predictions;
+}
+
+/** Function Name: mergeRanks(const std::vector<unsigned int> & first,
+ *                      const std::vector<unsigned int> & second,
+ *                      unsigned int k, std::vector<unsigned int> & merged)
+ *  Description: Merges two ascending lists of completion ranks, keeping only
+ *               the k best (lowest) ranks
+ *  Parameters: first - Ascending ranks
+ *              second - Ascending ranks, disjoint from first
+ *              k - Maximum number of ranks to keep
+ *              merged - Output list, overwritten with the k best ranks
+ */
+static void mergeRanks(const std::vector<unsigned int> & first,
+        const std::vector<unsigned int> & second, unsigned int k,
+        std::vector<unsigned int> & merged) {
+    merged.clear();
+    unsigned int i = 0;
+    unsigned int j = 0;
+    while( merged.size() < k && (i < first.size() || j < second.size())) {
+        if( j == second.size() || (i < first.size() && first[i] < second[j])) {
+            merged.push_back(first[i++]);
+        }
+        else {
+            merged.push_back(second[j++]);
+        }
+    }
+}
+
+/** Function Name: buildCompletionCache(unsigned int k)
+ *  Description: Builds the top-k completion index. Every node keeps the k
+ *               most frequent completions of the prefix ending at it, so
+ *               predictCompletions with num_completions <= k becomes a prefix
+ *               walk plus a copy. Larger requests still traverse the subtree.
+ *               Any insert, increment or upsert afterwards leaves the index
+ *               unused until it is built again, since it would be stale.
+ *  Parameters: k - The number of completions cached at every node
  */
-void DictionaryTrie::deleteTrie(TrieNode * currNode) {
-    /** Recursively traverse down the tree and delete all nodes */
-    if(currNode != nullptr) {
-        deleteTrie(currNode->left);
-        deleteTrie(currNode->right);
-        deleteTrie(currNode->down);
-        delete currNode;
+void DictionaryTrie::buildCompletionCache(unsigned int k) {
+    dropCompletionCache();
+    if( k == 0 || root == NULL_NODE) {
+        return;
+    }
+    /** Node indices run from 1 to nodes.size() */
+    unsigned int count = nodes.size() + 1;
+    /** Pre-order listing of the nodes so children can be handled first */
+    std::vector<unsigned int> order;
+    order.reserve(count);
+    /** Every word of the dictionary and the node it ends at */
+    std::vector<Word> words;
+    std::vector<unsigned int> wordNode;
+    /** Explicit DFS stack of (node, depth), path holds the current prefix */
+    std::vector<std::pair<unsigned int, unsigned int>> stack;
+    string path;
+    stack.push_back(std::make_pair(root.load(), 0U));
+    while( !stack.empty()) {
+        unsigned int currNode = stack.back().first;
+        unsigned int depth = stack.back().second;
+        stack.pop_back();
+        order.push_back(currNode);
+        const TrieNode & node = nodes[currNode];
+        /** Prefix of this node plus its own char */
+        path.resize(depth);
+        path.push_back(node.data);
+        int freq = node.freq;
+        if( freq != NO_WORD) {
+            words.push_back(Word(path, freq));
+            wordNode.push_back(currNode);
+        }
+        if( node.left != NULL_NODE) {
+            stack.push_back(std::make_pair(node.left.load(), depth));
+        }
+        if( node.right != NULL_NODE) {
+            stack.push_back(std::make_pair(node.right.load(), depth));
+        }
+        /** Down is pushed last so it runs while path still ends in data */
+        if( node.down != NULL_NODE) {
+            stack.push_back(std::make_pair(node.down.load(), depth+1));
+        }
+    }
+    /** Rank the words from most to least frequent, ties alphabetically */
+    std::vector<unsigned int> byRank(words.size());
+    for( unsigned int i = 0; i < byRank.size(); i++) {
+        byRank[i] = i;
     }
+    std::sort(byRank.begin(), byRank.end(),
+            [&words](unsigned int a, unsigned int b) {
+                return Word()(words[a], words[b]);
+            });
+    std::vector<unsigned int> nodeRank(count, 0);
+    cacheWords.resize(words.size());
+    for( unsigned int rank = 0; rank < byRank.size(); rank++) {
+        nodeRank[wordNode[byRank[rank]]] = rank;
+        cacheWords[rank].swap(words[byRank[rank]].s);
+    }
+    /** Best ranks at each node (cache) and in its whole TST subtree (sub) */
+    std::vector<std::vector<unsigned int>> cache(count);
+    std::vector<std::vector<unsigned int>> sub(count);
+    std::vector<unsigned int> own;
+    std::vector<unsigned int> merged;
+    /** Reverse pre-order visits every child before its parent */
+    for( unsigned int i = order.size(); i-- > 0; ) {
+        unsigned int currNode = order[i];
+        const TrieNode & node = nodes[currNode];
+        own.clear();
+        if( node.freq != NO_WORD) {
+            own.push_back(nodeRank[currNode]);
+        }
+        /** Completions of the prefix: the word itself and everything below */
+        mergeRanks(own, sub[node.down], k, cache[currNode]);
+        /** The subtree adds the left and right siblings */
+        mergeRanks(cache[currNode], sub[node.left], k, merged);
+        mergeRanks(merged, sub[node.right], k, sub[currNode]);
+        /** Each child has exactly one parent, its list is no longer needed */
+        std::vector<unsigned int>().swap(sub[node.down]);
+        std::vector<unsigned int>().swap(sub[node.left]);
+        std::vector<unsigned int>().swap(sub[node.right]);
+    }
+    /** The empty prefix completes from the root, keep its list in the slot
+     *  of the reserved NULL_NODE index */
+    cache[NULL_NODE].swap(sub[root]);
+    /** Flatten the per node lists in node index order */
+    cacheStart.resize(count + 1);
+    unsigned int total = 0;
+    for( unsigned int currNode = 0; currNode < count; currNode++) {
+        cacheStart[currNode] = total;
+        total += cache[currNode].size();
+    }
+    cacheStart[count] = total;
+    cacheIds.reserve(total);
+    for( unsigned int currNode = 0; currNode < count; currNode++) {
+        cacheIds.insert(cacheIds.end(), cache[currNode].begin(),
+                cache[currNode].end());
+    }
+    cacheK = k;
+    cacheStale = false;
+}
+
+/** Function Name: dropCompletionCache()
+ *  Description: Releases the top-k completion index, if any
+ */
+void DictionaryTrie::dropCompletionCache() {
+    cacheK = 0;
+    cacheStale = false;
+    std::vector<std::string>().swap(cacheWords);
+    std::vector<unsigned int>().swap(cacheStart);
+    std::vector<unsigned int>().swap(cacheIds);
+}
+
+/** Function Name: cacheMemoryUsage() const
+ *  Description: Memory held by the top-k completion index
+ *  Return Value: The number of bytes used by the index, 0 if none
+ */
+size_t DictionaryTrie::cacheMemoryUsage() const {
+    size_t bytes = cacheStart.capacity() * sizeof(unsigned int) +
+        cacheIds.capacity() * sizeof(unsigned int) +
+        cacheWords.capacity() * sizeof(std::string);
+    for( unsigned int i = 0; i < cacheWords.size(); i++) {
+        /** Short words live inside the string object itself */
+        const char * data = cacheWords[i].data();
+        const char * self = (const char *) &cacheWords[i];
+        if( data < self || data >= self + sizeof(std::string)) {
+            bytes += cacheWords[i].capacity() + 1;
+        }
+    }
+    return bytes;
+}
+
+/** Function Name: averageWordDepth() const
+ *  Description: Average number of nodes visited (left, right and down steps)
+ *               to reach the node of a word, i.e. the average cost of find or
+ *               findNode on a stored word
+ *  Return Value: The average depth of word nodes, 0 if empty
+ */
+double DictionaryTrie::averageWordDepth() const {
+    unsigned long long total = 0;
+    unsigned long long words = 0;
+    /** Stack of (node, number of nodes visited to reach it) */
+    std::vector<std::pair<unsigned int, unsigned int>> stack;
+    if( root != NULL_NODE) {
+        stack.push_back(std::make_pair(root.load(), 1U));
+    }
+    while( !stack.empty()) {
+        unsigned int currNode = stack.back().first;
+        unsigned int depth = stack.back().second;
+        stack.pop_back();
+        const TrieNode & node = nodes[currNode];
+        if( node.freq != NO_WORD) {
+            total += depth;
+            words++;
+        }
+        unsigned int children[3] = { node.left, node.right, node.down };
+        for( unsigned int i = 0; i < 3; i++) {
+            if( children[i] != NULL_NODE) {
+                stack.push_back(std::make_pair(children[i], depth + 1));
+            }
+        }
+    }
+    return words == 0 ? 0 : (double) total / words;
+}
+
+/** Function Name: nodeCount() const
+ *  Description: Number of TrieNodes making up the TST
+ *  Return Value: The number of nodes allocated from the node pool and not
+ *                released back to it
+ */
+unsigned int DictionaryTrie::nodeCount() const {
+    return nodes.size() - nodes.released();
+}
+
+/** Function Name: memoryUsage() const
+ *  Description: Memory held by the node pool of the TST
+ *  Return Value: The number of bytes reserved for TrieNodes
+ */
+size_t DictionaryTrie::memoryUsage() const {
+    return nodes.bytes();
 }
 
 /* Destructor
- * Description: Deletes the tree nodes
+ * Description: Releases the node pool holding the tree nodes. The pool frees
+ *              whole slabs, so no traversal of the tree is needed.
  */
 DictionaryTrie::~DictionaryTrie() {
-    deleteTrie(root);
 }
@@ -12,30 +12,133 @@
 #define DICTIONARY_TRIE_HPP
 
 #include "TrieNode.hpp"
+#include "ThreadPool.hpp"
+#include <memory>
 #include <vector>
 #include <string>
+#include <string_view>
+#include <atomic>
 #include <queue>
 #define UNDERSCORE '_'
+#define STAR '*' /** Pattern char standing for any run of chars */
+#define DEFAULT_CACHE_K 16 /** Default number of completions cached per node */
 
 using namespace std;
 
-/** Declares a struct Word used to hold a string and its frequency in the TST
-*/
-struct Word;
+/** Struct Word
+ *  Description: Used to hold a string and its frequency in the TST
+ */
+struct Word {
+
+    int freq; /** Frequency of the string s in the TST */
+    string s; /** The string created by traversing the TST */
+
+    /** Default construct
+     *  Description: Initializes s and freq to zero-like values
+     */
+    Word() : freq(0), s() {}
+
+    /** Constructor
+     *  Description: Initalizes instance variables s and freq to the passed
+     *               in parameters s and freq
+     */
+    Word(const string & s, const unsigned int freq) : freq(freq), s(s) {}
+
+    /** Operator()
+     *  Description: Used to compare two Word structs based first on freq,
+     *               but if freq is the same, then it is based alphabetically
+     *  Return Value: True if w1 is less than w2, False otherwise
+     */
+    bool operator() (const Word & w1, const Word & w2) const {
+        /** Frequency is the same, sort by alphabetical order */
+        if( w1.freq == w2.freq) {
+            return w1.s < w2.s;
+        }
+        /** Frequency differ, sort by frequency */
+        return w1.freq > w2.freq;
+    }
+};
+
+/** Struct Candidate
+ *  Description: Entry of the best-first completion search. It is either a
+ *               finished word or a whole TST subtree that still has to be
+ *               expanded, keyed by the word frequency or the subtree's
+ *               maxFreq bound respectively.
+ */
+struct Candidate {
+
+    int key; /** Word frequency, or highest frequency in the subtree */
+    bool subtree; /** True if node is an unexpanded subtree */
+    unsigned int node; /** Root of the subtree, unused for words */
+    unsigned int trail; /** Trail entry spelling the subtree's prefix */
+    string s; /** The word, empty for subtrees */
+
+    /** Default construct
+     *  Description: Initializes the candidate to zero-like values
+     */
+    Candidate() : key(0), subtree(false), node(NULL_NODE), trail(0), s() {}
+
+    /** Constructor
+     *  Description: Creates a subtree candidate
+     */
+    Candidate(int key, unsigned int node, unsigned int trail) : key(key),
+        subtree(true), node(node), trail(trail), s() {}
+
+    /** Constructor
+     *  Description: Creates a word candidate
+     */
+    Candidate(int key, const string & s) : key(key), subtree(false),
+        node(NULL_NODE), trail(0), s(s) {}
+
+    /** Operator()
+     *  Description: Orders candidates for std::priority_queue, whose top is
+     *               the greatest element. Higher keys come first. On a tie a
+     *               subtree is expanded before a word is emitted since it may
+     *               hold an alphabetically smaller word of that frequency,
+     *               and words of equal frequency come out alphabetically.
+     *  Return Value: True if c1 should come out after c2, False otherwise
+     */
+    bool operator() (const Candidate & c1, const Candidate & c2) const {
+        if( c1.key != c2.key) {
+            return c1.key < c2.key;
+        }
+        if( c1.subtree != c2.subtree) {
+            return c2.subtree;
+        }
+        if( c1.subtree) {
+            return c1.node > c2.node;
+        }
+        return c1.s > c2.s;
+    }
+};
 
 /** Class Name: DictionaryTrie
- *  Description: The class for a dictionary ADT, implented as a Trie (TST) 
+ *  Description: The class for a dictionary ADT, implented as a Trie (TST).
+ *               Const methods only read the TST, so any number of threads
+ *               may query one dictionary at once. insert, increment and
+ *               upsert are lock-free and may run alongside each other and
+ *               alongside queries; other non-const methods must not run
+ *               concurrently with anything else.
  */
 class DictionaryTrie
 {
     public:
 
+        /** Enum Name: CompletionEngine
+         *  Description: Traversal used by predictCompletions when the
+         *               completion cache cannot answer the query
+         *  EXHAUSTIVE_DFS - Visits every node below the prefix
+         *  BEST_FIRST - Expands subtrees in order of their highest word
+         *               frequency and stops after num_completions words
+         */
+        enum CompletionEngine { EXHAUSTIVE_DFS, BEST_FIRST };
+
         /** Constructor
          *  Description: Create a new Dictionary that uses a Trie back end
          */
         DictionaryTrie();
 
-        /** Function Name: insert(std::string word, unsigned int freq)
+        /** Function Name: insert(std::string_view word, unsigned int freq)
          *  Description: Insert a word with its frequency into the dictionary
          *  Parameters: word - The word to insert into the dictionary
          *              freq - The frequency of the word to insert into the
@@ -46,7 +149,51 @@ class DictionaryTrie
          *                testing when you want to test a certain case, but
          *                don't want to write out a specific word 300 times.
          */
-        bool insert(std::string word, unsigned int freq);
+        bool insert(std::string_view word, unsigned int freq);
+
+        /** Function Name: increment(std::string_view word,
+         *                      unsigned int delta)
+         *  Description: Adds delta to the frequency of a word, inserting the
+         *               word with frequency delta if it is not in the
+         *               dictionary. Frequencies saturate at INT_MAX.
+         *  Parameters: word - The word whose frequency grows
+         *              delta - The amount to add
+         *  Return Value: True if the word was inserted, false if it was
+         *                already there or is invalid (empty string)
+         */
+        bool increment(std::string_view word, unsigned int delta);
+
+        /** Function Name: upsert(std::string_view word, unsigned int freq)
+         *  Description: Sets the frequency of a word, inserting the word if
+         *               it is not in the dictionary
+         *  Parameters: word - The word to insert or update
+         *              freq - The new frequency of the word
+         *  Return Value: True if the word was inserted, false if it was
+         *                already there or is invalid (empty string)
+         */
+        bool upsert(std::string_view word, unsigned int freq);
+
+        /** Function Name: build(std::vector<std::pair<std::string_view,
+         *                      unsigned int>> entries,
+         *                      unsigned int num_threads)
+         *  Description: Bulk insert of (word, freq) entries. The entries are
+         *               sorted and, on an empty dictionary, every sibling BST
+         *               is built from the median char of its range down, so
+         *               it is balanced even if the input was sorted. With
+         *               several threads the entries are sharded by first char
+         *               and the shards are sorted and built concurrently,
+         *               then stitched under the root sibling BST; the TST is
+         *               the same either way. On a non-empty dictionary the
+         *               entries are inserted in median order by this thread
+         *               instead. As with insert, empty words and repeats of
+         *               a word already present are skipped.
+         *  Parameters: entries - The (word, freq) pairs to insert, the words
+         *                      only need to outlive the call
+         *              num_threads - The number of threads building shards
+         */
+        void build(
+                std::vector<std::pair<std::string_view, unsigned int>> entries,
+                unsigned int num_threads = 1);
 
         /** Function Name: find(std::string word)
          *  Description: Finds if a word is in the dictionary
@@ -56,8 +203,16 @@ class DictionaryTrie
          */
         bool find(std::string word) const;
 
+        /** Function Name: frequency(std::string word) const
+         *  Description: Frequency of a word in the dictionary
+         *  Parameters: word - The word to look up
+         *  Return Value: The frequency of word, 0 if it is not in the
+         *                dictionary
+         */
+        unsigned int frequency(std::string word) const;
+
         /** Function Name: predictCompletions(std::string prefix,
-         *                      unsigned int num_completions) 
+         *                      unsigned int num_completions) const
          *  Description: Return up to num_completions of the most frequent
          *               completions of the prefix, such that the completions
          *               are words in the dictionary. These completions should
@@ -68,17 +223,18 @@ class DictionaryTrie
          *               returns a vector of size 0. The prefix itself might be
          *               included in the returned words if the prefix is a word
          *               (and is among the num_completions most frequent
-         *               completions of the prefix)
+         *               completions of the prefix). An empty prefix
+         *               completes from the root.
          * Parameters: prefix - The prefix of any word to be searched
          *             num_completions - The number of words to find with the
          *                               prefix
          * Return Value: A vector of strings of words that have the prefix
          */
         std::vector<std::string> predictCompletions(std::string prefix,
-                unsigned int num_completions);
+                unsigned int num_completions) const;
 
         /* Function Name: predictUnderscore(std::string pattern, unsigned int
-         *                      num_completions)
+         *                      num_completions) const
          * Description: Return up to num_completions of the most frequent
          *              completions of the pattern, such that the completions
          *              are words in the dictionary. These completions should
@@ -97,104 +253,312 @@ class DictionaryTrie
          *               pattern
          */
         std::vector<std::string> predictUnderscore(std::string pattern,
-                unsigned int num_completions);
+                unsigned int num_completions) const;
+
+        /** Function Name: predictPattern(std::string pattern,
+         *                      unsigned int num_completions) const
+         *  Description: Return up to num_completions of the most frequent
+         *               words matching the pattern, listed from most
+         *               frequent to least. Every UNDERSCORE in the pattern
+         *               stands for any one char and every STAR for any run
+         *               of chars, the empty run included, so "c_t" finds
+         *               "cat" and "*ing" finds words ending in "ing".
+         *  Parameters: pattern - The pattern to match in the TST
+         *              num_completions - The number of words to find via
+         *                                the pattern
+         *  Return Value: A vector of strings of the words matching pattern
+         */
+        std::vector<std::string> predictPattern(std::string pattern,
+                unsigned int num_completions) const;
+
+        /** Function Name: predictFuzzy(std::string prefix,
+         *                      unsigned int maxEdits,
+         *                      unsigned int num_completions) const
+         *  Description: Return up to num_completions words that complete a
+         *               string within maxEdits insertions, deletions or
+         *               substitutions of the prefix, so "helo" still
+         *               suggests "hello". Words come out by fewest edits,
+         *               then from most to least frequent. With no edits it
+         *               returns what predictCompletions does.
+         *  Parameters: prefix - The mistyped prefix of any word to be
+         *                       searched
+         *              maxEdits - The most edits allowed between the prefix
+         *                         and a prefix of a returned word
+         *              num_completions - The number of words to find
+         *  Return Value: A vector of strings of words near the prefix
+         */
+        std::vector<std::string> predictFuzzy(std::string prefix,
+                unsigned int maxEdits, unsigned int num_completions) const;
+
+        /** Function Name: predictCompletionsBatch(
+         *                      const std::vector<std::string> & prefixes,
+         *                      unsigned int num_completions) const
+         *  Description: predictCompletions for every prefix of a batch. The
+         *               prefixes are spread over the query threads set by
+         *               setQueryThreads, or answered by the calling thread if
+         *               there are none.
+         *  Parameters: prefixes - The prefixes to complete
+         *              num_completions - The number of words to find with
+         *                                every prefix
+         *  Return Value: The completions of prefixes[i] at index i
+         */
+        std::vector<std::vector<std::string>> predictCompletionsBatch(
+                const std::vector<std::string> & prefixes,
+                unsigned int num_completions) const;
+
+        /** Function Name: setQueryThreads(unsigned int num_threads)
+         *  Description: Sets the number of threads answering a batch, the
+         *               calling thread included. 1 answers batches on the
+         *               calling thread only.
+         *  Parameters: num_threads - The number of threads per batch
+         */
+        void setQueryThreads(unsigned int num_threads);
+
+        /** Function Name: setCompletionEngine(CompletionEngine engine)
+         *  Description: Selects the traversal used by predictCompletions.
+         *               Both engines return identical completions.
+         *  Parameters: engine - The traversal to use from now on
+         */
+        void setCompletionEngine(CompletionEngine engine);
+
+        /** Function Name: buildCompletionCache(unsigned int k)
+         *  Description: Builds the top-k completion index. Every node keeps
+         *               the k most frequent completions of the prefix ending
+         *               at it, so predictCompletions with num_completions <= k
+         *               becomes a prefix walk plus a copy. Larger requests
+         *               still traverse the subtree. Any insert, increment or
+         *               upsert afterwards leaves the index unused until it is
+         *               built again, since it would be stale.
+         *  Parameters: k - The number of completions cached at every node
+         */
+        void buildCompletionCache(unsigned int k = DEFAULT_CACHE_K);
+
+        /** Function Name: dropCompletionCache()
+         *  Description: Releases the top-k completion index, if any
+         */
+        void dropCompletionCache();
+
+        /** Function Name: cacheMemoryUsage() const
+         *  Description: Memory held by the top-k completion index
+         *  Return Value: The number of bytes used by the index, 0 if none
+         */
+        size_t cacheMemoryUsage() const;
+
+        /** Function Name: averageWordDepth() const
+         *  Description: Average number of nodes visited (left, right and down
+         *               steps) to reach the node of a word, i.e. the average
+         *               cost of find or findNode on a stored word
+         *  Return Value: The average depth of word nodes, 0 if empty
+         */
+        double averageWordDepth() const;
+
+        /** Function Name: nodeCount() const
+         *  Description: Number of TrieNodes making up the TST
+         *  Return Value: The number of nodes allocated from the node pool
+         *                and not released back to it
+         */
+        unsigned int nodeCount() const;
+
+        /** Function Name: memoryUsage() const
+         *  Description: Memory held by the node pool of the TST
+         *  Return Value: The number of bytes reserved for TrieNodes
+         */
+        size_t memoryUsage() const;
 
         /* Destructor
-         * Description: Deletes the tree nodes
+         * Description: Releases the node pool holding the tree nodes
          */
         ~DictionaryTrie();
 
     private:
 
-        TrieNode * root; /** Root of TernaryTrie */
-        unsigned int isize; /** Size of Ternary Trie */
-        unsigned int iheight; /** Height of Ternary Trie */
+        /** Images are written straight from the node pool */
+        friend class FrozenDictionaryTrie;
 
-        /** Function Name: insert(std::string word, unsigned int freq,
-         *                      TrieNode * & root, unsigned int height)
-         *  Description: Private instance helper to insert. Insert a word with
-         *               its frequency into the dictionary.
-         *  Parameters: word - The word to insert into the dictionary
-         *              freq - The frequency of the word to insert into the
-         *                     dictionary
-         *              root - A pointer reference to the root of the TST
-         *              height - height of the TST, used to determine new
-         *                       height and as the index of the word
-         *  Return Value: Return true if the word was inserted, and false if it
-         *                was not (i.e. it was already in the dictionary or it
-         *                was invalid (empty string). This might be useful for
-         *                testing when you want to test a certain case, but
-         *                don't want to write out a specific word 300 times.
+        TrieNodePool nodes; /** Arena owning every node of the TST */
+        std::atomic<unsigned int> root; /** Pool index of the root of TST */
+        std::atomic<unsigned int> isize; /** Size of Ternary Trie */
+        std::atomic<unsigned int> iheight; /** Height of Ternary Trie */
+        CompletionEngine engine; /** Traversal used by predictCompletions */
+        unsigned int cacheK; /** Completions cached per node, 0 if no cache */
+        std::atomic<bool> cacheStale; /** Set by writers, the cache is then
+                                       *  ignored until it is rebuilt */
+        std::vector<std::string> cacheWords; /** Words by completion rank */
+        std::vector<unsigned int> cacheStart; /** Node's offset in cacheIds */
+        std::vector<unsigned int> cacheIds; /** Ranks cached at every node */
+        std::unique_ptr<ThreadPool> queryPool; /** Batch workers, if any */
+
+        /** Function Name: findOrCreateNode(std::string_view word)
+         *  Description: Walks word down the TST, linking a new node with a
+         *               CAS wherever a child is missing. A node is complete
+         *               before it is linked, and a thread losing the CAS
+         *               walks on from the node that won. A node built for
+         *               a lost CAS and not needed further down is released
+         *               to the pool.
+         *  Parameters: word - The non-empty word to find or create
+         *  Return Value: The pool index of the node ending word
+         */
+        unsigned int findOrCreateNode(std::string_view word);
+
+        /** Function Name: raiseBounds(std::string_view word, int freq)
+         *  Description: Raises maxFreq to at least freq and widens the
+         *               word length bounds to cover word on every node above
+         *               and at the node ending word, which must exist. Done
+         *               before freq is published, so readers never see a
+         *               subtree bound that excludes a word.
+         *  Parameters: word - The word whose path is raised
+         *              freq - The frequency the word is about to get
          */
-        bool insert(std::string word, unsigned int freq, TrieNode * & root,
-                unsigned int height);
+        void raiseBounds(std::string_view word, int freq);
 
-        /** Function Name: find(std::string word, TrieNode * root,
+        /** Function Name: countWord(unsigned int height)
+         *  Description: Updates size and height for a newly added word
+         *  Parameters: height - Index of the word's last char
+         */
+        void countWord(unsigned int height);
+
+        /** Function Name: buildSiblings(TrieNodePool & pool,
+         *                      const std::vector<std::pair<std::string_view,
+         *                      unsigned int>> & entries, unsigned int * link,
+         *                      unsigned int from, unsigned int to,
+         *                      unsigned int & words, unsigned int & height)
+         *  Description: Builds the balanced TST of the sorted, non-empty
+         *               entries in [from, to) out of pool and stores its
+         *               root in link. maxFreq and the length bounds are
+         *               left for sweepBounds.
+         *  Parameters: pool - The pool the nodes are allocated from
+         *              entries - The entries, sorted by lessSigned
+         *              link - Where the root of the new TST is stored
+         *              from - Index of the first entry to build
+         *              to - Index past the last entry to build
+         *              words - Incremented for every word stored
+         *              height - Raised to the height of the new TST
+         */
+        static void buildSiblings(TrieNodePool & pool,
+                const std::vector<std::pair<std::string_view, unsigned int>>
+                & entries, std::atomic<unsigned int> * link,
+                unsigned int from, unsigned int to, unsigned int & words,
+                unsigned int & height);
+
+        /** Function Name: sweepBounds(TrieNodePool & pool)
+         *  Description: Sets maxFreq and the word length bounds of every
+         *               node of pool, which must have been filled by
+         *               buildSiblings
+         *  Parameters: pool - The pool to sweep
+         */
+        static void sweepBounds(TrieNodePool & pool);
+
+        /** Function Name: buildSharded(std::vector<std::pair<
+         *                      std::string_view, unsigned int>> & entries,
+         *                      unsigned int num_threads)
+         *  Description: Parallel build of an empty dictionary, see build
+         *  Parameters: entries - The unsorted (word, freq) pairs to insert
+         *              num_threads - The number of threads building shards
+         */
+        void buildSharded(
+                std::vector<std::pair<std::string_view, unsigned int>> &
+                entries, unsigned int num_threads);
+
+        /** Function Name: findNode(const std::string & prefix,
+         *                      unsigned int currNode,
          *                      unsigned int height) const
-         *  Description: Helper to the public find(std::string word) function.
-         *               Finds if a word is in the dictionary. True if word is
-         *               in the dictionary, false otherwise.
-         *  Parameters: word - The word to find in the Trie
-         *              root - The root of the Trie
-         *              height - The height of the Trie
-         *  Return Value: True if word is in the dictionary, false otherwise
-         */
-        bool find(std::string word, TrieNode *root, unsigned int height) const;
-
-        /** Function Name: findNode(std::string prefix, TrieNode * currNode,
-         *                      unsigned int height)
          *  Description: Used to find the node corresponding to the ending char
          *               in prefix in TST
          *  Parameters: prefix - The string used to search the dictionary with
-         *              currNode - Presumed to be the root pointer
+         *              currNode - Presumed to be the pool index of the root
          *              height - Height of tree, also used as index of prefix
-         *  Return Value: A pointer to the node corresponding to the ending
-         *                char in prefix
+         *  Return Value: The pool index of the node corresponding to the
+         *                ending char in prefix, NULL_NODE if there is none
          */
-        TrieNode* findNode(std::string prefix, TrieNode * currNode,
-                unsigned int height);
+        unsigned int findNode(const std::string & prefix,
+                unsigned int currNode, unsigned int height) const;
 
-        /** Function Name: findCompletions(std::string prefix,
+        /** Function Name: findCompletions(std::string & path,
          *                      unsigned int num_completions,
-         *                      TrieNode * currNode,
-         *                      std::vector<Word> * wordNodes)
-         *  Description: Used to find all the words starting form the currNode
+         *                      unsigned int currNode,
+         *                      std::priority_queue<Word,vector<Word>,Word> &
+         *                      wordNodes) const
+         *  Description: Used to find all the words starting form the currNode.
+         *               The subtree is walked with an explicit stack, and the
+         *               word of a node is only copied out of path when it
+         *               enters the top num_completions held in wordNodes.
+         *  Parameters: path - The prefix of any searched word, grown and
+         *                     shrunk in place and restored on return
+         *              num_completions - The number of words to find
+         *              currNode - A node index used to traverse the trie
+         *              wordNodes - The most frequent words found so far
+         */
+        void findCompletions(std::string & path, unsigned int num_completions,
+                unsigned int currNode,
+                std::priority_queue<Word,vector<Word>,Word> & wordNodes) const;
+
+        /** Function Name: findBestCompletions(const std::string & prefix,
+         *                      unsigned int num_completions,
+         *                      unsigned int currNode) const
+         *  Description: Best-first search below the prefix node. Subtrees are
+         *               expanded in order of their maxFreq bound, so words
+         *               come out from most to least frequent and the search
+         *               stops once num_completions words are found.
          *  Parameters: prefix - The prefix of any searched word
          *              num_completions - The number of words to find
-         *              currNode - A node pointer used to traverse the trie
-         *              wordNodes - A vector of Words with prefix in its word
+         *              currNode - The node ending the prefix, NULL_NODE for
+         *                         the empty prefix above the root
+         *  Return Value: The completions from most to least frequent
          */
-        void findCompletions(std::string prefix, unsigned int num_completions,
-                TrieNode * currNode,
-                std::priority_queue<Word,vector<Word>,Word> & wordNodes);
+        std::vector<std::string> findBestCompletions(const std::string & prefix,
+                unsigned int num_completions, unsigned int currNode) const;
 
-        /* Function Name: findUnderscore(std::string pattern,
-         *                      std::string prefix, std::string postUnderscore,
-         *                      TrieNode * currNode, 
+        /** Function Name: expandBest(const std::string & prefix,
+         *                      unsigned int num_completions,
+         *                      std::priority_queue<Candidate,
+         *                      vector<Candidate>,Candidate> & frontier,
+         *                      std::vector<std::pair<unsigned int, char>> &
+         *                      trails,
+         *                      std::vector<std::string> & predictions) const
+         *  Description: Pops the frontier of a best-first search, emitting
+         *               words and splitting subtrees, until predictions holds
+         *               num_completions words or nothing is left
+         *  Parameters: prefix - Spelled before the trail of every subtree
+         *              num_completions - The size predictions grows to at
+         *                                most
+         *              frontier - Words and subtrees still to visit
+         *              trails - Prefixes of the subtrees as (parent trail,
+         *                       char) links back to entry 0, which spells
+         *                       prefix
+         *              predictions - Words emitted, from most to least
+         *                            frequent
+         */
+        void expandBest(const std::string & prefix,
+                unsigned int num_completions,
+                std::priority_queue<Candidate,vector<Candidate>,Candidate> &
+                frontier, std::vector<std::pair<unsigned int, char>> & trails,
+                std::vector<std::string> & predictions) const;
+
+        /* Function Name: findPattern(const std::string & pattern,
+         *                      std::string & path,
+         *                      const std::string & postUnderscore,
+         *                      unsigned int currNode,
          *                      unsigned int num_completions,
          *                      std::priority_queue<Word,vector<Word>,Word> &
-         *                      wordNodes);
+         *                      wordNodes) const
          * Description: Pushes up to num_completions of the most frequent
          *              completions of the pattern, such that the completions
-         *              are words in the dictionary to the parameter wordNodes
+         *              are words in the dictionary to the parameter
+         *              wordNodes, which never grows past num_completions
          * Parameters: pattern - The pattern to find in the TST
-         *             prefix - The prefix to look for in the TST
+         *             path - The prefix to look for in the TST, grown and
+         *                    shrunk in place and restored on return
          *             postUnderscore - The string after the underscore char
-         *             currNode - A pointer used to traverse the tree
+         *             currNode - A node index used to traverse the tree
          *             num_completions - The number of words to find via the
          *                               pattern
          *             wordNodes - Vector holding the predictions from pattern
          * Return Value: None
          */
-        void findPattern(std::string pattern, std::string prefix,
-                std::string postUnderscore, TrieNode * currNode,
+        void findPattern(const std::string & pattern, std::string & path,
+                const std::string & postUnderscore, unsigned int currNode,
                 unsigned int num_completions,
-                std::priority_queue<Word,vector<Word>,Word> & wordNodes);
-
-        /** Function Name: deleteTrie(TrieNode * currNode)
-         *  Description: Helper to delete the tree from the root node
-         */
-        void deleteTrie(TrieNode * currNode);
+                std::priority_queue<Word,vector<Word>,Word> & wordNodes) const;
 };
 
 #endif // DICTIONARY_TRIE_H
@@ -0,0 +1,632 @@
+/** Filename: FrozenDictionaryTrie.cpp
+ *  Name: Loc Chuong
+ *  Userid: cs100sp19aj
+ *  Description: Read-only dictionary backed by a flat binary image of a
+ *               DictionaryTrie. The image is mapped into memory and queried
+ *               in place, so opening it does no parsing or allocation and
+ *               processes on one host share its pages.
+ *  Date: 5/2/2019
+ */
+
+#include "FrozenDictionaryTrie.hpp"
+#include "PatternMatcher.hpp"
+#include <algorithm>
+#include <cstring>
+#include <fstream>
+#include <queue>
+#include <unordered_map>
+#ifdef _WIN32
+#include <cstdlib>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+/** Constructor
+ *  Description: Create an empty dictionary with no image open
+ */
+FrozenDictionaryTrie::FrozenDictionaryTrie() : header(nullptr),
+    view{nullptr, nullptr, nullptr}, image(nullptr), imageSize(0) {
+}
+
+/** Function Name: compile(const DictionaryTrie & dict,
+ *                      const std::string & filename, NodeOrder order)
+ *  Description: Writes dict as an image that open can map. Chains of
+ *               TrieNodes with no branching are folded into one node with a
+ *               fragment, and equal fragments too long to keep in the node
+ *               share their chars in the pool.
+ *  Parameters: dict - The dictionary to freeze
+ *              filename - Path of the image to write
+ *              order - Order of the nodes in the image
+ *  Return Value: True if the image was written, false otherwise
+ */
+bool FrozenDictionaryTrie::compile(const DictionaryTrie & dict,
+        const std::string & filename, NodeOrder order) {
+    ofstream out(filename, ios::out | ios::binary | ios::trunc);
+    if( !out) {
+        return false;
+    }
+    unsigned int poolSize = dict.nodes.size() + 1;
+    /** Only nodes reachable from the root are written. The pool also holds
+     *  released nodes, whose down is a free list link and not a child */
+    std::vector<bool> live(poolSize, false);
+    std::vector<unsigned int> stack;
+    if( dict.root != NULL_NODE) {
+        stack.push_back(dict.root);
+    }
+    while( !stack.empty()) {
+        unsigned int currNode = stack.back();
+        stack.pop_back();
+        live[currNode] = true;
+        const TrieNode & node = dict.nodes[currNode];
+        unsigned int children[3] = {node.left, node.right, node.down};
+        for( unsigned int child : children) {
+            if( child != NULL_NODE) {
+                stack.push_back(child);
+            }
+        }
+    }
+    /** A node is folded into the fragment of the node above it when that
+     *  one is not a word and the node has no siblings */
+    std::vector<bool> folded(poolSize, false);
+    for( unsigned int i = 1; i < poolSize; i++) {
+        if( !live[i]) {
+            continue;
+        }
+        const TrieNode & node = dict.nodes[i];
+        unsigned int below = node.down;
+        if( below != NULL_NODE && node.freq == NO_WORD &&
+                dict.nodes[below].left == NULL_NODE &&
+                dict.nodes[below].right == NULL_NODE) {
+            folded[below] = true;
+        }
+    }
+    /** Fragments are cut every MAX_FRAGMENT chars, the node after a cut
+     *  starts a fragment of its own */
+    for( unsigned int i = 1; i < poolSize; i++) {
+        if( !live[i] || folded[i]) {
+            continue;
+        }
+        unsigned int length = 0;
+        unsigned int currNode = i;
+        while( dict.nodes[currNode].freq == NO_WORD &&
+                dict.nodes[currNode].down != NULL_NODE &&
+                folded[dict.nodes[currNode].down]) {
+            currNode = dict.nodes[currNode].down;
+            if( length == MAX_FRAGMENT) {
+                folded[currNode] = false;
+                length = 0;
+            }
+            else {
+                length++;
+            }
+        }
+    }
+    std::vector<unsigned int> placed = layout(dict, live, folded, order);
+    /** Image index of every node that starts a fragment */
+    std::vector<unsigned int> index(poolSize, NULL_NODE);
+    for( unsigned int i = 0; i < placed.size(); i++) {
+        index[placed[i]] = i + 1;
+    }
+    /** Slot NULL_NODE is kept, zeroed */
+    std::vector<FrozenNode> hot(placed.size() + 1);
+    std::vector<FrozenCold> cold(placed.size() + 1);
+    std::string pool;
+    std::unordered_map<std::string, unsigned int> pooled;
+    std::string tail;
+    for( unsigned int i = 1; i < hot.size(); i++) {
+        const TrieNode & node = dict.nodes[placed[i-1]];
+        /** Gather the chain, its last node has the word and down */
+        unsigned int last = placed[i-1];
+        tail.clear();
+        while( dict.nodes[last].down != NULL_NODE &&
+                folded[dict.nodes[last].down]) {
+            last = dict.nodes[last].down;
+            tail.push_back(dict.nodes[last].data);
+        }
+        hot[i].left = index[node.left];
+        hot[i].right = index[node.right];
+        hot[i].down = index[dict.nodes[last].down];
+        hot[i].data = node.data;
+        hot[i].tailLength = tail.size();
+        cold[i].freq = dict.nodes[last].freq;
+        cold[i].maxFreq = node.maxFreq;
+        cold[i].minLength = node.minLength;
+        cold[i].maxLength = node.maxLength;
+        if( tail.size() <= INLINE_FRAGMENT) {
+            memcpy(hot[i].inlineTail, tail.data(), tail.size());
+        }
+        else {
+            auto found = pooled.emplace(tail, pool.size());
+            if( found.second) {
+                pool.append(tail);
+            }
+            cold[i].tail = found.first->second;
+        }
+    }
+    FrozenHeader head;
+    memset(&head, 0, sizeof(head));
+    memcpy(head.magic, FROZEN_MAGIC, sizeof(head.magic));
+    head.version = FROZEN_VERSION;
+    head.nodeCount = hot.size();
+    head.root = index[dict.root];
+    head.wordCount = dict.isize;
+    head.height = dict.iheight;
+    head.tailBytes = pool.size();
+    out.write((const char *) &head, sizeof(head));
+    out.write((const char *) hot.data(), hot.size() * sizeof(FrozenNode));
+    out.write((const char *) cold.data(), cold.size() * sizeof(FrozenCold));
+    out.write(pool.data(), pool.size());
+    out.close();
+    return !out.fail();
+}
+
+/** Function Name: layout(const DictionaryTrie & dict,
+ *                      const std::vector<bool> & live,
+ *                      const std::vector<bool> & folded, NodeOrder order)
+ *  Description: Lists the pool indices of the nodes of the image. In
+ *               CACHE_ORDER each sibling BST is placed breadth-first, then
+ *               the BSTs below it are queued depth-first with the one of
+ *               highest maxFreq on top, so it is placed right after.
+ *  Parameters: dict - The dictionary being frozen
+ *              live - Whether a pool node is reachable from the root
+ *              folded - Whether a pool node is part of a fragment
+ *              order - Order of the nodes in the image
+ *  Return Value: The pool index of every image node after the reserved
+ *                one, in image order
+ */
+std::vector<unsigned int> FrozenDictionaryTrie::layout(
+        const DictionaryTrie & dict, const std::vector<bool> & live,
+        const std::vector<bool> & folded, NodeOrder order) {
+    std::vector<unsigned int> placed;
+    if( order == POOL_ORDER) {
+        for( unsigned int i = 1; i < folded.size(); i++) {
+            if( live[i] && !folded[i]) {
+                placed.push_back(i);
+            }
+        }
+        return placed;
+    }
+    /** Roots of the sibling BSTs still to place, the next one last */
+    std::vector<unsigned int> pending;
+    if( dict.root != NULL_NODE) {
+        pending.push_back(dict.root);
+    }
+    std::vector<unsigned int> below;
+    while( !pending.empty()) {
+        unsigned int first = placed.size();
+        placed.push_back(pending.back());
+        pending.pop_back();
+        for( unsigned int i = first; i < placed.size(); i++) {
+            const TrieNode & node = dict.nodes[placed[i]];
+            if( node.left != NULL_NODE) {
+                placed.push_back(node.left);
+            }
+            if( node.right != NULL_NODE) {
+                placed.push_back(node.right);
+            }
+        }
+        /** The BSTs hanging below the fragments of this one */
+        below.clear();
+        for( unsigned int i = first; i < placed.size(); i++) {
+            unsigned int last = placed[i];
+            while( dict.nodes[last].down != NULL_NODE &&
+                    folded[dict.nodes[last].down]) {
+                last = dict.nodes[last].down;
+            }
+            if( dict.nodes[last].down != NULL_NODE) {
+                below.push_back(dict.nodes[last].down);
+            }
+        }
+        std::sort(below.begin(), below.end(),
+                [&dict](unsigned int a, unsigned int b) {
+                int freqA = dict.nodes[a].maxFreq;
+                int freqB = dict.nodes[b].maxFreq;
+                return freqA < freqB || (freqA == freqB && a > b);
+        });
+        pending.insert(pending.end(), below.begin(), below.end());
+    }
+    return placed;
+}
+
+/** Function Name: isImage(const std::string & filename)
+ *  Description: Checks whether a file starts like an image
+ *  Parameters: filename - Path of the file to check
+ *  Return Value: True if the file holds an image, false otherwise
+ */
+bool FrozenDictionaryTrie::isImage(const std::string & filename) {
+    ifstream in(filename, ios::in | ios::binary);
+    char magic[sizeof(((FrozenHeader *) nullptr)->magic)];
+    if( !in.read(magic, sizeof(magic))) {
+        return false;
+    }
+    return memcmp(magic, FROZEN_MAGIC, sizeof(magic)) == 0;
+}
+
+/** Function Name: open(const std::string & filename)
+ *  Description: Maps an image read-only, closing any previous one. The
+ *               header and every node are checked once, a truncated or
+ *               corrupt image is not opened.
+ *  Parameters: filename - Path of the image written by compile
+ *  Return Value: True if the image was mapped and is valid, false otherwise
+ *                (the dictionary is then empty)
+ */
+bool FrozenDictionaryTrie::open(const std::string & filename) {
+    close();
+#ifdef _WIN32
+    /** No mmap, read the image into one block instead */
+    ifstream in(filename, ios::in | ios::binary | ios::ate);
+    if( !in) {
+        return false;
+    }
+    imageSize = in.tellg();
+    image = malloc(imageSize ? imageSize : 1);
+    in.seekg(0, ios::beg);
+    if( image == nullptr || !in.read((char *) image, imageSize)) {
+        close();
+        return false;
+    }
+#else
+    int fd = ::open(filename.c_str(), O_RDONLY);
+    if( fd < 0) {
+        return false;
+    }
+    struct stat info;
+    if( fstat(fd, &info) != 0 || info.st_size == 0) {
+        ::close(fd);
+        return false;
+    }
+    imageSize = info.st_size;
+    /** Shared read-only mapping, the page cache backs every process */
+    image = mmap(nullptr, imageSize, PROT_READ, MAP_SHARED, fd, 0);
+    ::close(fd);
+    if( image == MAP_FAILED) {
+        image = nullptr;
+        imageSize = 0;
+        return false;
+    }
+#endif
+    /** Validate the header before trusting any index in the image */
+    const FrozenHeader * head = (const FrozenHeader *) image;
+    if( imageSize < sizeof(FrozenHeader) ||
+            memcmp(head->magic, FROZEN_MAGIC, sizeof(head->magic)) != 0 ||
+            head->version != FROZEN_VERSION || head->nodeCount == 0 ||
+            (imageSize - sizeof(FrozenHeader)) / (sizeof(FrozenNode) +
+                sizeof(FrozenCold)) < head->nodeCount ||
+            imageSize - sizeof(FrozenHeader) - head->nodeCount *
+            (sizeof(FrozenNode) + sizeof(FrozenCold)) != head->tailBytes ||
+            head->root >= head->nodeCount) {
+        close();
+        return false;
+    }
+    header = head;
+    view.nodes = (const FrozenNode *) ((const char *) image +
+            sizeof(FrozenHeader));
+    view.colds = (const FrozenCold *) (view.nodes + head->nodeCount);
+    view.tails = (const char *) (view.colds + head->nodeCount);
+    /** Queries index the image without checks, so check every node now */
+    if( !nodesInBounds()) {
+        close();
+        return false;
+    }
+    return true;
+}
+
+/** Function Name: nodesInBounds() const
+ *  Description: Checks that every child index of the mapped image is a node
+ *               of it and every pooled fragment lies in the fragment pool,
+ *               so no walk reads past the image
+ *  Return Value: True if the image is safe to query, false otherwise
+ */
+bool FrozenDictionaryTrie::nodesInBounds() const {
+    uint32_t count = header->nodeCount;
+    for( uint32_t i = 0; i < count; i++) {
+        const FrozenNode & node = view.nodes[i];
+        if( node.left >= count || node.right >= count ||
+                node.down >= count) {
+            return false;
+        }
+        if( node.tailLength > INLINE_FRAGMENT &&
+                (size_t) view.colds[i].tail + node.tailLength >
+                header->tailBytes) {
+            return false;
+        }
+    }
+    return true;
+}
+
+/** Function Name: close()
+ *  Description: Unmaps the image, leaving the dictionary empty
+ */
+void FrozenDictionaryTrie::close() {
+    if( image != nullptr) {
+#ifdef _WIN32
+        free(image);
+#else
+        munmap(image, imageSize);
+#endif
+    }
+    header = nullptr;
+    view = {nullptr, nullptr, nullptr};
+    image = nullptr;
+    imageSize = 0;
+}
+
+/** Function Name: findNode(const std::string & prefix,
+ *                      unsigned int & matched) const
+ *  Description: Used to find the node corresponding to the ending char in
+ *               prefix, which may lie inside its fragment
+ *  Parameters: prefix - The non-empty string to search for
+ *              matched - Set to the number of fragment chars prefix covers
+ *  Return Value: The index of the node corresponding to the ending char in
+ *                prefix, NULL_NODE if there is none
+ */
+unsigned int FrozenDictionaryTrie::findNode(const std::string & prefix,
+        unsigned int & matched) const {
+    matched = 0;
+    if( header == nullptr || prefix.empty()) {
+        return NULL_NODE;
+    }
+    unsigned int currNode = header->root;
+    unsigned int height = 0;
+    while( currNode != NULL_NODE) {
+        const FrozenNode & node = view.nodes[currNode];
+        if( prefix[height] > node.data) {
+            currNode = node.right;
+        }
+        else if( prefix[height] < node.data) {
+            currNode = node.left;
+        }
+        else {
+            height++;
+            /** A fragment has no siblings, its chars must all match */
+            const char * tail = view.fragment(currNode).data();
+            while( matched < node.tailLength && height < prefix.size()) {
+                if( tail[matched] != prefix[height]) {
+                    return NULL_NODE;
+                }
+                matched++;
+                height++;
+            }
+            if( height == prefix.size()) {
+                return currNode;
+            }
+            matched = 0;
+            currNode = node.down;
+        }
+    }
+    return NULL_NODE;
+}
+
+/** Function Name: find(std::string word) const
+ *  Description: Finds if a word is in the dictionary
+ *  Parameters: word - The word to find in the dictionary
+ *  Return Value: Return true if word is in the dictionary, and false
+ *                otherwise
+ */
+bool FrozenDictionaryTrie::find(std::string word) const {
+    unsigned int matched;
+    unsigned int currNode = findNode(word, matched);
+    /** A word ending inside a fragment is only a prefix */
+    return currNode != NULL_NODE &&
+        matched == view.nodes[currNode].tailLength &&
+        view.colds[currNode].freq != NO_WORD;
+}
+
+/** Function Name: predictCompletions(std::string prefix,
+ *                      unsigned int num_completions) const
+ *  Description: Same as DictionaryTrie::predictCompletions. The image keeps
+ *               every subtree's maxFreq, so the search is best-first and
+ *               stops after num_completions words.
+ *  Parameters: prefix - The prefix of any word to be searched
+ *              num_completions - The number of words to find with the prefix
+ *  Return Value: A vector of strings of words that have the prefix
+ */
+std::vector<std::string> FrozenDictionaryTrie::predictCompletions(
+        std::string prefix, unsigned int num_completions) const {
+    if( header == nullptr || header->root == NULL_NODE ||
+            num_completions == 0) {
+        return {};
+    }
+    std::priority_queue<Candidate, vector<Candidate>, Candidate> frontier;
+    /** Prefixes of subtrees as (parent trail, char) links back to entry 0,
+     *  which is the prefix itself. Only words are ever spelled out. */
+    std::vector<std::pair<unsigned int, char>> trails;
+    trails.push_back(std::make_pair(0U, '\0'));
+    unsigned int below = header->root;
+    /** The empty prefix completes from the root */
+    if( !prefix.empty()) {
+        unsigned int matched;
+        unsigned int currNode = findNode(prefix, matched);
+        if( currNode == NULL_NODE) {
+            return {};
+        }
+        /** A prefix ending inside a fragment can only go on with the rest
+         *  of it */
+        prefix.append(view.fragment(currNode).substr(matched));
+        /** The prefix itself competes with its completions */
+        if( view.colds[currNode].freq != NO_WORD) {
+            frontier.push(Candidate(view.colds[currNode].freq, prefix));
+        }
+        below = view.nodes[currNode].down;
+    }
+    if( below != NULL_NODE) {
+        frontier.push(Candidate(view.colds[below].maxFreq, below, 0));
+    }
+    std::vector<std::string> predictions;
+    string word;
+    while( !frontier.empty() && predictions.size() < num_completions) {
+        Candidate top = frontier.top();
+        frontier.pop();
+        /** No remaining subtree can hold a better word, emit it */
+        if( !top.subtree) {
+            predictions.push_back(top.s);
+            continue;
+        }
+        /** Split the subtree into its word, siblings and children */
+        const FrozenNode & node = view.nodes[top.node];
+        int freq = view.colds[top.node].freq;
+        std::string_view tail = view.fragment(top.node);
+        if( freq != NO_WORD) {
+            /** Spell the word backwards from its fragment and trail, then
+             *  the prefix */
+            word.assign(tail.rbegin(), tail.rend());
+            word.push_back(node.data);
+            for( unsigned int t = top.trail; t != 0; t = trails[t].first) {
+                word.push_back(trails[t].second);
+            }
+            word.append(prefix.rbegin(), prefix.rend());
+            std::reverse(word.begin(), word.end());
+            frontier.push(Candidate(freq, word));
+        }
+        if( node.left != NULL_NODE) {
+            frontier.push(Candidate(view.colds[node.left].maxFreq, node.left,
+                        top.trail));
+        }
+        if( node.right != NULL_NODE) {
+            frontier.push(Candidate(view.colds[node.right].maxFreq, node.right,
+                        top.trail));
+        }
+        if( node.down != NULL_NODE) {
+            trails.push_back(std::make_pair(top.trail, node.data));
+            for( unsigned int i = 0; i < tail.size(); i++) {
+                trails.push_back(std::make_pair(trails.size() - 1, tail[i]));
+            }
+            frontier.push(Candidate(view.colds[node.down].maxFreq, node.down,
+                        trails.size() - 1));
+        }
+    }
+    return predictions;
+}
+
+/** Function Name: predictUnderscore(std::string pattern,
+ *                      unsigned int num_completions) const
+ *  Description: Same as DictionaryTrie::predictUnderscore
+ *  Parameters: pattern - The pattern to find in the TST
+ *              num_completions - The number of words to find via the pattern
+ *  Return Value: A vector of strings with words that are apart of the
+ *                pattern
+ */
+std::vector<std::string> FrozenDictionaryTrie::predictUnderscore(
+        std::string pattern, unsigned int num_completions) const {
+    size_t underScoreIdx = pattern.find(UNDERSCORE);
+    if( header == nullptr || num_completions == 0 ||
+            underScoreIdx == string::npos) {
+        return {};
+    }
+    /** Chars before the underscore act as a prefix */
+    string path = pattern.substr(0, underScoreIdx);
+    string postUnderscore = pattern.substr(underScoreIdx + 1);
+    /** Most frequent matches so far, top is the least of them */
+    std::priority_queue<Word, vector<Word>, Word> wordNodes;
+    unsigned int currNode = header->root;
+    if( !path.empty()) {
+        unsigned int matched;
+        currNode = findNode(path, matched);
+        if( currNode == NULL_NODE) {
+            return {};
+        }
+        /** The underscore may fall inside the fragment the prefix ends in,
+         *  whose word is then a candidate too */
+        const FrozenCold & cold = view.colds[currNode];
+        path.append(view.fragment(currNode).substr(matched));
+        if( cold.freq != NO_WORD && path.size() == pattern.size() &&
+                path.compare(path.size() - postUnderscore.size(),
+                    string::npos, postUnderscore) == 0) {
+            wordNodes.push(Word(path, cold.freq));
+        }
+        currNode = path.size() < pattern.size() ?
+            view.nodes[currNode].down : NULL_NODE;
+    }
+    /** Stack of (node, length of the path leading to the node) */
+    std::vector<std::pair<unsigned int, unsigned int>> stack;
+    if( currNode != NULL_NODE) {
+        stack.push_back(std::make_pair(currNode, (unsigned int) path.size()));
+    }
+    while( !stack.empty()) {
+        currNode = stack.back().first;
+        unsigned int depth = stack.back().second;
+        stack.pop_back();
+        const FrozenNode & node = view.nodes[currNode];
+        const FrozenCold & cold = view.colds[currNode];
+        if( !PatternMatcher::reaches(cold, pattern.size() - depth,
+                    pattern.size() - depth)) {
+            continue;
+        }
+        path.resize(depth);
+        path.push_back(node.data);
+        path.append(view.fragment(currNode));
+        if( cold.freq != NO_WORD && path.size() == pattern.size() &&
+                path.compare(path.size() - postUnderscore.size(),
+                    string::npos, postUnderscore) == 0) {
+            if( wordNodes.size() < num_completions) {
+                wordNodes.push(Word(path, cold.freq));
+            }
+            else if( wordNodes.top().freq < cold.freq ||
+                    (wordNodes.top().freq == cold.freq &&
+                     wordNodes.top().s > path)) {
+                wordNodes.pop();
+                wordNodes.push(Word(path, cold.freq));
+            }
+        }
+        if( node.left != NULL_NODE) {
+            stack.push_back(std::make_pair(node.left, depth));
+        }
+        if( node.right != NULL_NODE) {
+            stack.push_back(std::make_pair(node.right, depth));
+        }
+        /** Words below this node are longer than the pattern */
+        if( node.down != NULL_NODE && path.size() < pattern.size()) {
+            stack.push_back(std::make_pair(node.down,
+                        (unsigned int) path.size()));
+        }
+    }
+    std::vector<std::string> predictions(wordNodes.size());
+    for( int i = predictions.size() - 1; i >= 0; i--) {
+        predictions[i] = wordNodes.top().s;
+        wordNodes.pop();
+    }
+    return predictions;
+}
+
+/** Function Name: predictPattern(std::string pattern,
+ *                      unsigned int num_completions) const
+ *  Description: Same as DictionaryTrie::predictPattern
+ *  Parameters: pattern - The pattern to match in the TST
+ *              num_completions - The number of words to find via the pattern
+ *  Return Value: A vector of strings of the words matching pattern
+ */
+std::vector<std::string> FrozenDictionaryTrie::predictPattern(
+        std::string pattern, unsigned int num_completions) const {
+    if( header == nullptr) {
+        return {};
+    }
+    return PatternMatcher(pattern).match(view, header->root,
+            num_completions);
+}
+
+/** Function Name: nodeCount() const
+ *  Description: Number of nodes making up the path compressed TST
+ *  Return Value: The number of nodes in the image
+ */
+unsigned int FrozenDictionaryTrie::nodeCount() const {
+    /** The reserved slot is not a node of the TST */
+    return header == nullptr ? 0 : header->nodeCount - 1;
+}
+
+/** Function Name: memoryUsage() const
+ *  Description: Size of the mapped image
+ *  Return Value: The number of bytes mapped, 0 if no image is open
+ */
+size_t FrozenDictionaryTrie::memoryUsage() const {
+    return imageSize;
+}
+
+/** Destructor
+ *  Description: Unmaps the image
+ */
+FrozenDictionaryTrie::~FrozenDictionaryTrie() {
+    close();
+}
@@ -0,0 +1,306 @@
+/** Filename: FrozenDictionaryTrie.hpp
+ *  Name: Loc Chuong
+ *  Userid: cs100sp19aj
+ *  Description: Read-only dictionary backed by a flat binary image of a
+ *               DictionaryTrie. The image is mapped into memory and queried
+ *               in place, so opening it does no parsing or allocation and
+ *               processes on one host share its pages.
+ *  Date: 5/2/2019
+ */
+
+#ifndef FROZEN_DICTIONARY_TRIE_HPP
+#define FROZEN_DICTIONARY_TRIE_HPP
+
+#include "DictionaryTrie.hpp"
+#include <cstdint>
+#include <string>
+#include <string_view>
+#include <vector>
+#define FROZEN_MAGIC "TSTIMG\n" /** First 8 bytes of an image, with NUL */
+#define FROZEN_VERSION 4U /** Layout version of the image */
+#define MAX_FRAGMENT 255 /** Most chars a node holds after its data */
+#define INLINE_FRAGMENT 2 /** Longest fragment kept in the hot half */
+
+using namespace std;
+
+/** Struct FrozenHeader
+ *  Description: First 32 bytes of an image. The hot halves of the nodes
+ *               follow directly, then their cold halves, then the fragment
+ *               pool.
+ */
+struct FrozenHeader {
+    char magic[8]; /** FROZEN_MAGIC */
+    uint32_t version; /** FROZEN_VERSION */
+    uint32_t nodeCount; /** Node slots in the image, reserved slot included */
+    uint32_t root; /** Index of the root node, NULL_NODE if empty */
+    uint32_t wordCount; /** Number of words in the dictionary */
+    uint32_t height; /** Height of the TST */
+    uint32_t tailBytes; /** Size of the fragment pool */
+};
+
+/** Struct FrozenNode
+ *  Description: Hot half of a node of an image, all a prefix walk reads, so
+ *               four nodes share a cache line. Children are indices into the
+ *               node arrays of the image, NULL_NODE when missing. The image
+ *               is path compressed: a chain of TrieNodes where each one but
+ *               the first is the only child of a non-word node is one node,
+ *               whose data is the first char of the chain and whose fragment
+ *               holds the rest. The word and down child are those of the
+ *               last node of the chain.
+ */
+struct alignas(16) FrozenNode {
+    uint32_t left; /** Index of left child */
+    uint32_t right; /** Index of right child */
+    uint32_t down; /** Index of child directly below the fragment */
+    char data; /** Data held by the node */
+    uint8_t tailLength; /** Chars of the fragment, 0 if none */
+    char inlineTail[INLINE_FRAGMENT]; /** A fragment of at most
+                                       *  INLINE_FRAGMENT chars */
+};
+
+/** Struct FrozenCold
+ *  Description: Cold half of a node of an image, read once a walk reaches
+ *               its word or ranks its subtree. The word flag is packed into
+ *               freq.
+ */
+struct alignas(16) FrozenCold {
+    int32_t freq; /** Frequency of the word ending at the end of the
+                   *  fragment, NO_WORD if none */
+    int32_t maxFreq; /** Highest word frequency in this node's subtree */
+    uint32_t tail; /** Offset of a longer fragment in the fragment pool */
+    uint8_t minLength; /** Fewest chars from this node's level to the end of
+                        *  a word in its subtree */
+    uint8_t maxLength; /** Most such chars, MAX_LENGTH_BOUND meaning that
+                        *  many or more */
+    char pad[2]; /** Zero */
+};
+
+/** Struct FrozenEntry
+ *  Description: Both halves of a node joined, for code shared with
+ *               DictionaryTrie that reads nodes by field
+ */
+struct FrozenEntry {
+    uint32_t left; /** Index of left child */
+    uint32_t right; /** Index of right child */
+    uint32_t down; /** Index of child directly below the fragment */
+    int32_t freq; /** Frequency of the word at the end of the fragment */
+    int32_t maxFreq; /** Highest word frequency in this node's subtree */
+    char data; /** Data held by the node */
+    uint8_t minLength; /** Fewest chars to the end of a word in the subtree */
+    uint8_t maxLength; /** Most such chars */
+    std::string_view fragment; /** Chars of the node after data */
+};
+
+/** Struct FrozenNodes
+ *  Description: Node arrays and fragment pool of an image, indexed like the
+ *               node pool of a DictionaryTrie
+ */
+struct FrozenNodes {
+    const FrozenNode * nodes; /** Hot halves of the nodes */
+    const FrozenCold * colds; /** Cold halves of the nodes */
+    const char * tails; /** Fragment pool of the image */
+
+    /** Function Name: fragment(unsigned int i) const
+     *  Description: Chars node i holds after its data
+     *  Return Value: The fragment of the node, empty if none
+     */
+    std::string_view fragment(unsigned int i) const {
+        if( nodes[i].tailLength <= INLINE_FRAGMENT) {
+            return std::string_view(nodes[i].inlineTail,
+                    nodes[i].tailLength);
+        }
+        return std::string_view(tails + colds[i].tail, nodes[i].tailLength);
+    }
+
+    /** Function Name: operator[](unsigned int i) const
+     *  Description: Joins both halves of a node of the image
+     *  Return Value: The node at index i
+     */
+    FrozenEntry operator[](unsigned int i) const {
+        return {nodes[i].left, nodes[i].right, nodes[i].down, colds[i].freq,
+            colds[i].maxFreq, nodes[i].data, colds[i].minLength,
+            colds[i].maxLength, fragment(i)};
+    }
+};
+
+/** Function Name: fragmentOf(const FrozenNodes & nodes,
+ *                      const FrozenEntry & node)
+ *  Description: Chars a node of an image holds after its data
+ *  Return Value: The fragment of node, empty if none
+ */
+inline std::string_view fragmentOf(const FrozenNodes &,
+        const FrozenEntry & node) {
+    return node.fragment;
+}
+
+/** Class Name: FrozenDictionaryTrie
+ *  Description: Immutable TST loaded from an image written by compile. It
+ *               answers the same queries as DictionaryTrie, in the same
+ *               order, without deserializing the image.
+ */
+class FrozenDictionaryTrie
+{
+    public:
+
+        /** Constructor
+         *  Description: Create an empty dictionary with no image open
+         */
+        FrozenDictionaryTrie();
+
+        /** The mapping is owned by the dictionary, it cannot be copied */
+        FrozenDictionaryTrie(const FrozenDictionaryTrie &) = delete;
+        FrozenDictionaryTrie & operator=(const FrozenDictionaryTrie &) =
+            delete;
+
+        /** Enum NodeOrder
+         *  Description: Order of the nodes in an image. POOL_ORDER keeps the
+         *               order the nodes were allocated in. CACHE_ORDER lays
+         *               out every sibling BST breadth-first, so its top levels
+         *               share cache lines, and places the sibling BSTs depth
+         *               first, each one's most frequent child BST right after
+         *               it, so a popular prefix walk stays on nearby lines.
+         */
+        enum NodeOrder { POOL_ORDER, CACHE_ORDER };
+
+        /** Function Name: compile(const DictionaryTrie & dict,
+         *                      const std::string & filename,
+         *                      NodeOrder order)
+         *  Description: Writes dict as an image that open can map
+         *  Parameters: dict - The dictionary to freeze
+         *              filename - Path of the image to write
+         *              order - Order of the nodes in the image
+         *  Return Value: True if the image was written, false otherwise
+         */
+        static bool compile(const DictionaryTrie & dict,
+                const std::string & filename, NodeOrder order = CACHE_ORDER);
+
+        /** Function Name: isImage(const std::string & filename)
+         *  Description: Checks whether a file starts like an image
+         *  Parameters: filename - Path of the file to check
+         *  Return Value: True if the file holds an image, false otherwise
+         */
+        static bool isImage(const std::string & filename);
+
+        /** Function Name: open(const std::string & filename)
+         *  Description: Maps an image read-only, closing any previous one.
+         *               The header and every node are checked once, a
+         *               truncated or corrupt image is not opened.
+         *  Parameters: filename - Path of the image written by compile
+         *  Return Value: True if the image was mapped and is valid, false
+         *                otherwise (the dictionary is then empty)
+         */
+        bool open(const std::string & filename);
+
+        /** Function Name: close()
+         *  Description: Unmaps the image, leaving the dictionary empty
+         */
+        void close();
+
+        /** Function Name: find(std::string word) const
+         *  Description: Finds if a word is in the dictionary
+         *  Parameters: word - The word to find in the dictionary
+         *  Return Value: Return true if word is in the dictionary, and false
+         *                otherwise
+         */
+        bool find(std::string word) const;
+
+        /** Function Name: predictCompletions(std::string prefix,
+         *                      unsigned int num_completions) const
+         *  Description: Same as DictionaryTrie::predictCompletions. The
+         *               image keeps every subtree's maxFreq, so the search is
+         *               best-first and stops after num_completions words.
+         *  Parameters: prefix - The prefix of any word to be searched
+         *              num_completions - The number of words to find with
+         *                                the prefix
+         *  Return Value: A vector of strings of words that have the prefix
+         */
+        std::vector<std::string> predictCompletions(std::string prefix,
+                unsigned int num_completions) const;
+
+        /** Function Name: predictUnderscore(std::string pattern,
+         *                      unsigned int num_completions) const
+         *  Description: Same as DictionaryTrie::predictUnderscore
+         *  Parameters: pattern - The pattern to find in the TST
+         *              num_completions - The number of words to find via
+         *                                the pattern
+         *  Return Value: A vector of strings with words that are apart of
+         *                the pattern
+         */
+        std::vector<std::string> predictUnderscore(std::string pattern,
+                unsigned int num_completions) const;
+
+        /** Function Name: predictPattern(std::string pattern,
+         *                      unsigned int num_completions) const
+         *  Description: Same as DictionaryTrie::predictPattern
+         *  Parameters: pattern - The pattern to match in the TST
+         *              num_completions - The number of words to find via
+         *                                the pattern
+         *  Return Value: A vector of strings of the words matching pattern
+         */
+        std::vector<std::string> predictPattern(std::string pattern,
+                unsigned int num_completions) const;
+
+        /** Function Name: nodeCount() const
+         *  Description: Number of nodes making up the path compressed TST
+         *  Return Value: The number of nodes in the image
+         */
+        unsigned int nodeCount() const;
+
+        /** Function Name: memoryUsage() const
+         *  Description: Size of the mapped image
+         *  Return Value: The number of bytes mapped, 0 if no image is open
+         */
+        size_t memoryUsage() const;
+
+        /** Destructor
+         *  Description: Unmaps the image
+         */
+        ~FrozenDictionaryTrie();
+
+    private:
+
+        const FrozenHeader * header; /** Header of the mapped image */
+        FrozenNodes view; /** Node arrays of the mapped image */
+        void * image; /** Start of the mapping, nullptr if none */
+        size_t imageSize; /** Size of the mapping in bytes */
+
+        /** Function Name: findNode(const std::string & prefix,
+         *                      unsigned int & matched) const
+         *  Description: Used to find the node corresponding to the ending
+         *               char in prefix, which may lie inside its fragment
+         *  Parameters: prefix - The non-empty string to search for
+         *              matched - Set to the number of fragment chars prefix
+         *                        covers
+         *  Return Value: The index of the node corresponding to the ending
+         *                char in prefix, NULL_NODE if there is none
+         */
+        unsigned int findNode(const std::string & prefix,
+                unsigned int & matched) const;
+
+        /** Function Name: nodesInBounds() const
+         *  Description: Checks that every child index of the mapped image
+         *               is a node of it and every pooled fragment lies in
+         *               the fragment pool, so no walk reads past the image
+         *  Return Value: True if the image is safe to query, false otherwise
+         */
+        bool nodesInBounds() const;
+
+        /** Function Name: layout(const DictionaryTrie & dict,
+         *                      const std::vector<bool> & live,
+         *                      const std::vector<bool> & folded,
+         *                      NodeOrder order)
+         *  Description: Lists the pool indices of the nodes of the image
+         *  Parameters: dict - The dictionary being frozen
+         *              live - Whether a pool node is reachable from the
+         *                     root
+         *              folded - Whether a pool node is part of a fragment
+         *              order - Order of the nodes in the image
+         *  Return Value: The pool index of every image node after the
+         *                reserved one, in image order
+         */
+        static std::vector<unsigned int> layout(const DictionaryTrie & dict,
+                const std::vector<bool> & live,
+                const std::vector<bool> & folded, NodeOrder order);
+};
+
+#endif // FROZEN_DICTIONARY_TRIE_HPP
@@ -0,0 +1,70 @@
+/** Filename: PatternMatcher.cpp
+ *  Name: Loc Chuong
+ *  Userid: cs100sp19aj
+ *  Description: Matches the words of a TST against a wildcard pattern, for
+ *               both the DictionaryTrie and the FrozenDictionaryTrie.
+ *  Date: 5/2/2019
+ */
+
+#include "PatternMatcher.hpp"
+
+/** Constructor
+ *  Description: Prepares the pattern for matching
+ *  Parameters: pattern - The pattern, runs of STAR count as one
+ */
+PatternMatcher::PatternMatcher(const std::string & pattern) :
+        hasStar(false) {
+    for( unsigned int i = 0; i < pattern.size(); i++) {
+        if( pattern[i] == STAR) {
+            hasStar = true;
+            /** A run matches what its first STAR alone does */
+            if( !this->pattern.empty() && this->pattern.back() == STAR) {
+                continue;
+            }
+        }
+        this->pattern.push_back(pattern[i]);
+    }
+    minRest.resize(this->pattern.size() + 1);
+    maxRest.resize(this->pattern.size() + 1);
+    minRest[this->pattern.size()] = 0;
+    maxRest[this->pattern.size()] = 0;
+    for( unsigned int i = this->pattern.size(); i > 0; i--) {
+        bool star = this->pattern[i-1] == STAR;
+        minRest[i-1] = minRest[i] + !star;
+        maxRest[i-1] = star || maxRest[i] == UINT_MAX ? UINT_MAX :
+            maxRest[i] + 1;
+    }
+}
+
+/** Function Name: enter(std::vector<Step> & stack,
+ *                      std::unordered_set<unsigned long long> & entered,
+ *                      unsigned int node, unsigned int depth,
+ *                      unsigned int index, unsigned int offset) const
+ *  Description: Queues the sibling BST rooted at node, or char offset of
+ *               node's fragment, to match from pattern char index on, and
+ *               from index + 1 as well if that char is a STAR that may match
+ *               nothing
+ *  Parameters: stack - Steps still to visit
+ *              entered - (node, index, offset) steps queued so far, kept
+ *                        only when the pattern has a STAR
+ *              node - Root of the sibling BST
+ *              depth - Length of the path leading to node
+ *              index - Pattern char its chars are matched against
+ *              offset - 0 for the BST, i for char i of the fragment
+ */
+void PatternMatcher::enter(std::vector<Step> & stack,
+        std::unordered_set<unsigned long long> & entered, unsigned int node,
+        unsigned int depth, unsigned int index, unsigned int offset) const {
+    while( node != NULL_NODE && index < pattern.size()) {
+        /** Fragments hold at most 255 chars, so offset fits in 8 bits */
+        if( hasStar && !entered.insert((unsigned long long) node << 32 |
+                    (unsigned long long) index << 8 | offset).second) {
+            return;
+        }
+        stack.push_back({node, depth, index, offset});
+        if( pattern[index] != STAR) {
+            return;
+        }
+        index++;
+    }
+}
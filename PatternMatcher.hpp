@@ -0,0 +1,225 @@
+/** Filename: PatternMatcher.hpp
+ *  Name: Loc Chuong
+ *  Userid: cs100sp19aj
+ *  Description: Matches the words of a TST against a wildcard pattern, for
+ *               both the DictionaryTrie and the FrozenDictionaryTrie.
+ *  Date: 5/2/2019
+ */
+
+#ifndef PATTERN_MATCHER_HPP
+#define PATTERN_MATCHER_HPP
+
+#include "DictionaryTrie.hpp"
+#include <climits>
+#include <queue>
+#include <string>
+#include <string_view>
+#include <unordered_set>
+#include <vector>
+
+using namespace std;
+
+/** Function Name: fragmentOf(const TrieNodePool & nodes,
+ *                      const TrieNode & node)
+ *  Description: A live TST is not path compressed, its nodes hold one char
+ *  Return Value: The empty fragment
+ */
+inline std::string_view fragmentOf(const TrieNodePool &, const TrieNode &) {
+    return std::string_view();
+}
+
+/** Class Name: PatternMatcher
+ *  Description: A pattern where UNDERSCORE stands for any one char and STAR
+ *               for any run of chars, the empty run included. The TST is
+ *               walked once: a literal pattern char follows the sibling BST
+ *               down to that char only, a wildcard branches over every
+ *               sibling, and a subtree is skipped when the word length
+ *               bounds of its root rule out the chars the pattern still
+ *               needs. The chars of a node's fragment, if the TST is path
+ *               compressed, are matched one by one like a chain of nodes
+ *               without siblings. Only the most frequent matches are kept
+ *               while walking.
+ */
+class PatternMatcher
+{
+    public:
+
+        /** Constructor
+         *  Description: Prepares the pattern for matching
+         *  Parameters: pattern - The pattern, runs of STAR count as one
+         */
+        PatternMatcher(const std::string & pattern);
+
+        /** Function Name: match(const Nodes & nodes, unsigned int root,
+         *                      unsigned int num_completions) const
+         *  Description: Finds the num_completions most frequent words of a
+         *               TST that match the pattern, each once
+         *  Parameters: nodes - The node array of the TST, indexed by node,
+         *                      with fragmentOf(nodes, node) giving the
+         *                      chars of a node after its data
+         *              root - Index of the root of the TST
+         *              num_completions - The number of words to find
+         *  Return Value: The matches from most to least frequent
+         */
+        template <class Nodes>
+        std::vector<std::string> match(const Nodes & nodes, unsigned int root,
+                unsigned int num_completions) const;
+
+        /** Function Name: reaches(const Node & node, unsigned int shortest,
+         *                      unsigned int longest)
+         *  Description: Checks the word length bounds of a node, which
+         *               count the chars from the node's level to the end of
+         *               every word in its subtree, siblings included
+         *  Parameters: node - The root of the subtree
+         *              shortest - Fewest chars a word still needs
+         *              longest - Most chars a word may still have
+         *  Return Value: False if no word of the subtree fits
+         */
+        template <class Node>
+        static bool reaches(const Node & node, unsigned int shortest,
+                unsigned int longest) {
+            unsigned int maxLength = node.maxLength;
+            return node.minLength <= longest && (shortest <= maxLength ||
+                    maxLength == MAX_LENGTH_BOUND);
+        }
+
+    private:
+
+        /** Struct Step
+         *  Description: Char of a node still to visit, with the pattern char
+         *               it is matched against
+         */
+        struct Step {
+            unsigned int node; /** The node to visit */
+            unsigned int depth; /** Length of the path leading to the node */
+            unsigned int index; /** Pattern char the node's char matches */
+            unsigned int offset; /** 0 for the node's data, i for char i of
+                                  *  its fragment, counted from 1 */
+        };
+
+        std::string pattern; /** The pattern with runs of STAR merged */
+        std::vector<unsigned int> minRest; /** Chars still needed from i on */
+        std::vector<unsigned int> maxRest; /** Most chars matched from i on,
+                                            *  UINT_MAX after a STAR */
+        bool hasStar; /** Whether a word can be matched more than one way */
+
+        /** Function Name: enter(std::vector<Step> & stack,
+         *                      std::unordered_set<unsigned long long> &
+         *                      entered, unsigned int node, unsigned int depth,
+         *                      unsigned int index, unsigned int offset) const
+         *  Description: Queues the sibling BST rooted at node, or char offset
+         *               of node's fragment, to match from pattern char index
+         *               on, and from index + 1 as well if that char is a STAR
+         *               that may match nothing
+         *  Parameters: stack - Steps still to visit
+         *              entered - (node, index, offset) steps queued so far,
+         *                        kept only when the pattern has a STAR
+         *              node - Root of the sibling BST
+         *              depth - Length of the path leading to node
+         *              index - Pattern char its chars are matched against
+         *              offset - 0 for the BST, i for char i of the fragment
+         */
+        void enter(std::vector<Step> & stack,
+                std::unordered_set<unsigned long long> & entered,
+                unsigned int node, unsigned int depth, unsigned int index,
+                unsigned int offset = 0) const;
+};
+
+/** Function Name: match(const Nodes & nodes, unsigned int root,
+ *                      unsigned int num_completions) const
+ *  Description: Finds the num_completions most frequent words of a TST that
+ *               match the pattern, each once. The word of a node is only
+ *               copied out of path if it beats the least match kept.
+ *  Parameters: nodes - The node array of the TST, indexed by node, with
+ *                      fragmentOf(nodes, node) giving the chars of a node
+ *                      after its data
+ *              root - Index of the root of the TST
+ *              num_completions - The number of words to find
+ *  Return Value: The matches from most to least frequent
+ */
+template <class Nodes>
+std::vector<std::string> PatternMatcher::match(const Nodes & nodes,
+        unsigned int root, unsigned int num_completions) const {
+    if( num_completions == 0 || pattern.empty()) {
+        return {};
+    }
+    /** Most frequent matches so far, top is the least of them */
+    std::priority_queue<Word, vector<Word>, Word> best;
+    /** With a STAR one word can be reached with several pattern indices */
+    std::unordered_set<unsigned long long> entered;
+    std::unordered_set<unsigned int> matched;
+    std::vector<Step> stack;
+    string path;
+    enter(stack, entered, root, 0, 0);
+    while( !stack.empty()) {
+        Step step = stack.back();
+        stack.pop_back();
+        const auto & node = nodes[step.node];
+        std::string_view tail = fragmentOf(nodes, node);
+        char data = node.data;
+        /** Only the data of a node has siblings and length bounds */
+        if( step.offset > 0) {
+            data = tail[step.offset - 1];
+        }
+        /** No word of the subtree has as many chars as the pattern needs */
+        else if( !reaches(node, minRest[step.index], maxRest[step.index])) {
+            continue;
+        }
+        char want = pattern[step.index];
+        /** Pattern char to match after this char */
+        unsigned int next = step.index + 1;
+        if( want == STAR || want == UNDERSCORE) {
+            if( step.offset == 0 && node.left != NULL_NODE) {
+                stack.push_back({node.left, step.depth, step.index, 0});
+            }
+            if( step.offset == 0 && node.right != NULL_NODE) {
+                stack.push_back({node.right, step.depth, step.index, 0});
+            }
+            /** A STAR goes on matching below */
+            if( want == STAR) {
+                next = step.index;
+            }
+        }
+        /** A literal only follows the BST towards its char */
+        else if( want != data) {
+            unsigned int sibling = want < data ? node.left : node.right;
+            if( step.offset == 0 && sibling != NULL_NODE) {
+                stack.push_back({sibling, step.depth, step.index, 0});
+            }
+            continue;
+        }
+        /** Path now spells the word up to this char */
+        path.resize(step.depth + step.offset);
+        path.push_back(data);
+        /** The fragment goes on before the word and the BST below */
+        if( step.offset < tail.size()) {
+            if( next < pattern.size()) {
+                enter(stack, entered, step.node, step.depth, next,
+                        step.offset + 1);
+            }
+            continue;
+        }
+        int freq = node.freq;
+        if( freq != NO_WORD && minRest[next] == 0 &&
+                (best.size() < num_completions || freq > best.top().freq ||
+                 (freq == best.top().freq && path < best.top().s)) &&
+                (!hasStar || matched.insert(step.node).second)) {
+            if( best.size() == num_completions) {
+                best.pop();
+            }
+            best.push(Word(path, freq));
+        }
+        /** Down is entered last so it runs while path still ends in data */
+        if( next < pattern.size()) {
+            enter(stack, entered, node.down, path.size(), next);
+        }
+    }
+    std::vector<std::string> predictions(best.size());
+    for( unsigned int i = predictions.size(); i > 0; i--) {
+        predictions[i-1] = best.top().s;
+        best.pop();
+    }
+    return predictions;
+}
+
+#endif // PATTERN_MATCHER_HPP
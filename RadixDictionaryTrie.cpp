@@ -0,0 +1,697 @@
+/** Filename: RadixDictionaryTrie.cpp
+ *  Name: Loc Chuong
+ *  Userid: cs100sp19aj
+ *  Description: Dictionary ADT implemented as an adaptive radix tree, a
+ *               second engine answering the same queries as DictionaryTrie
+ *               with wide nodes in place of sibling BSTs.
+ *  Date: 5/2/2019
+ */
+
+#include "RadixDictionaryTrie.hpp"
+#include <algorithm>
+#include <climits>
+#include <queue>
+#include <unordered_set>
+#if defined(__SSE2__) || defined(_M_X64)
+#include <emmintrin.h>
+#define RADIX_SSE2 /** Node16 keys are compared with one SSE2 instruction */
+#endif
+#ifdef _MSC_VER
+#include <intrin.h>
+#endif
+#define INDEX_MASK ((1U << KIND_SHIFT) - 1) /** Index bits of a reference */
+
+/** Function Name: lowestBit(unsigned int mask)
+ *  Description: Position of the lowest set bit of a non-zero mask
+ *  Return Value: The number of trailing zero bits of mask
+ */
+static inline unsigned int lowestBit(unsigned int mask) {
+#ifdef _MSC_VER
+    unsigned long bit;
+    _BitScanForward(&bit, mask);
+    return bit;
+#else
+    return __builtin_ctz(mask);
+#endif
+}
+
+/** Function Name: insertSorted(unsigned char * keys,
+ *                      uint32_t * children, unsigned int count,
+ *                      unsigned char c, unsigned int child)
+ *  Description: Adds a child to the sorted keys of a Node4 or Node16 that
+ *               has room for it
+ *  Parameters: keys - Chars of the children, ascending
+ *              children - Child references, in the order of keys
+ *              count - Number of children before the insert
+ *              c - Char leading to the new child
+ *              child - Reference of the new child
+ */
+static void insertSorted(unsigned char * keys, uint32_t * children,
+        unsigned int count, unsigned char c, unsigned int child) {
+    unsigned int at = count;
+    while( at > 0 && keys[at-1] > c) {
+        keys[at] = keys[at-1];
+        children[at] = children[at-1];
+        at--;
+    }
+    keys[at] = c;
+    children[at] = child;
+}
+
+/** Function Name: takeSlot(std::vector<Node> & nodes,
+ *                      std::vector<unsigned int> & freed)
+ *  Description: Index of a zeroed node of one kind, reusing an outgrown one
+ *               if there is any
+ *  Parameters: nodes - The array of the kind
+ *              freed - Indices of its outgrown nodes
+ *  Return Value: Index of the node in nodes
+ */
+template <class Node>
+static unsigned int takeSlot(std::vector<Node> & nodes,
+        std::vector<unsigned int> & freed) {
+    if( freed.empty()) {
+        nodes.push_back(Node());
+        return nodes.size() - 1;
+    }
+    unsigned int index = freed.back();
+    freed.pop_back();
+    nodes[index] = Node();
+    return index;
+}
+
+/** Constructor
+ *  Description: Create an empty dictionary with an empty root
+ */
+RadixDictionaryTrie::RadixDictionaryTrie() : root(NULL_NODE) {
+    /** Reference NULL_NODE is Node4 slot 0, never handed out */
+    node4s.resize(1);
+    root = newNode(NODE4, 0);
+}
+
+/** Function Name: header(unsigned int node)
+ *  Description: Fields shared by every kind of node
+ *  Parameters: node - Reference of the node
+ *  Return Value: The header of node
+ */
+RadixHeader & RadixDictionaryTrie::header(unsigned int node) {
+    return const_cast<RadixHeader &>(
+            static_cast<const RadixDictionaryTrie *>(this)->header(node));
+}
+
+const RadixHeader & RadixDictionaryTrie::header(unsigned int node) const {
+    unsigned int index = node & INDEX_MASK;
+    switch( node >> KIND_SHIFT) {
+        case NODE4:
+            return node4s[index].header;
+        case NODE16:
+            return node16s[index].header;
+        case NODE48:
+            return node48s[index].header;
+        default:
+            return node256s[index].header;
+    }
+}
+
+/** Function Name: findChild(unsigned int node, unsigned char c) const
+ *  Description: Child of a node for a char. A Node16 compares c with all of
+ *               its keys at once and takes the first match, masked to the
+ *               keys in use.
+ *  Parameters: node - Reference of the parent
+ *              c - Char leading to the child
+ *  Return Value: Reference of the child, NULL_NODE if none
+ */
+unsigned int RadixDictionaryTrie::findChild(unsigned int node,
+        unsigned char c) const {
+    unsigned int index = node & INDEX_MASK;
+    switch( node >> KIND_SHIFT) {
+        case NODE4: {
+            const RadixNode4 & n = node4s[index];
+            for( unsigned int i = 0; i < n.header.count; i++) {
+                if( n.keys[i] == c) {
+                    return n.children[i];
+                }
+            }
+            return NULL_NODE;
+        }
+        case NODE16: {
+            const RadixNode16 & n = node16s[index];
+#ifdef RADIX_SSE2
+            __m128i matches = _mm_cmpeq_epi8(_mm_set1_epi8((char) c),
+                    _mm_load_si128((const __m128i *) n.keys));
+            unsigned int mask = _mm_movemask_epi8(matches) &
+                ((1U << n.header.count) - 1);
+            return mask != 0 ? n.children[lowestBit(mask)] : NULL_NODE;
+#else
+            for( unsigned int i = 0; i < n.header.count; i++) {
+                if( n.keys[i] == c) {
+                    return n.children[i];
+                }
+            }
+            return NULL_NODE;
+#endif
+        }
+        case NODE48: {
+            const RadixNode48 & n = node48s[index];
+            return n.slots[c] == NO_SLOT ? NULL_NODE :
+                n.children[n.slots[c] - 1];
+        }
+        default:
+            return node256s[index].children[c];
+    }
+}
+
+/** Function Name: forEachChild(unsigned int node, Visit visit) const
+ *  Description: Calls visit(child) for every child of a node, in char order
+ *  Parameters: node - Reference of the parent
+ *              visit - Called with the reference of each child
+ */
+template <class Visit>
+void RadixDictionaryTrie::forEachChild(unsigned int node,
+        Visit visit) const {
+    unsigned int index = node & INDEX_MASK;
+    switch( node >> KIND_SHIFT) {
+        case NODE4: {
+            const RadixNode4 & n = node4s[index];
+            for( unsigned int i = 0; i < n.header.count; i++) {
+                visit(n.children[i]);
+            }
+            break;
+        }
+        case NODE16: {
+            const RadixNode16 & n = node16s[index];
+            for( unsigned int i = 0; i < n.header.count; i++) {
+                visit(n.children[i]);
+            }
+            break;
+        }
+        case NODE48: {
+            const RadixNode48 & n = node48s[index];
+            for( unsigned int c = 0; c < 256; c++) {
+                if( n.slots[c] != NO_SLOT) {
+                    visit(n.children[n.slots[c] - 1]);
+                }
+            }
+            break;
+        }
+        default: {
+            const RadixNode256 & n = node256s[index];
+            for( unsigned int c = 0; c < 256; c++) {
+                if( n.children[c] != NULL_NODE) {
+                    visit(n.children[c]);
+                }
+            }
+        }
+    }
+}
+
+/** Function Name: newNode(unsigned int kind, unsigned char key)
+ *  Description: Takes a free node of a kind, or adds one, with no children
+ *               and no word. Adding may move that kind's array.
+ *  Parameters: kind - NODE4, NODE16, NODE48 or NODE256
+ *              key - Char leading to the node
+ *  Return Value: Reference of the new node
+ */
+unsigned int RadixDictionaryTrie::newNode(unsigned int kind,
+        unsigned char key) {
+    unsigned int index;
+    switch( kind) {
+        case NODE4:
+            index = takeSlot(node4s, freeSlots[NODE4]);
+            break;
+        case NODE16:
+            index = takeSlot(node16s, freeSlots[NODE16]);
+            break;
+        case NODE48:
+            index = takeSlot(node48s, freeSlots[NODE48]);
+            break;
+        default:
+            index = takeSlot(node256s, freeSlots[NODE256]);
+    }
+    unsigned int node = kind << KIND_SHIFT | index;
+    RadixHeader & fresh = header(node);
+    fresh.freq = NO_WORD;
+    fresh.maxFreq = NO_WORD;
+    fresh.key = key;
+    return node;
+}
+
+/** Function Name: addChild(unsigned int node, unsigned char c,
+ *                      unsigned int child)
+ *  Description: Links child under node for char c. A full node is copied
+ *               into a node of the next kind, which takes its place, and
+ *               its slot is kept for the next node of its kind.
+ *  Parameters: node - Reference of the parent, without a child for c
+ *              c - Char leading to the child
+ *              child - Reference of the child
+ *  Return Value: Reference of the parent, changed if it grew
+ */
+unsigned int RadixDictionaryTrie::addChild(unsigned int node,
+        unsigned char c, unsigned int child) {
+    unsigned int index = node & INDEX_MASK;
+    switch( node >> KIND_SHIFT) {
+        case NODE4: {
+            if( node4s[index].header.count < 4) {
+                RadixNode4 & n = node4s[index];
+                insertSorted(n.keys, n.children, n.header.count++, c, child);
+                return node;
+            }
+            /** Only the Node16 array moves, n stays valid */
+            unsigned int bigger = newNode(NODE16, 0);
+            const RadixNode4 & n = node4s[index];
+            RadixNode16 & grown = node16s[bigger & INDEX_MASK];
+            grown.header = n.header;
+            std::copy(n.keys, n.keys + 4, grown.keys);
+            std::copy(n.children, n.children + 4, grown.children);
+            freeSlots[NODE4].push_back(index);
+            return addChild(bigger, c, child);
+        }
+        case NODE16: {
+            if( node16s[index].header.count < 16) {
+                RadixNode16 & n = node16s[index];
+                insertSorted(n.keys, n.children, n.header.count++, c, child);
+                return node;
+            }
+            unsigned int bigger = newNode(NODE48, 0);
+            const RadixNode16 & n = node16s[index];
+            RadixNode48 & grown = node48s[bigger & INDEX_MASK];
+            grown.header = n.header;
+            for( unsigned int i = 0; i < 16; i++) {
+                grown.slots[n.keys[i]] = i + 1;
+                grown.children[i] = n.children[i];
+            }
+            freeSlots[NODE16].push_back(index);
+            return addChild(bigger, c, child);
+        }
+        case NODE48: {
+            if( node48s[index].header.count < 48) {
+                RadixNode48 & n = node48s[index];
+                n.children[n.header.count] = child;
+                n.slots[c] = ++n.header.count;
+                return node;
+            }
+            unsigned int bigger = newNode(NODE256, 0);
+            const RadixNode48 & n = node48s[index];
+            RadixNode256 & grown = node256s[bigger & INDEX_MASK];
+            grown.header = n.header;
+            for( unsigned int i = 0; i < 256; i++) {
+                if( n.slots[i] != NO_SLOT) {
+                    grown.children[i] = n.children[n.slots[i] - 1];
+                }
+            }
+            freeSlots[NODE48].push_back(index);
+            return addChild(bigger, c, child);
+        }
+        default: {
+            RadixNode256 & n = node256s[index];
+            n.children[c] = child;
+            n.header.count++;
+            return node;
+        }
+    }
+}
+
+/** Function Name: replaceChild(unsigned int node, unsigned char c,
+ *                      unsigned int child)
+ *  Description: Points the existing child link of node for char c at child,
+ *               after that child grew
+ *  Parameters: node - Reference of the parent
+ *              c - Char leading to the child
+ *              child - New reference of the child
+ */
+void RadixDictionaryTrie::replaceChild(unsigned int node, unsigned char c,
+        unsigned int child) {
+    unsigned int index = node & INDEX_MASK;
+    switch( node >> KIND_SHIFT) {
+        case NODE4: {
+            RadixNode4 & n = node4s[index];
+            for( unsigned int i = 0; i < n.header.count; i++) {
+                if( n.keys[i] == c) {
+                    n.children[i] = child;
+                }
+            }
+            break;
+        }
+        case NODE16: {
+            RadixNode16 & n = node16s[index];
+            for( unsigned int i = 0; i < n.header.count; i++) {
+                if( n.keys[i] == c) {
+                    n.children[i] = child;
+                }
+            }
+            break;
+        }
+        case NODE48: {
+            RadixNode48 & n = node48s[index];
+            n.children[n.slots[c] - 1] = child;
+            break;
+        }
+        default:
+            node256s[index].children[c] = child;
+    }
+}
+
+/** Function Name: insert(std::string_view word, unsigned int freq)
+ *  Description: Insert a word with its frequency into the dictionary. The
+ *               existing part of its path is walked first so a repeat
+ *               changes nothing, then maxFreq is raised along it and the
+ *               missing nodes are added below.
+ *  Parameters: word - The word to insert into the dictionary
+ *              freq - The frequency of the word
+ *  Return Value: True if the word was inserted, false if it was already in
+ *                the dictionary or is invalid (empty string)
+ */
+bool RadixDictionaryTrie::insert(std::string_view word, unsigned int freq) {
+    /** Empty string is not a valid word */
+    if( word.empty()) {
+        return false;
+    }
+    unsigned int parent = NULL_NODE;
+    unsigned int currNode = root;
+    unsigned int height = 0;
+    while( height < word.size()) {
+        unsigned int child = findChild(currNode, word[height]);
+        if( child == NULL_NODE) {
+            break;
+        }
+        parent = currNode;
+        currNode = child;
+        height++;
+    }
+    /** Word is already in the tree, don't add it */
+    if( height == word.size() && header(currNode).freq != NO_WORD) {
+        return false;
+    }
+    for( unsigned int node = root, i = 0; i <= height; i++) {
+        header(node).maxFreq = std::max<int>(header(node).maxFreq, freq);
+        node = i < height ? findChild(node, word[i]) : node;
+    }
+    for( ; height < word.size(); height++) {
+        unsigned int child = newNode(NODE4, word[height]);
+        header(child).maxFreq = freq;
+        unsigned int grown = addChild(currNode, word[height], child);
+        if( grown != currNode) {
+            if( currNode == root) {
+                root = grown;
+            }
+            else {
+                replaceChild(parent, header(grown).key, grown);
+            }
+        }
+        parent = grown;
+        currNode = child;
+    }
+    header(currNode).freq = freq;
+    return true;
+}
+
+/** Function Name: build(std::vector<std::pair<std::string_view,
+ *                      unsigned int>> entries)
+ *  Description: Bulk insert of (word, freq) entries, in word order so
+ *               consecutive inserts share most of their path. Stable so the
+ *               first of repeated words is the one kept.
+ *  Parameters: entries - The (word, freq) pairs to insert
+ */
+void RadixDictionaryTrie::build(
+        std::vector<std::pair<std::string_view, unsigned int>> entries) {
+    std::stable_sort(entries.begin(), entries.end(),
+            [](const std::pair<std::string_view, unsigned int> & a,
+                const std::pair<std::string_view, unsigned int> & b) {
+            return a.first < b.first;
+    });
+    for( unsigned int i = 0; i < entries.size(); i++) {
+        insert(entries[i].first, entries[i].second);
+    }
+}
+
+/** Function Name: findNode(const std::string & prefix) const
+ *  Description: Walks prefix down from the root, one child lookup per char
+ *  Parameters: prefix - The string to follow
+ *  Return Value: Reference of the node of prefix, NULL_NODE if no word
+ *                starts with it
+ */
+unsigned int RadixDictionaryTrie::findNode(const std::string & prefix) const {
+    unsigned int currNode = root;
+    for( unsigned int i = 0; i < prefix.size() && currNode != NULL_NODE;
+            i++) {
+        currNode = findChild(currNode, prefix[i]);
+    }
+    return currNode;
+}
+
+/** Function Name: find(std::string word) const
+ *  Description: Finds if a word is in the dictionary
+ *  Parameters: word - The word to find
+ *  Return Value: True if word is in the dictionary, false otherwise
+ */
+bool RadixDictionaryTrie::find(std::string word) const {
+    unsigned int currNode = findNode(word);
+    return !word.empty() && currNode != NULL_NODE &&
+        header(currNode).freq != NO_WORD;
+}
+
+/** Function Name: frequency(std::string word) const
+ *  Description: Frequency of a word in the dictionary
+ *  Parameters: word - The word to look up
+ *  Return Value: The frequency of word, 0 if it is not in the dictionary
+ */
+unsigned int RadixDictionaryTrie::frequency(std::string word) const {
+    return find(word) ? header(findNode(word)).freq : 0;
+}
+
+/** Function Name: predictCompletions(std::string prefix,
+ *                      unsigned int num_completions) const
+ *  Description: Best-first search below the node of prefix, as in
+ *               DictionaryTrie: subtrees are expanded in order of their
+ *               maxFreq and words come out once no subtree can beat them.
+ *               An expanded node's string is kept in trails for its
+ *               children, each of which adds its own key.
+ *  Parameters: prefix - The prefix of any word to be searched
+ *              num_completions - The number of words to find
+ *  Return Value: The completions from most to least frequent
+ */
+std::vector<std::string> RadixDictionaryTrie::predictCompletions(
+        std::string prefix, unsigned int num_completions) const {
+    std::vector<std::string> predictions;
+    unsigned int currNode = findNode(prefix);
+    if( num_completions == 0 || currNode == NULL_NODE) {
+        return predictions;
+    }
+    std::priority_queue<Candidate, vector<Candidate>, Candidate> frontier;
+    std::vector<std::string> trails(1, prefix);
+    /** The prefix itself competes with its completions */
+    if( header(currNode).freq != NO_WORD) {
+        frontier.push(Candidate(header(currNode).freq, prefix));
+    }
+    forEachChild(currNode, [&](unsigned int child) {
+        frontier.push(Candidate(header(child).maxFreq, child, 0));
+    });
+    while( !frontier.empty() && predictions.size() < num_completions) {
+        Candidate top = frontier.top();
+        frontier.pop();
+        if( !top.subtree) {
+            predictions.push_back(top.s);
+            continue;
+        }
+        const RadixHeader & node = header(top.node);
+        std::string word = trails[top.trail];
+        word.push_back(node.key);
+        if( node.freq != NO_WORD) {
+            frontier.push(Candidate(node.freq, word));
+        }
+        if( node.count > 0) {
+            unsigned int trail = trails.size();
+            trails.push_back(word);
+            forEachChild(top.node, [&](unsigned int child) {
+                frontier.push(Candidate(header(child).maxFreq, child, trail));
+            });
+        }
+    }
+    return predictions;
+}
+
+/** Function Name: keep(std::priority_queue<Word, vector<Word>, Word> & best,
+ *                      const std::string & word, int freq,
+ *                      unsigned int num_completions)
+ *  Description: Adds a match to the most frequent ones kept, if it beats
+ *               the least of them once num_completions are kept
+ *  Parameters: best - Matches kept so far, top is the least of them
+ *              word - The match
+ *              freq - Its frequency
+ *              num_completions - Most matches kept
+ */
+static void keep(std::priority_queue<Word, vector<Word>, Word> & best,
+        const std::string & word, int freq, unsigned int num_completions) {
+    if( best.size() < num_completions) {
+        best.push(Word(word, freq));
+    }
+    else if( best.top().freq < freq ||
+            (best.top().freq == freq && best.top().s > word)) {
+        best.pop();
+        best.push(Word(word, freq));
+    }
+}
+
+/** Function Name: drain(std::priority_queue<Word, vector<Word>, Word> &
+ *                      best)
+ *  Description: Empties the kept matches into a vector
+ *  Parameters: best - Matches kept, top is the least of them
+ *  Return Value: The matches from most to least frequent
+ */
+static std::vector<std::string> drain(
+        std::priority_queue<Word, vector<Word>, Word> & best) {
+    std::vector<std::string> predictions(best.size());
+    for( unsigned int i = predictions.size(); i > 0; i--) {
+        predictions[i-1] = best.top().s;
+        best.pop();
+    }
+    return predictions;
+}
+
+/** Function Name: predictUnderscore(std::string pattern,
+ *                      unsigned int num_completions) const
+ *  Description: Walks the chars before the first UNDERSCORE, then visits
+ *               every child for it and follows the rest of the pattern
+ *               literally below each. A subtree whose maxFreq is below the
+ *               least kept match is skipped once num_completions are kept.
+ *  Parameters: pattern - The pattern to match
+ *              num_completions - The number of words to find
+ *  Return Value: The matches from most to least frequent
+ */
+std::vector<std::string> RadixDictionaryTrie::predictUnderscore(
+        std::string pattern, unsigned int num_completions) const {
+    if( num_completions == 0 || pattern.empty()) {
+        return {};
+    }
+    /** Without an UNDERSCORE nothing matches, as in DictionaryTrie */
+    size_t underscore = pattern.find(UNDERSCORE);
+    if( underscore == string::npos) {
+        return {};
+    }
+    unsigned int currNode = findNode(pattern.substr(0, underscore));
+    if( currNode == NULL_NODE) {
+        return {};
+    }
+    std::priority_queue<Word, vector<Word>, Word> best;
+    std::string path = pattern;
+    forEachChild(currNode, [&](unsigned int child) {
+        if( best.size() == num_completions &&
+                header(child).maxFreq < best.top().freq) {
+            return;
+        }
+        path[underscore] = header(child).key;
+        unsigned int below = child;
+        for( unsigned int i = underscore + 1; i < pattern.size() &&
+                below != NULL_NODE; i++) {
+            below = findChild(below, pattern[i]);
+        }
+        if( below != NULL_NODE && header(below).freq != NO_WORD) {
+            keep(best, path, header(below).freq, num_completions);
+        }
+    });
+    return drain(best);
+}
+
+/** Function Name: predictPattern(std::string pattern,
+ *                      unsigned int num_completions) const
+ *  Description: Depth-first walk matching the tree against the pattern. A
+ *               literal follows one child, an UNDERSCORE every child, and a
+ *               STAR either matches nothing or takes any child and stays.
+ *               With a STAR a node can be reached at one pattern char more
+ *               than one way, so (node, index) steps and matched words are
+ *               only visited once. Subtrees that cannot beat the least
+ *               kept match are skipped.
+ *  Parameters: pattern - The pattern to match
+ *              num_completions - The number of words to find
+ *  Return Value: The matches from most to least frequent
+ */
+std::vector<std::string> RadixDictionaryTrie::predictPattern(
+        std::string pattern, unsigned int num_completions) const {
+    /** A run of STAR matches what its first STAR alone does */
+    pattern.erase(std::unique(pattern.begin(), pattern.end(),
+                [](char a, char b) { return a == STAR && b == STAR; }),
+            pattern.end());
+    if( num_completions == 0 || pattern.empty()) {
+        return {};
+    }
+    bool hasStar = pattern.find(STAR) != string::npos;
+    /** Node of the path so far, with the pattern char it matches next */
+    struct Step {
+        unsigned int node; /** The node reached */
+        unsigned int depth; /** Length of its string */
+        unsigned int index; /** Pattern char still to match */
+    };
+    std::vector<Step> stack;
+    std::unordered_set<unsigned long long> entered;
+    std::unordered_set<unsigned int> matched;
+    std::priority_queue<Word, vector<Word>, Word> best;
+    std::string path;
+    stack.push_back({root, 0, 0});
+    while( !stack.empty()) {
+        Step step = stack.back();
+        stack.pop_back();
+        if( hasStar && !entered.insert((unsigned long long) step.node << 32 |
+                    step.index).second) {
+            continue;
+        }
+        const RadixHeader & node = header(step.node);
+        if( best.size() == num_completions &&
+                node.maxFreq < best.top().freq) {
+            continue;
+        }
+        /** Path now spells the node's string */
+        path.resize(step.depth);
+        if( step.depth > 0) {
+            path[step.depth - 1] = node.key;
+        }
+        if( step.index == pattern.size()) {
+            if( node.freq != NO_WORD &&
+                    (!hasStar || matched.insert(step.node).second)) {
+                keep(best, path, node.freq, num_completions);
+            }
+            continue;
+        }
+        char want = pattern[step.index];
+        if( want == STAR) {
+            stack.push_back({step.node, step.depth, step.index + 1});
+        }
+        if( want == STAR || want == UNDERSCORE) {
+            unsigned int next = want == STAR ? step.index : step.index + 1;
+            forEachChild(step.node, [&](unsigned int child) {
+                stack.push_back({child, step.depth + 1, next});
+            });
+        }
+        else {
+            unsigned int child = findChild(step.node, want);
+            if( child != NULL_NODE) {
+                stack.push_back({child, step.depth + 1, step.index + 1});
+            }
+        }
+    }
+    return drain(best);
+}
+
+/** Function Name: nodeCount() const
+ *  Description: Number of nodes in the tree, the root included
+ *  Return Value: The number of live nodes of every kind
+ */
+unsigned int RadixDictionaryTrie::nodeCount() const {
+    return node4s.size() - 1 + node16s.size() + node48s.size() +
+        node256s.size() - freeSlots[NODE4].size() -
+        freeSlots[NODE16].size() - freeSlots[NODE48].size() -
+        freeSlots[NODE256].size();
+}
+
+/** Function Name: memoryUsage() const
+ *  Description: Memory held by the node arrays and their free lists
+ *  Return Value: The number of bytes reserved by the tree
+ */
+size_t RadixDictionaryTrie::memoryUsage() const {
+    size_t bytes = node4s.capacity() * sizeof(RadixNode4) +
+        node16s.capacity() * sizeof(RadixNode16) +
+        node48s.capacity() * sizeof(RadixNode48) +
+        node256s.capacity() * sizeof(RadixNode256);
+    for( unsigned int kind = NODE4; kind <= NODE256; kind++) {
+        bytes += freeSlots[kind].capacity() * sizeof(unsigned int);
+    }
+    return bytes;
+}
@@ -0,0 +1,260 @@
+/** Filename: RadixDictionaryTrie.hpp
+ *  Name: Loc Chuong
+ *  Userid: cs100sp19aj
+ *  Description: Dictionary ADT implemented as an adaptive radix tree, a
+ *               second engine answering the same queries as DictionaryTrie
+ *               with wide nodes in place of sibling BSTs.
+ *  Date: 5/2/2019
+ */
+
+#ifndef RADIX_DICTIONARY_TRIE_HPP
+#define RADIX_DICTIONARY_TRIE_HPP
+
+#include "DictionaryTrie.hpp"
+#include <cstdint>
+#include <string>
+#include <string_view>
+#include <utility>
+#include <vector>
+#define NODE4 0U /** Kind of a node with up to 4 children */
+#define NODE16 1U /** Kind of a node with up to 16 children */
+#define NODE48 2U /** Kind of a node with up to 48 children */
+#define NODE256 3U /** Kind of a node with a slot for every char */
+#define KIND_SHIFT 30 /** Bits of a node reference below its kind */
+#define NO_SLOT 0 /** Node48 slot of a char without a child */
+
+using namespace std;
+
+/** Struct RadixHeader
+ *  Description: Fields every node kind starts with. A node stands for the
+ *               string of chars leading to it from the root.
+ */
+struct RadixHeader {
+    int32_t freq; /** Frequency of the node's word, NO_WORD if none */
+    int32_t maxFreq; /** Highest word frequency in this node's subtree */
+    uint16_t count; /** Number of children */
+    unsigned char key; /** Char leading to the node from its parent */
+};
+
+/** Struct RadixNode4
+ *  Description: Node with up to 4 children, keys sorted and searched in
+ *               order
+ */
+struct RadixNode4 {
+    RadixHeader header; /** Word and subtree bound of the node */
+    unsigned char keys[4]; /** Chars of the children, ascending */
+    uint32_t children[4]; /** Child references, in the order of keys */
+};
+
+/** Struct RadixNode16
+ *  Description: Node with up to 16 children, keys sorted and compared all
+ *               at once with SSE2 where the target has it
+ */
+struct alignas(16) RadixNode16 {
+    unsigned char keys[16]; /** Chars of the children, ascending */
+    RadixHeader header; /** Word and subtree bound of the node */
+    uint32_t children[16]; /** Child references, in the order of keys */
+};
+
+/** Struct RadixNode48
+ *  Description: Node with up to 48 children, found through a table of 256
+ *               one byte slots
+ */
+struct RadixNode48 {
+    RadixHeader header; /** Word and subtree bound of the node */
+    unsigned char slots[256]; /** 1 + index in children of each char's
+                               *  child, NO_SLOT if none */
+    uint32_t children[48]; /** Child references, in insertion order */
+};
+
+/** Struct RadixNode256
+ *  Description: Node with a child reference for every char
+ */
+struct RadixNode256 {
+    RadixHeader header; /** Word and subtree bound of the node */
+    uint32_t children[256]; /** Child reference of each char, NULL_NODE if
+                             *  none */
+};
+
+/** Class Name: RadixDictionaryTrie
+ *  Description: Adaptive radix tree over the chars of the words. Where a TST
+ *               walks a sibling BST one byte compare per node, a node here
+ *               holds the chars of all its children together and finds one
+ *               in a single step: a short scan of at most 4 keys, one SSE2
+ *               compare of 16 keys, or a table lookup for larger fan-out.
+ *               Nodes start with 4 children and grow into the next kind
+ *               when full. A node is referenced by 32 bits, the kind in the
+ *               top 2 and the index in that kind's array below, with
+ *               NULL_NODE for none. Const methods only read the tree and
+ *               may run concurrently; insert and build must run alone.
+ */
+class RadixDictionaryTrie
+{
+    public:
+
+        /** Constructor
+         *  Description: Create an empty dictionary with an empty root
+         */
+        RadixDictionaryTrie();
+
+        /** Function Name: insert(std::string_view word, unsigned int freq)
+         *  Description: Insert a word with its frequency into the dictionary
+         *  Parameters: word - The word to insert into the dictionary
+         *              freq - The frequency of the word
+         *  Return Value: True if the word was inserted, false if it was
+         *                already in the dictionary or is invalid (empty
+         *                string)
+         */
+        bool insert(std::string_view word, unsigned int freq);
+
+        /** Function Name: build(std::vector<std::pair<std::string_view,
+         *                      unsigned int>> entries)
+         *  Description: Bulk insert of (word, freq) entries. As with insert,
+         *               empty words and repeats of a word already present
+         *               are skipped, so the first of repeated words wins.
+         *  Parameters: entries - The (word, freq) pairs to insert
+         */
+        void build(std::vector<std::pair<std::string_view, unsigned int>>
+                entries);
+
+        /** Function Name: find(std::string word) const
+         *  Description: Finds if a word is in the dictionary
+         *  Parameters: word - The word to find
+         *  Return Value: True if word is in the dictionary, false otherwise
+         */
+        bool find(std::string word) const;
+
+        /** Function Name: frequency(std::string word) const
+         *  Description: Frequency of a word in the dictionary
+         *  Parameters: word - The word to look up
+         *  Return Value: The frequency of word, 0 if it is not in the
+         *                dictionary
+         */
+        unsigned int frequency(std::string word) const;
+
+        /** Function Name: predictCompletions(std::string prefix,
+         *                      unsigned int num_completions) const
+         *  Description: The num_completions most frequent words starting
+         *               with prefix, as DictionaryTrie returns them
+         *  Parameters: prefix - The prefix of any word to be searched
+         *              num_completions - The number of words to find
+         *  Return Value: The completions from most to least frequent
+         */
+        std::vector<std::string> predictCompletions(std::string prefix,
+                unsigned int num_completions) const;
+
+        /** Function Name: predictUnderscore(std::string pattern,
+         *                      unsigned int num_completions) const
+         *  Description: The num_completions most frequent words matching a
+         *               pattern whose first UNDERSCORE stands for any one
+         *               char, as DictionaryTrie returns them
+         *  Parameters: pattern - The pattern to match
+         *              num_completions - The number of words to find
+         *  Return Value: The matches from most to least frequent
+         */
+        std::vector<std::string> predictUnderscore(std::string pattern,
+                unsigned int num_completions) const;
+
+        /** Function Name: predictPattern(std::string pattern,
+         *                      unsigned int num_completions) const
+         *  Description: The num_completions most frequent words matching a
+         *               pattern where every UNDERSCORE stands for any one
+         *               char and every STAR for any run of chars, as
+         *               DictionaryTrie returns them
+         *  Parameters: pattern - The pattern to match
+         *              num_completions - The number of words to find
+         *  Return Value: The matches from most to least frequent
+         */
+        std::vector<std::string> predictPattern(std::string pattern,
+                unsigned int num_completions) const;
+
+        /** Function Name: nodeCount() const
+         *  Description: Number of nodes in the tree, the root included
+         *  Return Value: The number of live nodes of every kind
+         */
+        unsigned int nodeCount() const;
+
+        /** Function Name: memoryUsage() const
+         *  Description: Memory held by the node arrays and their free lists
+         *  Return Value: The number of bytes reserved by the tree
+         */
+        size_t memoryUsage() const;
+
+    private:
+
+        std::vector<RadixNode4> node4s; /** Node4s, slot NULL_NODE unused */
+        std::vector<RadixNode16> node16s; /** Node16s */
+        std::vector<RadixNode48> node48s; /** Node48s */
+        std::vector<RadixNode256> node256s; /** Node256s */
+        std::vector<unsigned int> freeSlots[4]; /** Indices of nodes
+                                                 *  outgrown, by kind */
+        unsigned int root; /** Reference of the node of the empty string */
+
+        /** Function Name: header(unsigned int node)
+         *  Description: Fields shared by every kind of node
+         *  Parameters: node - Reference of the node
+         *  Return Value: The header of node
+         */
+        RadixHeader & header(unsigned int node);
+        const RadixHeader & header(unsigned int node) const;
+
+        /** Function Name: findChild(unsigned int node,
+         *                      unsigned char c) const
+         *  Description: Child of a node for a char
+         *  Parameters: node - Reference of the parent
+         *              c - Char leading to the child
+         *  Return Value: Reference of the child, NULL_NODE if none
+         */
+        unsigned int findChild(unsigned int node, unsigned char c) const;
+
+        /** Function Name: findNode(const std::string & prefix) const
+         *  Description: Walks prefix down from the root
+         *  Parameters: prefix - The string to follow
+         *  Return Value: Reference of the node of prefix, NULL_NODE if no
+         *                word starts with it
+         */
+        unsigned int findNode(const std::string & prefix) const;
+
+        /** Function Name: forEachChild(unsigned int node,
+         *                      Visit visit) const
+         *  Description: Calls visit(child) for every child of a node
+         *  Parameters: node - Reference of the parent
+         *              visit - Called with the reference of each child
+         */
+        template <class Visit>
+        void forEachChild(unsigned int node, Visit visit) const;
+
+        /** Function Name: newNode(unsigned int kind, unsigned char key)
+         *  Description: Takes a free node of a kind, or adds one, with no
+         *               children and no word
+         *  Parameters: kind - NODE4, NODE16, NODE48 or NODE256
+         *              key - Char leading to the node
+         *  Return Value: Reference of the new node
+         */
+        unsigned int newNode(unsigned int kind, unsigned char key);
+
+        /** Function Name: addChild(unsigned int node, unsigned char c,
+         *                      unsigned int child)
+         *  Description: Links child under node for char c, moving node into
+         *               the next kind first if it is full
+         *  Parameters: node - Reference of the parent, without a child for c
+         *              c - Char leading to the child
+         *              child - Reference of the child
+         *  Return Value: Reference of the parent, changed if it grew
+         */
+        unsigned int addChild(unsigned int node, unsigned char c,
+                unsigned int child);
+
+        /** Function Name: replaceChild(unsigned int node, unsigned char c,
+         *                      unsigned int child)
+         *  Description: Points the existing child link of node for char c
+         *               at child, after that child grew
+         *  Parameters: node - Reference of the parent
+         *              c - Char leading to the child
+         *              child - New reference of the child
+         */
+        void replaceChild(unsigned int node, unsigned char c,
+                unsigned int child);
+};
+
+#endif // RADIX_DICTIONARY_TRIE_HPP
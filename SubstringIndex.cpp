@@ -0,0 +1,332 @@
+/** Filename: SubstringIndex.cpp
+ *  Name: Loc Chuong
+ *  Userid: cs100sp19aj
+ *  Description: Secondary index of a dictionary that finds the most frequent
+ *               words containing a string anywhere, not just as a prefix, so
+ *               "phone" also finds "smartphone" and "headphones".
+ *  Date: 5/2/2019
+ */
+
+#include "SubstringIndex.hpp"
+#include <algorithm>
+#include <climits>
+#include <queue>
+#define KEY_CHARS 7 /** Chars of a suffix packed into its sort key */
+#define KEY_BITS 9 /** Bits per char of a sort key, a char plus one */
+
+/** Struct Range
+ *  Description: Suffix array range still to report, keyed by its smallest
+ *               word rank and the entry holding it
+ */
+struct Range {
+    unsigned int rank; /** Smallest word rank in the range */
+    unsigned int at; /** Entry holding that rank */
+    unsigned int lo; /** First entry of the range */
+    unsigned int hi; /** One past the last entry */
+
+    /** Operator()
+     *  Description: Orders ranges for std::priority_queue, so the top is
+     *               the range holding the best word
+     *  Return Value: True if r1 should come out after r2, False otherwise
+     */
+    bool operator() (const Range & r1, const Range & r2) const {
+        return r1.rank > r2.rank;
+    }
+};
+
+/** Function Name: lessSuffix(const std::string & text, unsigned int a,
+ *                      unsigned int b)
+ *  Description: Orders two suffixes of text, each cut at the end of its
+ *               word, with the end of a word before any char
+ *  Return Value: True if the suffix at a sorts before the suffix at b
+ */
+static bool lessSuffix(const std::string & text, unsigned int a,
+        unsigned int b) {
+    while(1) {
+        unsigned char ca = text[a++];
+        unsigned char cb = text[b++];
+        if( ca == WORD_END || cb == WORD_END) {
+            return ca == WORD_END && cb != WORD_END;
+        }
+        if( ca != cb) {
+            return ca < cb;
+        }
+    }
+}
+
+/** Function Name: suffixKey(const std::string & text, unsigned int offset)
+ *  Description: Packs the first KEY_CHARS chars of a suffix, cut at the end
+ *               of its word, into a number that sorts like the suffix: each
+ *               char takes KEY_BITS bits as its value plus one, and the end
+ *               of the word and everything after it are 0
+ *  Return Value: The sort key of the suffix at offset
+ */
+static unsigned long long suffixKey(const std::string & text,
+        unsigned int offset) {
+    unsigned long long key = 0;
+    bool ended = false;
+    for( unsigned int i = 0; i < KEY_CHARS; i++) {
+        ended = ended || text[offset + i] == WORD_END;
+        key <<= KEY_BITS;
+        if( !ended) {
+            key |= (unsigned char) text[offset + i] + 1;
+        }
+    }
+    return key;
+}
+
+/** Constructor
+ *  Description: Starts with an empty index
+ */
+SubstringIndex::SubstringIndex() : starts(1, 0), leaves(0) {}
+
+/** Function Name: build(std::vector<std::pair<std::string_view,
+ *                      unsigned int>> entries)
+ *  Description: Replaces the index with one over the (word, freq) entries.
+ *               Empty words are skipped and the first of repeated words
+ *               wins, as in DictionaryTrie::build.
+ *  Parameters: entries - The words and their frequencies
+ */
+void SubstringIndex::build(
+        std::vector<std::pair<std::string_view, unsigned int>> entries) {
+    /** Stable so the first of repeated words is the one kept */
+    std::stable_sort(entries.begin(), entries.end(),
+            [](const std::pair<std::string_view, unsigned int> & a,
+                const std::pair<std::string_view, unsigned int> & b) {
+            return a.first < b.first;
+    });
+    entries.erase(std::unique(entries.begin(), entries.end(),
+                [](const std::pair<std::string_view, unsigned int> & a,
+                    const std::pair<std::string_view, unsigned int> & b) {
+                return a.first == b.first;
+    }), entries.end());
+    /** Rank order is the order of Word, most frequent first */
+    std::sort(entries.begin(), entries.end(),
+            [](const std::pair<std::string_view, unsigned int> & a,
+                const std::pair<std::string_view, unsigned int> & b) {
+            if( a.second != b.second) {
+                return a.second > b.second;
+            }
+            return a.first < b.first;
+    });
+    text.clear();
+    starts.clear();
+    for( unsigned int i = 0; i < entries.size(); i++) {
+        if( entries[i].first.empty()) {
+            continue;
+        }
+        starts.push_back(text.size());
+        text.append(entries[i].first);
+        text.push_back(WORD_END);
+    }
+    starts.push_back(text.size());
+    text.shrink_to_fit();
+    starts.shrink_to_fit();
+    /** Every suffix but the ones starting at a WORD_END, keyed by its
+     *  first KEY_CHARS chars so most comparisons never touch text */
+    std::vector<std::pair<unsigned long long, unsigned int>> keyed;
+    keyed.reserve(text.size() - (starts.size() - 1));
+    for( unsigned int offset = 0; offset < text.size(); offset++) {
+        if( text[offset] != WORD_END) {
+            keyed.push_back(std::make_pair(suffixKey(text, offset), offset));
+        }
+    }
+    std::sort(keyed.begin(), keyed.end(),
+            [this](const std::pair<unsigned long long, unsigned int> & a,
+                const std::pair<unsigned long long, unsigned int> & b) {
+            if( a.first != b.first) {
+                return a.first < b.first;
+            }
+            return lessSuffix(text, a.second, b.second);
+    });
+    suffixes.resize(keyed.size());
+    for( unsigned int i = 0; i < keyed.size(); i++) {
+        suffixes[i] = keyed[i].second;
+    }
+    suffixes.shrink_to_fit();
+    ranks.resize(suffixes.size());
+    for( unsigned int i = 0; i < suffixes.size(); i++) {
+        ranks[i] = std::upper_bound(starts.begin(), starts.end(),
+                suffixes[i]) - starts.begin() - 1;
+    }
+    /** Leaf b holds the least rank of entries from b * RMQ_BLOCK on */
+    unsigned int blocks = (ranks.size() + RMQ_BLOCK - 1) / RMQ_BLOCK;
+    leaves = 1;
+    while( leaves < blocks) {
+        leaves *= 2;
+    }
+    blockMins.assign(2 * leaves, UINT_MAX);
+    for( unsigned int i = 0; i < ranks.size(); i++) {
+        unsigned int & leaf = blockMins[leaves + i / RMQ_BLOCK];
+        leaf = std::min(leaf, ranks[i]);
+    }
+    for( unsigned int node = leaves - 1; node > 0; node--) {
+        blockMins[node] = std::min(blockMins[2 * node],
+                blockMins[2 * node + 1]);
+    }
+}
+
+/** Function Name: compareSuffix(unsigned int offset,
+ *                      std::string_view substring) const
+ *  Description: Compares the suffix at offset, cut at the end of its word,
+ *               with substring. The end of a word sorts before any char.
+ *  Parameters: offset - Offset of the suffix in text
+ *              substring - The string to compare against
+ *  Return Value: Negative if the suffix sorts first, 0 if it begins with
+ *                substring, positive otherwise
+ */
+int SubstringIndex::compareSuffix(unsigned int offset,
+        std::string_view substring) const {
+    for( unsigned int i = 0; i < substring.size(); i++) {
+        unsigned char c = text[offset + i];
+        unsigned char want = substring[i];
+        /** Stops at the WORD_END, the text never runs out before it */
+        if( c == WORD_END) {
+            return -1;
+        }
+        if( c != want) {
+            return c < want ? -1 : 1;
+        }
+    }
+    return 0;
+}
+
+/** Function Name: leastRank(unsigned int lo, unsigned int hi) const
+ *  Description: Finds the suffix of the best word in a range. The partial
+ *               blocks at both ends are scanned, the whole blocks between
+ *               them are covered by the segment tree, and the winning block
+ *               is scanned last.
+ *  Parameters: lo - First suffix array entry of the range
+ *              hi - One past the last entry, greater than lo
+ *  Return Value: The entry in [lo, hi) with the smallest rank
+ */
+unsigned int SubstringIndex::leastRank(unsigned int lo,
+        unsigned int hi) const {
+    unsigned int firstBlock = (lo + RMQ_BLOCK - 1) / RMQ_BLOCK;
+    unsigned int lastBlock = hi / RMQ_BLOCK;
+    unsigned int best = lo;
+    /** No whole block inside the range */
+    if( firstBlock >= lastBlock) {
+        for( unsigned int i = lo + 1; i < hi; i++) {
+            if( ranks[i] < ranks[best]) {
+                best = i;
+            }
+        }
+        return best;
+    }
+    for( unsigned int i = lo + 1; i < firstBlock * RMQ_BLOCK; i++) {
+        if( ranks[i] < ranks[best]) {
+            best = i;
+        }
+    }
+    for( unsigned int i = lastBlock * RMQ_BLOCK; i < hi; i++) {
+        if( ranks[i] < ranks[best]) {
+            best = i;
+        }
+    }
+    /** Tree node covering the whole blocks with the least rank */
+    unsigned int node = 0;
+    unsigned int l = firstBlock + leaves;
+    unsigned int r = lastBlock + leaves;
+    while( l < r) {
+        if( l & 1) {
+            if( node == 0 || blockMins[l] < blockMins[node]) {
+                node = l;
+            }
+            l++;
+        }
+        if( r & 1) {
+            r--;
+            if( node == 0 || blockMins[r] < blockMins[node]) {
+                node = r;
+            }
+        }
+        l /= 2;
+        r /= 2;
+    }
+    if( blockMins[node] >= ranks[best]) {
+        return best;
+    }
+    while( node < leaves) {
+        node = blockMins[2 * node] == blockMins[node] ? 2 * node :
+            2 * node + 1;
+    }
+    unsigned int first = (node - leaves) * RMQ_BLOCK;
+    for( unsigned int i = first; i < first + RMQ_BLOCK; i++) {
+        if( ranks[i] == blockMins[node]) {
+            return i;
+        }
+    }
+    return best;
+}
+
+/** Function Name: predictSubstring(std::string_view substring,
+ *                      unsigned int num_completions) const
+ *  Description: Finds the most frequent words containing substring. Ranges
+ *               of the suffix array come out best word first; each one is
+ *               split around the entry it reported, and the entries of a
+ *               word holding substring more than once come out in a row.
+ *  Parameters: substring - The string to look for inside words
+ *              num_completions - The number of words to find
+ *  Return Value: The words from most to least frequent, each once
+ */
+std::vector<std::string> SubstringIndex::predictSubstring(
+        std::string_view substring, unsigned int num_completions) const {
+    std::vector<std::string> predictions;
+    if( num_completions == 0 || suffixes.empty()) {
+        return predictions;
+    }
+    /** The suffixes beginning with substring */
+    auto first = std::partition_point(suffixes.begin(), suffixes.end(),
+            [&](unsigned int offset) {
+            return compareSuffix(offset, substring) < 0;
+    });
+    auto last = std::partition_point(first, suffixes.end(),
+            [&](unsigned int offset) {
+            return compareSuffix(offset, substring) == 0;
+    });
+    if( first == last) {
+        return predictions;
+    }
+    std::priority_queue<Range, vector<Range>, Range> ranges;
+    unsigned int lo = first - suffixes.begin();
+    unsigned int hi = last - suffixes.begin();
+    unsigned int at = leastRank(lo, hi);
+    ranges.push({ranks[at], at, lo, hi});
+    unsigned int reported = UINT_MAX;
+    while( !ranges.empty() && predictions.size() < num_completions) {
+        Range range = ranges.top();
+        ranges.pop();
+        if( range.rank != reported) {
+            reported = range.rank;
+            predictions.push_back(text.substr(starts[reported],
+                        starts[reported + 1] - starts[reported] - 1));
+        }
+        if( range.lo < range.at) {
+            at = leastRank(range.lo, range.at);
+            ranges.push({ranks[at], at, range.lo, range.at});
+        }
+        if( range.at + 1 < range.hi) {
+            at = leastRank(range.at + 1, range.hi);
+            ranges.push({ranks[at], at, range.at + 1, range.hi});
+        }
+    }
+    return predictions;
+}
+
+/** Function Name: size() const
+ *  Description: Number of words indexed
+ *  Return Value: The number of distinct non-empty words
+ */
+unsigned int SubstringIndex::size() const {
+    return starts.size() - 1;
+}
+
+/** Function Name: memoryUsage() const
+ *  Description: Memory held by the text, suffix array and range min tree
+ *  Return Value: The number of bytes reserved by the index
+ */
+size_t SubstringIndex::memoryUsage() const {
+    return text.capacity() + sizeof(unsigned int) * (starts.capacity() +
+            suffixes.capacity() + ranks.capacity() + blockMins.capacity());
+}
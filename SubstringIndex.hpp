@@ -0,0 +1,110 @@
+/** Filename: SubstringIndex.hpp
+ *  Name: Loc Chuong
+ *  Userid: cs100sp19aj
+ *  Description: Secondary index of a dictionary that finds the most frequent
+ *               words containing a string anywhere, not just as a prefix, so
+ *               "phone" also finds "smartphone" and "headphones".
+ *  Date: 5/2/2019
+ */
+
+#ifndef SUBSTRING_INDEX_HPP
+#define SUBSTRING_INDEX_HPP
+
+#include <string>
+#include <string_view>
+#include <utility>
+#include <vector>
+#define WORD_END '\n' /** Ends every word of the text, never inside a word */
+#define RMQ_BLOCK 32 /** Suffix array entries under one range min leaf */
+
+using namespace std;
+
+/** Class Name: SubstringIndex
+ *  Description: Suffix array over the vocabulary. The words are ranked from
+ *               most to least frequent (alphabetically on a tie) and
+ *               concatenated in rank order, each followed by WORD_END, and
+ *               every suffix starting inside a word is sorted up to the end
+ *               of its word. The words containing s own exactly the suffixes
+ *               that begin with s, one contiguous range of the array, found
+ *               by binary search. The best of them is the smallest rank in
+ *               the range; a segment tree over blocks of RMQ_BLOCK ranks
+ *               finds it, and the range is split around it to find the next,
+ *               so a query costs O(|s| log n + k log n) whatever the number
+ *               of matches.
+ */
+class SubstringIndex
+{
+    public:
+
+        /** Constructor
+         *  Description: Starts with an empty index
+         */
+        SubstringIndex();
+
+        /** Function Name: build(std::vector<std::pair<std::string_view,
+         *                      unsigned int>> entries)
+         *  Description: Replaces the index with one over the (word, freq)
+         *               entries. Empty words are skipped and the first of
+         *               repeated words wins, as in DictionaryTrie::build.
+         *  Parameters: entries - The words and their frequencies
+         */
+        void build(std::vector<std::pair<std::string_view, unsigned int>>
+                entries);
+
+        /** Function Name: predictSubstring(std::string_view substring,
+         *                      unsigned int num_completions) const
+         *  Description: Finds the most frequent words containing substring
+         *  Parameters: substring - The string to look for inside words
+         *              num_completions - The number of words to find
+         *  Return Value: The words from most to least frequent, each once
+         */
+        std::vector<std::string> predictSubstring(std::string_view substring,
+                unsigned int num_completions) const;
+
+        /** Function Name: size() const
+         *  Description: Number of words indexed
+         *  Return Value: The number of distinct non-empty words
+         */
+        unsigned int size() const;
+
+        /** Function Name: memoryUsage() const
+         *  Description: Memory held by the text, suffix array and range min
+         *               tree
+         *  Return Value: The number of bytes reserved by the index
+         */
+        size_t memoryUsage() const;
+
+    private:
+
+        std::string text; /** Words in rank order, each ending in WORD_END */
+        std::vector<unsigned int> starts; /** Offset of each word in text,
+                                           *  then the size of text */
+        std::vector<unsigned int> suffixes; /** Sorted suffix offsets */
+        std::vector<unsigned int> ranks; /** Word rank of each suffix */
+        std::vector<unsigned int> blockMins; /** Segment tree of the least
+                                              *  rank of each block */
+        unsigned int leaves; /** Leaves of blockMins, a power of two */
+
+        /** Function Name: compareSuffix(unsigned int offset,
+         *                      std::string_view substring) const
+         *  Description: Compares the suffix at offset, cut at the end of its
+         *               word, with substring. The end of a word sorts before
+         *               any char.
+         *  Parameters: offset - Offset of the suffix in text
+         *              substring - The string to compare against
+         *  Return Value: Negative if the suffix sorts first, 0 if it begins
+         *                with substring, positive otherwise
+         */
+        int compareSuffix(unsigned int offset,
+                std::string_view substring) const;
+
+        /** Function Name: leastRank(unsigned int lo, unsigned int hi) const
+         *  Description: Finds the suffix of the best word in a range
+         *  Parameters: lo - First suffix array entry of the range
+         *              hi - One past the last entry, greater than lo
+         *  Return Value: The entry in [lo, hi) with the smallest rank
+         */
+        unsigned int leastRank(unsigned int lo, unsigned int hi) const;
+};
+
+#endif // SUBSTRING_INDEX_HPP
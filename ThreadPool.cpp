@@ -0,0 +1,128 @@
+/** Filename: ThreadPool.cpp
+ *  Name: Loc Chuong
+ *  Userid: cs100sp19aj
+ *  Description: Fixed set of worker threads used to spread a batch of
+ *               independent jobs, such as dictionary queries, over cores.
+ *  Date: 5/2/2019
+ */
+
+#include "ThreadPool.hpp"
+#include <atomic>
+#include <memory>
+
+/** Struct Loop
+ *  Description: State of one parallelFor call, shared with the tasks helping
+ *               it. A task that starts after the loop is done finds no index
+ *               left and never touches job.
+ */
+struct Loop {
+    const std::function<void(unsigned int)> * job; /** Work per index */
+    unsigned int count; /** Number of indices */
+    std::atomic<unsigned int> next; /** Next index to claim */
+    std::atomic<unsigned int> done; /** Indices whose job returned */
+    std::mutex lock; /** Guards the wait for done */
+    std::condition_variable finished; /** Signals done reaching count */
+
+    /** Function Name: run()
+     *  Description: Claims and runs indices until none is left
+     */
+    void run() {
+        unsigned int i;
+        while( (i = next++) < count) {
+            (*job)(i);
+            if( ++done == count) {
+                std::lock_guard<std::mutex> guard(lock);
+                finished.notify_all();
+            }
+        }
+    }
+};
+
+/** Constructor
+ *  Description: Starts the worker threads
+ *  Parameters: num_threads - Total threads working on a loop, the calling
+ *                            thread included, so num_threads - 1 workers are
+ *                            started
+ */
+ThreadPool::ThreadPool(unsigned int num_threads) : stopping(false) {
+    for( unsigned int i = 1; i < num_threads; i++) {
+        workers.push_back(std::thread(&ThreadPool::work, this));
+    }
+}
+
+/** Function Name: parallelFor(unsigned int count,
+ *                      const std::function<void(unsigned int)> & job)
+ *  Description: Calls job(i) for every i in [0, count) on the workers and the
+ *               calling thread, returning once every call has returned. Each
+ *               index is claimed by exactly one thread.
+ *  Parameters: count - The number of indices
+ *              job - The work to do for one index
+ */
+void ThreadPool::parallelFor(unsigned int count,
+        const std::function<void(unsigned int)> & job) {
+    if( count == 0) {
+        return;
+    }
+    std::shared_ptr<Loop> loop = std::make_shared<Loop>();
+    loop->job = &job;
+    loop->count = count;
+    loop->next = 0;
+    loop->done = 0;
+    /** One helper task per worker, but never more helpers than indices */
+    unsigned int helpers = workers.size() < count - 1 ? workers.size() :
+        count - 1;
+    if( helpers > 0) {
+        std::lock_guard<std::mutex> guard(lock);
+        for( unsigned int i = 0; i < helpers; i++) {
+            tasks.push_back([loop]() { loop->run(); });
+        }
+    }
+    for( unsigned int i = 0; i < helpers; i++) {
+        ready.notify_one();
+    }
+    loop->run();
+    /** Other threads may still be running the last indices */
+    std::unique_lock<std::mutex> guard(loop->lock);
+    loop->finished.wait(guard, [&]() { return loop->done == count; });
+}
+
+/** Function Name: size() const
+ *  Description: Number of threads working on a loop
+ *  Return Value: The number of workers plus the calling thread
+ */
+unsigned int ThreadPool::size() const {
+    return workers.size() + 1;
+}
+
+/** Function Name: work()
+ *  Description: Body of every worker, runs tasks until stopping
+ */
+void ThreadPool::work() {
+    while(1) {
+        std::function<void()> task;
+        {
+            std::unique_lock<std::mutex> guard(lock);
+            ready.wait(guard, [this]() { return stopping || !tasks.empty(); });
+            if( tasks.empty()) {
+                return;
+            }
+            task = std::move(tasks.front());
+            tasks.pop_front();
+        }
+        task();
+    }
+}
+
+/** Destructor
+ *  Description: Lets the workers finish the queued tasks and joins them
+ */
+ThreadPool::~ThreadPool() {
+    {
+        std::lock_guard<std::mutex> guard(lock);
+        stopping = true;
+    }
+    ready.notify_all();
+    for( unsigned int i = 0; i < workers.size(); i++) {
+        workers[i].join();
+    }
+}
@@ -0,0 +1,82 @@
+/** Filename: ThreadPool.hpp
+ *  Name: Loc Chuong
+ *  Userid: cs100sp19aj
+ *  Description: Fixed set of worker threads used to spread a batch of
+ *               independent jobs, such as dictionary queries, over cores.
+ *  Date: 5/2/2019
+ */
+
+#ifndef THREAD_POOL_HPP
+#define THREAD_POOL_HPP
+
+#include <condition_variable>
+#include <deque>
+#include <functional>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+using namespace std;
+
+/** Class Name: ThreadPool
+ *  Description: Worker threads waiting on a shared queue of tasks. Jobs are
+ *               submitted as a parallel loop over indices; the calling
+ *               thread works on the loop too, so a loop always makes progress
+ *               even when every worker is busy, and several threads may
+ *               submit loops at once.
+ */
+class ThreadPool
+{
+    public:
+
+        /** Constructor
+         *  Description: Starts the worker threads
+         *  Parameters: num_threads - Total threads working on a loop, the
+         *                            calling thread included, so
+         *                            num_threads - 1 workers are started
+         */
+        ThreadPool(unsigned int num_threads);
+
+        /** The workers belong to the pool, it cannot be copied */
+        ThreadPool(const ThreadPool &) = delete;
+        ThreadPool & operator=(const ThreadPool &) = delete;
+
+        /** Function Name: parallelFor(unsigned int count,
+         *                      const std::function<void(unsigned int)> & job)
+         *  Description: Calls job(i) for every i in [0, count) on the
+         *               workers and the calling thread, returning once every
+         *               call has returned. Each index is claimed by exactly
+         *               one thread.
+         *  Parameters: count - The number of indices
+         *              job - The work to do for one index
+         */
+        void parallelFor(unsigned int count,
+                const std::function<void(unsigned int)> & job);
+
+        /** Function Name: size() const
+         *  Description: Number of threads working on a loop
+         *  Return Value: The number of workers plus the calling thread
+         */
+        unsigned int size() const;
+
+        /** Destructor
+         *  Description: Lets the workers finish the queued tasks and joins
+         *               them
+         */
+        ~ThreadPool();
+
+    private:
+
+        std::vector<std::thread> workers; /** Threads running queued tasks */
+        std::deque<std::function<void()>> tasks; /** Tasks not yet started */
+        std::mutex lock; /** Guards tasks and stopping */
+        std::condition_variable ready; /** Signals a new task or stopping */
+        bool stopping; /** True once the destructor runs */
+
+        /** Function Name: work()
+         *  Description: Body of every worker, runs tasks until stopping
+         */
+        void work();
+};
+
+#endif // THREAD_POOL_HPP
@@ -1,24 +1,214 @@
 /** Filename: TrieNode.cpp
  *  Name: Loc Chuong
  *  Userid: cs100sp19aj
- *  Description: Defines a TrieNode object used to create the Trie.
+ *  Description: Defines a TrieNode object used to create the Trie and the
+ *               TrieNodePool arena that owns every node of a Trie.
  *  Date: 4/29/2019
  */
 
 #include "TrieNode.hpp"
 #include "DictionaryTrie.hpp"
+#include <cstdlib>
 #include <iostream>
+#include <new>
 
 /** Default constructor
  *  Description: Creates a node with instance variables of zero-like value
+ *               that ends no word
  */
-TrieNode::TrieNode() : data(0), word(false), freq(0), left(nullptr), right(nullptr), down(nullptr) {
+TrieNode::TrieNode() : left(NULL_NODE), right(NULL_NODE), down(NULL_NODE),
+    freq(NO_WORD), maxFreq(0), data(0), minLength(MAX_LENGTH_BOUND),
+    maxLength(0) {
 }
 
 /** Constructor
  *  Description: Creaters a TrieNode using the parameter data
  *  Parameters: data - The data held by the node
  */
-TrieNode::TrieNode(char data) : data(data), word(false), freq(0) {
-    left = right = down = nullptr;
+TrieNode::TrieNode(char data) : left(NULL_NODE), right(NULL_NODE),
+    down(NULL_NODE), freq(NO_WORD), maxFreq(0), data(data),
+    minLength(MAX_LENGTH_BOUND), maxLength(0) {
+}
+
+/** Constructor
+ *  Description: Creates an empty pool, the reserved node is built with the
+ *               first slab
+ */
+TrieNodePool::TrieNodePool() : slabLimit(0), freeHead(NULL_NODE),
+    freeCount(0) {
+    /** Zeroed pages are only committed once a slot on them is written, and
+     *  an all zero slot is nullptr */
+    slabs = static_cast<std::atomic<TrieNode *> *>(
+            calloc(MAX_SLABS, sizeof(std::atomic<TrieNode *>)));
+    if( slabs == nullptr) {
+        throw std::bad_alloc();
+    }
+    /** Reserve index NULL_NODE so no real node is ever addressed by it */
+    count.store(NULL_NODE + 1, std::memory_order_relaxed);
+}
+
+/** Function Name: openSlab(unsigned int slab)
+ *  Description: Returns slab, opening it if no thread did yet
+ *  Parameters: slab - The slot of the slab in slabs
+ *  Return Value: The first node of the slab
+ */
+TrieNode * TrieNodePool::openSlab(unsigned int slab) {
+    TrieNode * nodes = slabs[slab].load(std::memory_order_acquire);
+    if( nodes == nullptr) {
+        /** Raw memory, nodes are only constructed when handed out */
+        TrieNode * fresh = static_cast<TrieNode *>(
+                ::operator new(SLAB_SIZE * sizeof(TrieNode)));
+        if( slab == 0) {
+            new (&fresh[NULL_NODE]) TrieNode();
+        }
+        /** Another thread may open the same slab, the first one wins */
+        if( slabs[slab].compare_exchange_strong(nodes, fresh,
+                    std::memory_order_acq_rel)) {
+            nodes = fresh;
+        }
+        else {
+            ::operator delete(fresh);
+        }
+        unsigned int limit = slabLimit.load(std::memory_order_relaxed);
+        while( limit <= slab && !slabLimit.compare_exchange_weak(limit,
+                    slab + 1, std::memory_order_relaxed)) {
+        }
+    }
+    return nodes;
+}
+
+/** Function Name: allocate(char data)
+ *  Description: Reuses a released node if there is one, else carves a new
+ *               node out of the current slab, opening a new slab when the
+ *               current one is full. Lock-free, concurrent callers get
+ *               distinct nodes.
+ *  Parameters: data - The data for the new TrieNode to hold
+ *  Return Value: The pool index of the new node
+ */
+unsigned int TrieNodePool::allocate(char data) {
+    unsigned long long head = freeHead.load(std::memory_order_acquire);
+    while( (unsigned int) head != NULL_NODE) {
+        unsigned int index = (unsigned int) head;
+        TrieNode & node = (*this)[index];
+        /** A released node links to the next one through down. The tag
+         *  fails the CAS if the node was taken and released again since */
+        unsigned long long next = node.down.load(std::memory_order_relaxed) |
+            ((head >> FREE_TAG_SHIFT) + 1) << FREE_TAG_SHIFT;
+        if( freeHead.compare_exchange_weak(head, next,
+                    std::memory_order_acquire)) {
+            freeCount.fetch_sub(1, std::memory_order_relaxed);
+            /** Reset field by field, other threads may still load down */
+            node.left.store(NULL_NODE, std::memory_order_relaxed);
+            node.right.store(NULL_NODE, std::memory_order_relaxed);
+            node.down.store(NULL_NODE, std::memory_order_relaxed);
+            node.freq.store(NO_WORD, std::memory_order_relaxed);
+            node.maxFreq.store(0, std::memory_order_relaxed);
+            node.data = data;
+            node.minLength.store(MAX_LENGTH_BOUND, std::memory_order_relaxed);
+            node.maxLength.store(0, std::memory_order_relaxed);
+            return index;
+        }
+    }
+    unsigned int index = count.fetch_add(1, std::memory_order_relaxed);
+    /** Construct the node in place at the claimed index */
+    new (&openSlab(index >> SLAB_SHIFT)[index & SLAB_MASK]) TrieNode(data);
+    return index;
+}
+
+/** Function Name: release(unsigned int index)
+ *  Description: Puts a node back for allocate to hand out again. Lock-free.
+ *               The node must not be reachable from any Trie, as a node
+ *               built for a lost CAS is not.
+ *  Parameters: index - Pool index of the node to release
+ */
+void TrieNodePool::release(unsigned int index) {
+    TrieNode & node = (*this)[index];
+    unsigned long long head = freeHead.load(std::memory_order_relaxed);
+    do {
+        node.down.store((unsigned int) head, std::memory_order_relaxed);
+    } while( !freeHead.compare_exchange_weak(head,
+                (head >> FREE_TAG_SHIFT) << FREE_TAG_SHIFT | index,
+                std::memory_order_release, std::memory_order_relaxed));
+    freeCount.fetch_add(1, std::memory_order_relaxed);
+}
+
+/** Function Name: allocateRange(unsigned int n)
+ *  Description: Hands out n consecutive indices at once, opening as many slabs
+ *               as needed. The nodes are not constructed, the caller
+ *               constructs every one of them in place, which lets threads
+ *               fill disjoint ranges concurrently. Unlike allocate it must
+ *               not run concurrently with other allocations.
+ *  Parameters: n - The number of indices to hand out
+ *  Return Value: The pool index of the first node of the range
+ */
+unsigned int TrieNodePool::allocateRange(unsigned int n) {
+    unsigned int first = count.fetch_add(n, std::memory_order_relaxed);
+    /** Open every slab touched by the range before any thread writes */
+    for( unsigned int slab = first >> SLAB_SHIFT;
+            n > 0 && slab <= (first + n - 1) >> SLAB_SHIFT; slab++) {
+        openSlab(slab);
+    }
+    return first;
+}
+
+/** Function Name: size() const
+ *  Description: Number of nodes handed out by allocate, released ones
+ *               included, so indices run from 1 to size()
+ *  Return Value: The number of allocated nodes
+ */
+unsigned int TrieNodePool::size() const {
+    /** The reserved node is not a node of the Trie */
+    return count.load(std::memory_order_relaxed) - 1;
+}
+
+/** Function Name: released() const
+ *  Description: Number of released nodes not handed out again yet
+ *  Return Value: The number of nodes on the free list
+ */
+unsigned int TrieNodePool::released() const {
+    return freeCount.load(std::memory_order_relaxed);
+}
+
+/** Function Name: bytes() const
+ *  Description: Memory reserved by the pool for its opened slabs and the
+ *               slots of the slab table up to the last one
+ *  Return Value: The number of bytes held by the pool
+ */
+size_t TrieNodePool::bytes() const {
+    unsigned int limit = slabLimit.load(std::memory_order_relaxed);
+    size_t opened = 0;
+    for( unsigned int i = 0; i < limit; i++) {
+        if( slabs[i].load(std::memory_order_relaxed) != nullptr) {
+            opened++;
+        }
+    }
+    return opened * SLAB_SIZE * sizeof(TrieNode) +
+        limit * sizeof(std::atomic<TrieNode *>);
+}
+
+/** Function Name: clear()
+ *  Description: Releases every slab and resets the pool to empty
+ */
+void TrieNodePool::clear() {
+    /** TrieNode is trivially destructible, so only the slabs are freed */
+    unsigned int limit = slabLimit.load(std::memory_order_relaxed);
+    for( unsigned int i = 0; i < limit; i++) {
+        ::operator delete(slabs[i].load(std::memory_order_relaxed));
+        slabs[i].store(nullptr, std::memory_order_relaxed);
+    }
+    slabLimit.store(0, std::memory_order_relaxed);
+    count.store(NULL_NODE + 1, std::memory_order_relaxed);
+    freeHead.store(NULL_NODE, std::memory_order_relaxed);
+    freeCount.store(0, std::memory_order_relaxed);
+}
+
+/** Destructor
+ *  Description: Releases every slab of the pool
+ */
+TrieNodePool::~TrieNodePool() {
+    unsigned int limit = slabLimit.load(std::memory_order_relaxed);
+    for( unsigned int i = 0; i < limit; i++) {
+        ::operator delete(slabs[i].load(std::memory_order_relaxed));
+    }
+    free(slabs);
 }
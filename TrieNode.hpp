@@ -1,45 +1,194 @@
 /** Filename: TrieNode.hpp
  *  Name: Loc Chuong
  *  Userid: cs100sp19aj
- *  Description: Defines a TrieNode object used to create the Trie.
+ *  Description: Defines a TrieNode object used to create the Trie and the
+ *               TrieNodePool arena that owns every node of a Trie.
  *  Date: 4/29/2019
  */
 #ifndef TRIE_NODE_HPP
 #define TRIE_NODE_HPP
 
+#include <atomic>
+#include <memory>
 #include <vector>
 #include <string>
 #include <queue>
+#define NULL_NODE 0U /** Pool index that stands for a missing child */
+#define NO_WORD (-1) /** freq of a node that ends no word */
+#define SLAB_SHIFT 16 /** log2 of the number of nodes held by one slab */
+#define SLAB_SIZE (1U << SLAB_SHIFT) /** Number of nodes held by one slab */
+#define SLAB_MASK (SLAB_SIZE - 1U) /** Mask for node offset inside a slab */
+#define MAX_SLABS (1U << (32 - SLAB_SHIFT)) /** Slabs addressable by index */
+#define MAX_LENGTH_BOUND 255 /** Word length bounds saturate at this value */
+#define FREE_TAG_SHIFT 32 /** Bits of the free list head below its tag */
 
 using namespace std;
 /** Class Name: TrieNode
  *  Description: Class that defines a TrieNode with certain char data and
- *               pointers to its children(left, right, and down). Used to
- *               create a Ternary Trie.
+ *               indices of its children(left, right, and down) inside the
+ *               TrieNodePool that owns it. Used to create a Ternary Trie.
+ *               Links and frequencies are atomic so writers can link new
+ *               nodes and update frequencies while readers walk the Trie. A
+ *               child link only ever changes from NULL_NODE to a node that
+ *               is fully built, and data never changes once linked.
  */
 class TrieNode {
-    
+
     public:
-    
-        TrieNode * left; /** Pointer to left child */
-        TrieNode * right; /** Pointer to right child */
-        TrieNode * down; /** Pointer to child directly below it */
+
+        std::atomic<unsigned int> left; /** Pool index of left child */
+        std::atomic<unsigned int> right; /** Pool index of right child */
+        std::atomic<unsigned int> down; /** Pool index of child below it */
+        std::atomic<int> freq; /** Frequency of the word ending here, NO_WORD
+                                *  if no word ends here */
+        std::atomic<int> maxFreq; /** Highest word frequency in this node's
+                                   *  subtree, never below the real one */
         char data; /** Data held by TrieNode */
-        bool word; /** True if this creates a word, false otherwise */
-        int freq; /** 0 if word is false, otherwise the frequency of word */
-                            
+        std::atomic<unsigned char> minLength; /** Fewest chars from this
+                                               *  node's on to the end of a
+                                               *  word in its subtree,
+                                               *  MAX_LENGTH_BOUND if none */
+        std::atomic<unsigned char> maxLength; /** Most such chars, where
+                                               *  MAX_LENGTH_BOUND stands for
+                                               *  that many or more */
+
 
         /** Default Constructor
          *  Description: Creates a node with instance variables of zero-like
-         *               value
+         *               value that ends no word
          */
         TrieNode();
 
         /** Constructor
-         *  Description: Creates a TrieNode with data and bool word false
+         *  Description: Creates a TrieNode with data that ends no word
          *  Parameters: data - The data for the TrieNode to hold
          */
         TrieNode(char data);
 };
 
+/** Class Name: TrieNodePool
+ *  Description: Slab allocator that owns all the TrieNodes of one Trie. Nodes
+ *               are carved out of fixed size slabs that never move, so a
+ *               node is addressed by a 32 bit index and references to nodes
+ *               stay valid while the pool grows. Index NULL_NODE is reserved
+ *               so that a zero child index means "no child". Releasing the
+ *               pool frees whole slabs instead of visiting every node. An
+ *               empty pool opens no slab, and its slab table takes memory
+ *               only as slabs are opened.
+ *               allocate and operator[] may be called from any number of
+ *               threads at once; the slab table has a fixed slot for every
+ *               slab, so it never moves either. A node that was never
+ *               linked can be released, it is kept on a free list and
+ *               handed out again by the next allocate.
+ */
+class TrieNodePool {
+
+    public:
+
+        /** Constructor
+         *  Description: Creates an empty pool, the reserved node is built
+         *               with the first slab
+         */
+        TrieNodePool();
+
+        /** The pool owns its slabs, so it cannot be copied */
+        TrieNodePool(const TrieNodePool &) = delete;
+        TrieNodePool & operator=(const TrieNodePool &) = delete;
+
+        /** Function Name: allocate(char data)
+         *  Description: Reuses a released node if there is one, else carves
+         *               a new node out of the current slab, opening a new
+         *               slab when the current one is full. Lock-free,
+         *               concurrent callers get distinct nodes.
+         *  Parameters: data - The data for the new TrieNode to hold
+         *  Return Value: The pool index of the new node
+         */
+        unsigned int allocate(char data);
+
+        /** Function Name: release(unsigned int index)
+         *  Description: Puts a node back for allocate to hand out again.
+         *               Lock-free. The node must not be reachable from any
+         *               Trie, as a node built for a lost CAS is not.
+         *  Parameters: index - Pool index of the node to release
+         */
+        void release(unsigned int index);
+
+        /** Function Name: allocateRange(unsigned int n)
+         *  Description: Hands out n consecutive indices at once, opening as
+         *               many slabs as needed. The nodes are not constructed,
+         *               the caller constructs every one of them in place,
+         *               which lets threads fill disjoint ranges concurrently.
+         *  Parameters: n - The number of indices to hand out
+         *  Return Value: The pool index of the first node of the range
+         */
+        unsigned int allocateRange(unsigned int n);
+
+        /** Function Name: operator[](unsigned int index)
+         *  Description: Access the node stored at index
+         *  Parameters: index - Pool index returned by allocate
+         *  Return Value: A reference to the node
+         */
+        TrieNode & operator[](unsigned int index) {
+            /** Relaxed, whoever learnt the index also saw its slab opened */
+            return slabs[index >> SLAB_SHIFT].load(
+                    std::memory_order_relaxed)[index & SLAB_MASK];
+        }
+        const TrieNode & operator[](unsigned int index) const {
+            return slabs[index >> SLAB_SHIFT].load(
+                    std::memory_order_relaxed)[index & SLAB_MASK];
+        }
+
+        /** Function Name: size() const
+         *  Description: Number of nodes handed out by allocate, released
+         *               ones included, so indices run from 1 to size()
+         *  Return Value: The number of allocated nodes
+         */
+        unsigned int size() const;
+
+        /** Function Name: released() const
+         *  Description: Number of released nodes not handed out again yet
+         *  Return Value: The number of nodes on the free list
+         */
+        unsigned int released() const;
+
+        /** Function Name: bytes() const
+         *  Description: Memory reserved by the pool for its opened slabs
+         *               and the slots of the slab table up to the last one
+         *  Return Value: The number of bytes held by the pool
+         */
+        size_t bytes() const;
+
+        /** Function Name: clear()
+         *  Description: Releases every slab and resets the pool to empty
+         */
+        void clear();
+
+        /** Destructor
+         *  Description: Releases every slab of the pool
+         */
+        ~TrieNodePool();
+
+    private:
+
+        /** MAX_SLABS slots for slabs holding SLAB_SIZE nodes, nullptr until
+         *  the slab is opened */
+        std::atomic<TrieNode *> * slabs;
+        std::atomic<unsigned int> slabLimit; /** Slots up to the last opened
+                                              *  slab, none opened past it */
+        std::atomic<unsigned int> count; /** Next free index, also counts
+                                          *  the reserved node */
+        std::atomic<unsigned long long> freeHead; /** Top released node in
+                                                   *  the low bits, a tag
+                                                   *  bumped by every reuse
+                                                   *  above them */
+        std::atomic<unsigned int> freeCount; /** Nodes on the free list */
+
+        /** Function Name: openSlab(unsigned int slab)
+         *  Description: Returns slab, opening it if no thread did yet
+         *  Parameters: slab - The slot of the slab in slabs
+         *  Return Value: The first node of the slab
+         */
+        TrieNode * openSlab(unsigned int slab);
+};
+
 #endif
@@ -0,0 +1,386 @@
+/** Filename: UrlPipeline.cpp
+ *  Name: Loc Chuong
+ *  Userid: cs100sp19aj
+ *  Description: Streams a file of urls through a filter in large chunks: a
+ *               reader thread, a set of worker threads probing the filter
+ *               and a writer keeping the surviving urls in input order.
+ *  Date: 5/2/2019
+ */
+
+#include "UrlPipeline.hpp"
+#include <algorithm>
+#include <chrono>
+#include <condition_variable>
+#include <deque>
+#include <fstream>
+#include <mutex>
+#include <string.h>
+#include <thread>
+#define CHUNKS_PER_WORKER 2 /** Chunks in flight for each worker thread */
+#define WORD_BITS 64 /** Results held by one word of a probe's bitmap */
+
+/** Struct PipelineChunk
+ *  Description: One chunk of lines on its way through the pipeline, reused
+ *               for every CHUNKS_PER_WORKER * numThreads th chunk
+ */
+struct PipelineChunk {
+    std::string text; /** Whole lines read */
+    std::vector<std::string_view> lines; /** Views of the lines of text */
+    std::string output; /** Lines not found, each with a line break */
+    size_t linesRead; /** Number of lines of text */
+    size_t linesKept; /** Number of lines in output */
+    bool processed; /** True once a worker filled output */
+};
+
+/** Struct PipelineState
+ *  Description: State of one run shared by the reader, the workers and the
+ *               writer. Chunk i lives in chunks[i % chunks.size()]; the
+ *               reader fills it only once the writer is done with chunk
+ *               i - chunks.size().
+ */
+struct PipelineState {
+    std::vector<PipelineChunk> chunks; /** Ring of chunks in flight */
+    std::deque<size_t> work; /** Chunks read and not yet taken */
+    size_t read; /** Number of chunks read */
+    size_t written; /** Number of chunks written */
+    bool finished; /** True once the reader hit the end of the input */
+    std::mutex lock; /** Guards every field above but the chunks taken */
+    std::condition_variable workReady; /** Signals a chunk read or the end */
+    std::condition_variable chunkDone; /** Signals a chunk processed or the
+                                        *  end */
+    std::condition_variable slotFree; /** Signals a chunk written */
+};
+
+/** Constructor
+ *  Description: Sets up a pipeline, starting no thread yet
+ *  Parameters: num_threads - Number of worker threads, at least 1
+ */
+UrlPipeline::UrlPipeline(unsigned int num_threads) :
+        numThreads(num_threads > 0 ? num_threads : 1) {}
+
+/** Function Name: run(std::istream & in, std::ostream & out,
+ *                      const Probe & probe)
+ *  Description: Writes every line of in that probe does not find to out,
+ *               each followed by a line break, in the order they are read.
+ *               The calling thread is the writer, waiting for the chunks in
+ *               order while later ones are read and probed.
+ *  Parameters: in - The urls to filter, one per line
+ *              out - Where the urls not found are written
+ *              probe - The lookup of a block of urls
+ *  Return Value: The numbers of lines read and written, bytes read and the
+ *                time taken
+ */
+PipelineStats UrlPipeline::run(std::istream & in, std::ostream & out,
+        const Probe & probe) {
+    chrono::steady_clock::time_point start = chrono::steady_clock::now();
+    PipelineStats stats = {0, 0, 0, 0};
+    PipelineState state;
+    state.chunks.resize(CHUNKS_PER_WORKER * numThreads);
+    state.read = 0;
+    state.written = 0;
+    state.finished = false;
+    size_t ring = state.chunks.size();
+
+    std::thread reader([&]() {
+        std::string carry;
+        while( true) {
+            {
+                std::unique_lock<std::mutex> guard(state.lock);
+                state.slotFree.wait(guard, [&]() {
+                    return state.read < state.written + ring; });
+            }
+            /** The writer is done with this slot, it is filled unlocked */
+            PipelineChunk & chunk = state.chunks[state.read % ring];
+            if( !readChunk(in, chunk.text, carry)) {
+                break;
+            }
+            chunk.processed = false;
+            std::lock_guard<std::mutex> guard(state.lock);
+            state.work.push_back(state.read++);
+            state.workReady.notify_one();
+        }
+        std::lock_guard<std::mutex> guard(state.lock);
+        state.finished = true;
+        state.workReady.notify_all();
+        state.chunkDone.notify_all();
+    });
+
+    std::vector<std::thread> workers;
+    for( unsigned int t = 0; t < numThreads; t++) {
+        workers.push_back(std::thread([&]() {
+            while( true) {
+                size_t index;
+                {
+                    std::unique_lock<std::mutex> guard(state.lock);
+                    state.workReady.wait(guard, [&]() {
+                        return !state.work.empty() || state.finished; });
+                    if( state.work.empty()) {
+                        return;
+                    }
+                    index = state.work.front();
+                    state.work.pop_front();
+                }
+                PipelineChunk & chunk = state.chunks[index % ring];
+                splitLines(chunk.text, chunk.lines);
+                std::vector<uint64_t> found = probe(chunk.lines);
+                chunk.output.clear();
+                chunk.linesRead = chunk.lines.size();
+                chunk.linesKept = 0;
+                for( size_t j = 0; j < chunk.lines.size(); j++) {
+                    if( !((found[j / WORD_BITS] >> j % WORD_BITS) & 1)) {
+                        chunk.output.append(chunk.lines[j]);
+                        chunk.output.push_back('\n');
+                        chunk.linesKept++;
+                    }
+                }
+                std::lock_guard<std::mutex> guard(state.lock);
+                chunk.processed = true;
+                state.chunkDone.notify_all();
+            }
+        }));
+    }
+
+    /** Write the chunks in the order they were read */
+    while( true) {
+        PipelineChunk * chunk;
+        {
+            std::unique_lock<std::mutex> guard(state.lock);
+            state.chunkDone.wait(guard, [&]() {
+                return (state.written < state.read &&
+                        state.chunks[state.written % ring].processed) ||
+                    (state.finished && state.written == state.read); });
+            if( state.written == state.read) {
+                break;
+            }
+            chunk = &state.chunks[state.written % ring];
+        }
+        out.write(chunk->output.data(), chunk->output.size());
+        stats.lines += chunk->linesRead;
+        stats.kept += chunk->linesKept;
+        stats.bytes += chunk->text.size();
+        std::lock_guard<std::mutex> guard(state.lock);
+        state.written++;
+        state.slotFree.notify_one();
+    }
+    reader.join();
+    for( unsigned int t = 0; t < workers.size(); t++) {
+        workers[t].join();
+    }
+    out.flush();
+    stats.seconds = chrono::duration<double>(chrono::steady_clock::now() -
+            start).count();
+    return stats;
+}
+
+/** Function Name: forEachLine(std::istream & in,
+ *                      const std::function<void(std::string_view)> & visit)
+ *  Description: Reads in once, CHUNK_BYTES at a time, and calls visit on
+ *               each line without its line break
+ *  Parameters: in - The lines to read
+ *              visit - Called with every line in order
+ *  Return Value: The number of lines read
+ */
+size_t UrlPipeline::forEachLine(std::istream & in,
+        const std::function<void(std::string_view)> & visit) {
+    std::string text;
+    std::string carry;
+    std::vector<std::string_view> lines;
+    size_t count = 0;
+    while( readChunk(in, text, carry)) {
+        splitLines(text, lines);
+        for( size_t j = 0; j < lines.size(); j++) {
+            visit(lines[j]);
+        }
+        count += lines.size();
+    }
+    return count;
+}
+
+/** Function Name: forEachLineParallel(const std::string & filename,
+ *                      unsigned int num_threads,
+ *                      const std::function<void(std::string_view)> & visit)
+ *  Description: forEachLine over a file split into num_threads ranges of
+ *               about equal bytes, each read by its own thread with its own
+ *               stream. A range boundary is moved up past the next line
+ *               break, so every line is read by exactly one thread.
+ *  Parameters: filename - The file of lines to read
+ *              num_threads - Number of threads and ranges
+ *              visit - Called with every line, safe to call from several
+ *                      threads at once
+ *  Return Value: The number of lines read
+ */
+size_t UrlPipeline::forEachLineParallel(const std::string & filename,
+        unsigned int num_threads,
+        const std::function<void(std::string_view)> & visit) {
+    std::ifstream file(filename, ios::binary);
+    file.seekg(0, ios::end);
+    std::streamoff size = file.tellg();
+    if( num_threads < 2 || size <= 0) {
+        file.clear();
+        file.seekg(0, ios::beg);
+        return forEachLine(file, visit);
+    }
+    /** Range t is [bounds[t], bounds[t + 1]) */
+    std::vector<std::streamoff> bounds(num_threads + 1, size);
+    bounds[0] = 0;
+    for( unsigned int t = 1; t < num_threads; t++) {
+        std::streamoff bound = max(size * t / num_threads, bounds[t - 1]);
+        if( bound > 0 && bound < size) {
+            /** Past the line break ending the line that holds bound - 1 */
+            file.clear();
+            file.seekg(bound - 1);
+            std::string rest;
+            std::getline(file, rest);
+            bound = file.eof() ? size : bound + rest.size();
+        }
+        bounds[t] = bound;
+    }
+    std::vector<size_t> counts(num_threads, 0);
+    std::vector<std::thread> readers;
+    for( unsigned int t = 0; t < num_threads; t++) {
+        readers.push_back(std::thread([&, t]() {
+            std::ifstream range(filename, ios::binary);
+            counts[t] = forEachLineInRange(range, bounds[t], bounds[t + 1],
+                    visit);
+        }));
+    }
+    size_t count = 0;
+    for( unsigned int t = 0; t < num_threads; t++) {
+        readers[t].join();
+        count += counts[t];
+    }
+    return count;
+}
+
+/** Function Name: estimateLines(std::istream & in)
+ *  Description: Estimates the lines of a seekable stream from its size and
+ *               the line length of its first SAMPLE_BYTES, exact when it is
+ *               no longer than that. The stream is left at its start.
+ *  Parameters: in - The stream to size
+ *  Return Value: The estimated number of lines, 0 if in cannot seek
+ */
+size_t UrlPipeline::estimateLines(std::istream & in) {
+    in.seekg(0, ios::end);
+    std::streamoff size = in.tellg();
+    in.seekg(0, ios::beg);
+    if( size <= 0) {
+        in.clear();
+        in.seekg(0, ios::beg);
+        return 0;
+    }
+    std::string sample(std::min((std::streamoff) SAMPLE_BYTES, size), '\0');
+    in.read(&sample[0], sample.size());
+    sample.resize(in.gcount());
+    in.clear();
+    in.seekg(0, ios::beg);
+    size_t breaks = std::count(sample.begin(), sample.end(), '\n');
+    if( (std::streamoff) sample.size() == size) {
+        /** The whole file, a last line may lack its line break */
+        return breaks + (!sample.empty() && sample.back() != '\n');
+    }
+    if( breaks == 0) {
+        return 1;
+    }
+    /** Lines of the sample scaled to the file, rounded up */
+    return (size * breaks + sample.size() - 1) / sample.size();
+}
+
+/** Function Name: readChunk(std::istream & in, std::string & text,
+ *                      std::string & carry)
+ *  Description: Reads the next chunk, the partial line left by the last one
+ *               followed by up to CHUNK_BYTES more, and cuts it after its
+ *               last line break. The rest is kept for the next chunk, or
+ *               left in the chunk at the end of the stream. A line longer
+ *               than CHUNK_BYTES makes the chunk grow until it ends.
+ *  Parameters: in - The stream to read
+ *              text - Set to the whole lines of the chunk
+ *              carry - The partial line before and after
+ *  Return Value: False once the stream is exhausted and text empty
+ */
+bool UrlPipeline::readChunk(std::istream & in, std::string & text,
+        std::string & carry) {
+    /** Copied rather than moved so text keeps its capacity */
+    text.assign(carry);
+    carry.clear();
+    while( in) {
+        size_t old = text.size();
+        text.resize(old + CHUNK_BYTES);
+        in.read(&text[old], CHUNK_BYTES);
+        text.resize(old + in.gcount());
+        size_t end = text.rfind('\n');
+        if( end != std::string::npos) {
+            carry.assign(text, end + 1, std::string::npos);
+            text.resize(end + 1);
+            return true;
+        }
+    }
+    return !text.empty();
+}
+
+/** Function Name: forEachLineInRange(std::istream & in,
+ *                      std::streamoff begin, std::streamoff end,
+ *                      const std::function<void(std::string_view)> & visit)
+ *  Description: forEachLine over the bytes [begin, end) of in, which start
+ *               a line and end one or the stream. Reads CHUNK_BYTES at a
+ *               time, keeping the partial line at the end of each chunk
+ *               for the next.
+ *  Parameters: in - The stream to read
+ *              begin - Offset of the first byte
+ *              end - Offset past the last byte
+ *              visit - Called with every line in order
+ *  Return Value: The number of lines read
+ */
+size_t UrlPipeline::forEachLineInRange(std::istream & in,
+        std::streamoff begin, std::streamoff end,
+        const std::function<void(std::string_view)> & visit) {
+    std::string text;
+    std::vector<std::string_view> lines;
+    size_t count = 0;
+    in.seekg(begin);
+    std::streamoff left = end - begin;
+    while( left > 0 && in) {
+        size_t old = text.size();
+        size_t want = min((std::streamoff) CHUNK_BYTES, left);
+        text.resize(old + want);
+        in.read(&text[old], want);
+        text.resize(old + in.gcount());
+        left -= in.gcount();
+        /** The whole lines, or everything once the range is read */
+        size_t cut = left > 0 && in ? text.rfind('\n') + 1 : text.size();
+        if( cut == 0) {
+            continue;
+        }
+        splitLines(std::string_view(text).substr(0, cut), lines);
+        for( size_t j = 0; j < lines.size(); j++) {
+            visit(lines[j]);
+        }
+        count += lines.size();
+        text.erase(0, cut);
+    }
+    return count;
+}
+
+/** Function Name: splitLines(std::string_view text,
+ *                      std::vector<std::string_view> & lines)
+ *  Description: Lines of a chunk, without their line breaks. A last line
+ *               without a line break counts, an empty one does not, as with
+ *               getline.
+ *  Parameters: text - The chunk
+ *              lines - Set to a view of every line of text
+ */
+void UrlPipeline::splitLines(std::string_view text,
+        std::vector<std::string_view> & lines) {
+    lines.clear();
+    const char * begin = text.data();
+    const char * end = begin + text.size();
+    while( begin < end) {
+        const char * lineEnd = (const char *) memchr(begin, '\n',
+                end - begin);
+        if( lineEnd == nullptr) {
+            lines.push_back(std::string_view(begin, end - begin));
+            break;
+        }
+        lines.push_back(std::string_view(begin, lineEnd - begin));
+        begin = lineEnd + 1;
+    }
+}
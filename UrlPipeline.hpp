@@ -0,0 +1,163 @@
+/** Filename: UrlPipeline.hpp
+ *  Name: Loc Chuong
+ *  Userid: cs100sp19aj
+ *  Description: Streams a file of urls through a filter in large chunks: a
+ *               reader thread, a set of worker threads probing the filter
+ *               and a writer keeping the surviving urls in input order.
+ *  Date: 5/2/2019
+ */
+
+#ifndef URL_PIPELINE_HPP
+#define URL_PIPELINE_HPP
+
+#include <cstdint>
+#include <functional>
+#include <iostream>
+#include <string>
+#include <string_view>
+#include <vector>
+#define CHUNK_BYTES (4 << 20) /** Bytes read into one chunk of lines */
+#define SAMPLE_BYTES (64 << 10) /** Bytes read to estimate the lines of a
+                                 *  file */
+
+using namespace std;
+
+/** Struct PipelineStats
+ *  Description: Totals of one run of the pipeline
+ */
+struct PipelineStats {
+    size_t lines; /** Urls read */
+    size_t kept; /** Urls written, those the filter did not find */
+    size_t bytes; /** Bytes read */
+    double seconds; /** Time from the first read to the last write */
+};
+
+/** Class Name: UrlPipeline
+ *  Description: Filters a stream of urls, one per line, with a pool of
+ *               worker threads. A reader thread cuts the input into chunks
+ *               of CHUNK_BYTES ending on a line break; each worker takes a
+ *               chunk, splits it into lines, looks them all up with one
+ *               probe call and gathers the lines not found into one output
+ *               buffer; the calling thread writes the buffers in the order
+ *               of their chunks with one write each. At most two chunks per
+ *               worker are in flight, so memory stays bounded whatever the
+ *               size of the input. The probe must be safe to call from
+ *               several threads at once, as findBatch of a filter no longer
+ *               being inserted into is.
+ */
+class UrlPipeline
+{
+    public:
+
+        /** Type of the lookup of a block of urls, returning a bitmap with
+         *  bit j % 64 of word j / 64 set if url j is found */
+        typedef std::function<std::vector<uint64_t>(
+                const std::vector<std::string_view> &)> Probe;
+
+        /** Constructor
+         *  Description: Sets up a pipeline, starting no thread yet
+         *  Parameters: num_threads - Number of worker threads, at least 1
+         */
+        UrlPipeline(unsigned int num_threads);
+
+        /** Function Name: run(std::istream & in, std::ostream & out,
+         *                      const Probe & probe)
+         *  Description: Writes every line of in that probe does not find to
+         *               out, each followed by a line break, in the order
+         *               they are read
+         *  Parameters: in - The urls to filter, one per line
+         *              out - Where the urls not found are written
+         *              probe - The lookup of a block of urls
+         *  Return Value: The numbers of lines read and written, bytes read
+         *                and the time taken
+         */
+        PipelineStats run(std::istream & in, std::ostream & out,
+                const Probe & probe);
+
+        /** Function Name: forEachLine(std::istream & in,
+         *                      const std::function<void(std::string_view)> &
+         *                      visit)
+         *  Description: Reads in once, CHUNK_BYTES at a time, and calls
+         *               visit on each line without its line break
+         *  Parameters: in - The lines to read
+         *              visit - Called with every line in order
+         *  Return Value: The number of lines read
+         */
+        static size_t forEachLine(std::istream & in,
+                const std::function<void(std::string_view)> & visit);
+
+        /** Function Name: forEachLineParallel(const std::string & filename,
+         *                      unsigned int num_threads,
+         *                      const std::function<void(std::string_view)> &
+         *                      visit)
+         *  Description: forEachLine over a file split into num_threads
+         *               ranges of about equal bytes, each moved up to the
+         *               start of a line and read by its own thread with its
+         *               own stream. visit is called from every thread at
+         *               once, in no particular order across ranges.
+         *  Parameters: filename - The file of lines to read
+         *              num_threads - Number of threads and ranges
+         *              visit - Called with every line, safe to call from
+         *                      several threads at once
+         *  Return Value: The number of lines read
+         */
+        static size_t forEachLineParallel(const std::string & filename,
+                unsigned int num_threads,
+                const std::function<void(std::string_view)> & visit);
+
+        /** Function Name: estimateLines(std::istream & in)
+         *  Description: Estimates the lines of a seekable stream from its
+         *               size and the line length of its first SAMPLE_BYTES,
+         *               exact when it is no longer than that. The stream is
+         *               left at its start.
+         *  Parameters: in - The stream to size
+         *  Return Value: The estimated number of lines, 0 if in cannot seek
+         */
+        static size_t estimateLines(std::istream & in);
+
+    private:
+
+        unsigned int numThreads; /** Worker threads of a run */
+
+        /** Function Name: readChunk(std::istream & in, std::string & text,
+         *                      std::string & carry)
+         *  Description: Reads the next chunk, the partial line left by the
+         *               last one followed by up to CHUNK_BYTES more, and
+         *               cuts it after its last line break. The rest is kept
+         *               for the next chunk, or left in the chunk at the end
+         *               of the stream.
+         *  Parameters: in - The stream to read
+         *              text - Set to the whole lines of the chunk
+         *              carry - The partial line before and after
+         *  Return Value: False once the stream is exhausted and text empty
+         */
+        static bool readChunk(std::istream & in, std::string & text,
+                std::string & carry);
+
+        /** Function Name: forEachLineInRange(std::istream & in,
+         *                      std::streamoff begin, std::streamoff end,
+         *                      const std::function<void(std::string_view)> &
+         *                      visit)
+         *  Description: forEachLine over the bytes [begin, end) of in,
+         *               which start a line and end one or the stream
+         *  Parameters: in - The stream to read
+         *              begin - Offset of the first byte
+         *              end - Offset past the last byte
+         *              visit - Called with every line in order
+         *  Return Value: The number of lines read
+         */
+        static size_t forEachLineInRange(std::istream & in,
+                std::streamoff begin, std::streamoff end,
+                const std::function<void(std::string_view)> & visit);
+
+        /** Function Name: splitLines(std::string_view text,
+         *                      std::vector<std::string_view> & lines)
+         *  Description: Lines of a chunk, without their line breaks
+         *  Parameters: text - The chunk
+         *              lines - Set to a view of every line of text
+         */
+        static void splitLines(std::string_view text,
+                std::vector<std::string_view> & lines);
+};
+
+#endif // URL_PIPELINE_HPP
@@ -8,6 +8,9 @@
  */
 
 #include "DictionaryTrie.hpp"
+#include "DictionaryHandle.hpp"
+#include "FrozenDictionaryTrie.hpp"
+#include "RadixDictionaryTrie.hpp"
 #include "util.hpp"
 #include <iostream>
 #include <fstream>
@@ -15,38 +18,44 @@
 #include <string>
 #define FILE_ARG 1
 #define MAX_ARG 2
+#define RADIX_FLAG "--radix" /** Before the file, selects the radix tree */
 #define NULLCHAR '\0'
 #define CONTINUE "y"
 
 using namespace std;
 
-/** Function Name: main(int argc, char** argv)
- *  Description: This is the driver of the program that will ask users for
- *               input and uses their one file argument as the basis for the
- *               TST.
- *  Parameters: argc - Number of arguments passed in by the user
- *              argv - Pointer to the actual arguments passed in by user
+/** Function Name: refresh(Dictionary & dict, const char * filename)
+ *  Description: A mapped image or a radix tree is never reloaded
  */
-int main(int argc, char** argv) {
-    /** Check for correct number of arguments */
-    if( argc != MAX_ARG) {
-        cout << "This program needs exactly one argument!" << endl;
-        return -1;
-    }
-    /** Read in file */
-    ifstream readFile(argv[FILE_ARG], ios::in);
-    /** Checks for invalid file */
-    if( !readFile) {
-        cout << "Could not open file or invalid file" << endl;
-        return -1;
+template <class Dictionary>
+void refresh(Dictionary &, const char *) {}
+
+/** Function Name: refresh(DictionaryHandle & dict, const char * filename)
+ *  Description: Rebuilds the dictionary in the background when its file was
+ *               rewritten; queries keep using the old one until it is ready
+ *  Parameters: dict - Handle to the dictionary built from filename
+ *              filename - The dictionary file
+ */
+void refresh(DictionaryHandle & dict, const char * filename) {
+    if( dict.reloadIfChanged(filename)) {
+        cout << "Reloading file: " << filename << endl;
     }
-    /** Create Trie to hold insertions */
-    DictionaryTrie * DT = new DictionaryTrie();
-    cout << "Reading file: " << argv[FILE_ARG] << endl;
-    /** Popualte DictionaryTrie using helper function from Util */
-    Utils::load_dict(*DT, readFile);
+}
+
+/** Function Name: promptQueries(Dictionary & dict, const char * filename)
+ *  Description: Keeps asking the user for a prefix/pattern and a number of
+ *               completions and prints the predictions of dict, until the
+ *               user chooses to stop.
+ *  Parameters: dict - DictionaryHandle, FrozenDictionaryTrie or
+ *                     RadixDictionaryTrie to search
+ *              filename - The file dict was read from
+ */
+template <class Dictionary>
+void promptQueries(Dictionary & dict, const char * filename) {
     /** Keep checking for user input until user exits via input */
     while(1) {
+        /** Pick up a dictionary file rewritten since the last query */
+        refresh(dict, filename);
         /** Holds prefix or pattern to search for */
         string search;
         /** Holds number of completions */
@@ -61,23 +70,33 @@ int main(int argc, char** argv) {
         unsigned int completions = stoul(num_completions);
         /** Create variable to hold occurances of underscore in user input */
         unsigned int underScore = 0;
-        /** Search the prefix/pattern for underscore characters */
+        /** Create variable to hold occurances of star in user input */
+        unsigned int star = 0;
+        /** Search the prefix/pattern for wildcard characters */
         for( string::iterator it = search.begin(); it != search.end(); it++) {
             if(*it == UNDERSCORE) {
                 underScore++;
             }
+            else if(*it == STAR) {
+                star++;
+            }
         }
         /** Create return vector of strings for completions or underscore */
         std::vector<std::string> str;
-        /** No underscore characters in prefix/pattern to search for */
-        if( underScore == 0) { 
+        /** No wildcard characters in prefix/pattern to search for */
+        if( underScore == 0 && star == 0) { 
             /** Find predictions where search is a prefix */
-            str = DT->predictCompletions(search, completions);
+            str = dict.predictCompletions(search, completions);
         }
         /** One underscore characters in prefix/pattern to search for */
-        else if( underScore == 1) {
+        else if( underScore == 1 && star == 0) {
             /** Find predictions where search is a pattern */
-            str = DT->predictUnderscore(search, completions);
+            str = dict.predictUnderscore(search, completions);
+        }
+        /** Several underscores or any star in pattern to search for */
+        else {
+            /** Find predictions matching the general pattern */
+            str = dict.predictPattern(search, completions);
         }
         /** Print out results of predictions to user */
         for( unsigned int i = 0; i < str.size(); i++) {
@@ -88,11 +107,67 @@ int main(int argc, char** argv) {
         getline(cin, cont);
         /** Exit program if user does not input "y" when asked */ 
         if( cont.compare(CONTINUE) != 0) {
-            /** Delete the DictionaryTrie */
-            delete DT;
-            /** Return program ended successfully */
-            return 0;
+            return;
         }
     }
 
 }
+
+/** Function Name: main(int argc, char** argv)
+ *  Description: This is the driver of the program that will ask users for
+ *               input and uses their one file argument as the basis for the
+ *               TST. The argument is either a dictionary file or an image
+ *               written by compiletrie. A dictionary file after RADIX_FLAG
+ *               is loaded into the adaptive radix tree engine instead.
+ *  Parameters: argc - Number of arguments passed in by the user
+ *              argv - Pointer to the actual arguments passed in by user
+ */
+int main(int argc, char** argv) {
+    /** The radix tree engine answers the same queries as the TST */
+    if( argc == MAX_ARG + 1 && string(argv[FILE_ARG]) == RADIX_FLAG) {
+        ifstream in(argv[FILE_ARG + 1], ios::binary);
+        if( !in) {
+            cout << "Could not open file or invalid file" << endl;
+            return -1;
+        }
+        RadixDictionaryTrie * RDT = new RadixDictionaryTrie();
+        cout << "Reading file: " << argv[FILE_ARG + 1] << endl;
+        Utils::load_dict(*RDT, in);
+        promptQueries(*RDT, argv[FILE_ARG + 1]);
+        delete RDT;
+        return 0;
+    }
+    /** Check for correct number of arguments */
+    if( argc != MAX_ARG) {
+        cout << "This program needs exactly one argument!" << endl;
+        return -1;
+    }
+    /** A compiled image is mapped instead of parsed */
+    if( FrozenDictionaryTrie::isImage(argv[FILE_ARG])) {
+        FrozenDictionaryTrie * FDT = new FrozenDictionaryTrie();
+        cout << "Mapping image: " << argv[FILE_ARG] << endl;
+        if( !FDT->open(argv[FILE_ARG])) {
+            cout << "Could not open file or invalid file" << endl;
+            delete FDT;
+            return -1;
+        }
+        promptQueries(*FDT, argv[FILE_ARG]);
+        /** Unmap the image */
+        delete FDT;
+        return 0;
+    }
+    /** Create handle to the Trie, so it can be rebuilt while in use */
+    DictionaryHandle * DH = new DictionaryHandle();
+    cout << "Reading file: " << argv[FILE_ARG] << endl;
+    /** Populate the Trie and its completion cache, then publish it */
+    if( !DH->reload(argv[FILE_ARG])) {
+        cout << "Could not open file or invalid file" << endl;
+        delete DH;
+        return -1;
+    }
+    promptQueries(*DH, argv[FILE_ARG]);
+    /** Delete the DictionaryHandle and every Trie it built */
+    delete DH;
+    /** Return program ended successfully */
+    return 0;
+}
@@ -0,0 +1,248 @@
+/** Filename: benchbloom.cpp
+ *  Name: Loc Chuong
+ *  Userid: cs100sp19aj
+ *  Description: Compares the lookup throughput and false positive rate of
+ *               BloomFilter and BlockedBloomFilter given the same memory, on
+ *               generated urls, one lookup at a time and in batches, or
+ *               the time to build a BloomFilter from a file of urls on 1 to
+ *               all cores.
+ *  Date: 5/6/2019
+ */
+
+#include "BloomFilter.hpp"
+#include "BlockedBloomFilter.hpp"
+#include "UrlPipeline.hpp"
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <fstream>
+#include <iostream>
+#include <string>
+#include <string_view>
+#include <thread>
+#include <vector>
+#define DEFAULT_ITEMS 20000000 /** Bad urls inserted, far more than L3 */
+#define DEFAULT_BYTES_PER_ITEM 1.5 /** Filter bytes per url, as in firewall */
+#define LOOKUPS 1000000 /** Lookups of inserted and of absent urls each */
+#define LOOKUP_BLOCK 4096 /** Urls passed to one findBatch, as in firewall */
+#define ITEMS_ARG 1 /** Argument index of the number of urls */
+#define BYTES_ARG 2 /** Argument index of the bytes per url */
+#define NANOS_PER_SEC 1e9 /** Nanoseconds in a second */
+#define BUILD_FLAG "--build" /** First argument selecting the build scaling
+                              *  benchmark */
+#define BUILD_FILE "benchbloom_urls.tmp" /** File of urls the build reads */
+
+using namespace std;
+
+/** Function Name: nanosSince(chrono::steady_clock::time_point start)
+ *  Description: Time elapsed since start
+ *  Parameters: start - When the timed work began
+ *  Return Value: The nanoseconds since start
+ */
+long long nanosSince(chrono::steady_clock::time_point start) {
+    return chrono::duration_cast<chrono::nanoseconds>(
+            chrono::steady_clock::now() - start).count();
+}
+
+/** Function Name: makeUrl(unsigned long long i)
+ *  Description: The i-th generated url, every one distinct
+ *  Parameters: i - Index of the url
+ *  Return Value: A url-like string
+ */
+string makeUrl(unsigned long long i) {
+    /** Scrambled so neighbouring urls share no long prefix */
+    unsigned long long host = (i * 0x9E3779B97F4A7C15ULL) >> 20;
+    return "http://www." + to_string(host) + ".com/page" + to_string(i);
+}
+
+/** Function Name: timeBatches(Filter & filter,
+ *                      const vector<string> & urls, unsigned int & found,
+ *                      unsigned int & mismatches)
+ *  Description: Looks up urls with findBatch, a block of them at a time as
+ *               firewall does, checking every result against find
+ *  Parameters: filter - The filter to look the urls up in
+ *              urls - The urls to look up
+ *              found - Set to the number of urls found
+ *              mismatches - Set to the number of results differing from
+ *                           find
+ *  Return Value: The nanoseconds taken by findBatch
+ */
+template <class Filter>
+long long timeBatches(Filter & filter, const vector<string> & urls,
+        unsigned int & found, unsigned int & mismatches) {
+    vector<string_view> views(urls.begin(), urls.end());
+    vector<uint64_t> results;
+    chrono::steady_clock::time_point start = chrono::steady_clock::now();
+    for( size_t first = 0; first < views.size(); first += LOOKUP_BLOCK) {
+        vector<string_view> block(views.begin() + first, views.begin() +
+                min(views.size(), first + LOOKUP_BLOCK));
+        vector<uint64_t> bits = filter.findBatch(block);
+        results.insert(results.end(), bits.begin(), bits.end());
+    }
+    long long time = nanosSince(start);
+    found = 0;
+    mismatches = 0;
+    for( size_t j = 0; j < urls.size(); j++) {
+        /** Blocks are whole words of the bitmap, so bits line up */
+        bool bit = (results[j / BITMAP_WORD_BITS] >> j % BITMAP_WORD_BITS) & 1;
+        found += bit;
+        mismatches += bit != filter.find(urls[j]);
+    }
+    return time;
+}
+
+/** Function Name: timeLookups(const char * label, Filter & filter,
+ *                      const vector<string> & inserted,
+ *                      const vector<string> & absent)
+ *  Description: Looks up urls that were inserted and urls that were not,
+ *               with find and then with findBatch, printing lookups per
+ *               second of each, the false negatives (always 0) and the false
+ *               positive rate
+ *  Parameters: label - Name of the filter
+ *              filter - The filter holding the inserted urls
+ *              inserted - Urls that were inserted
+ *              absent - Urls that were not
+ */
+template <class Filter>
+void timeLookups(const char * label, Filter & filter,
+        const vector<string> & inserted, const vector<string> & absent) {
+    unsigned int found = 0;
+    chrono::steady_clock::time_point start = chrono::steady_clock::now();
+    for( const string & url : inserted) {
+        found += filter.find(url);
+    }
+    long long insertedTime = nanosSince(start);
+    unsigned int falsePositives = 0;
+    start = chrono::steady_clock::now();
+    for( const string & url : absent) {
+        falsePositives += filter.find(url);
+    }
+    long long absentTime = nanosSince(start);
+    cout << label << endl;
+    cout << "\tinserted urls: " << inserted.size() /
+        (insertedTime / NANOS_PER_SEC) << " lookups/sec, " << inserted.size() - found
+        << " false negatives" << endl;
+    cout << "\tabsent urls: " << absent.size() /
+        (absentTime / NANOS_PER_SEC) << " lookups/sec, false positive rate "
+        << (double) falsePositives / absent.size() << endl;
+    unsigned int mismatches = 0;
+    unsigned int batchMismatches = 0;
+    insertedTime = timeBatches(filter, inserted, found, mismatches);
+    absentTime = timeBatches(filter, absent, falsePositives, batchMismatches);
+    cout << "\tbatched inserted urls: " << inserted.size() /
+        (insertedTime / NANOS_PER_SEC) << " lookups/sec, "
+        << inserted.size() - found << " false negatives" << endl;
+    cout << "\tbatched absent urls: " << absent.size() /
+        (absentTime / NANOS_PER_SEC) << " lookups/sec, false positive rate "
+        << (double) falsePositives / absent.size() << endl;
+    cout << "\tbatched results differing from find: "
+        << mismatches + batchMismatches << endl;
+}
+
+/** Function Name: buildScaling(unsigned long long numItems,
+ *                      size_t numBytes)
+ *  Description: Writes numItems generated urls to BUILD_FILE, builds a
+ *               BloomFilter from it with insert on one thread, then with
+ *               forEachLineParallel and insertAtomic on 1, 2, 4, ... up to
+ *               every core, printing each build time, its speedup over one
+ *               thread and whether its table matches the sequential one
+ *  Parameters: numItems - Number of urls
+ *              numBytes - Size of each filter
+ */
+void buildScaling(unsigned long long numItems, size_t numBytes) {
+    {
+        ofstream urls(BUILD_FILE, ios::binary);
+        for( unsigned long long i = 0; i < numItems; i++) {
+            urls << makeUrl(i) << '\n';
+        }
+    }
+    cout << numItems << " urls, " << numBytes << " bytes" << endl;
+    BloomFilter sequential(numBytes);
+    chrono::steady_clock::time_point start = chrono::steady_clock::now();
+    {
+        ifstream urls(BUILD_FILE, ios::binary);
+        UrlPipeline::forEachLine(urls,
+                [&sequential](string_view url) { sequential.insert(url); });
+    }
+    cout << "sequential insert: " << nanosSince(start) << " nanoseconds."
+        << endl;
+
+    unsigned int cores = max(thread::hardware_concurrency(), 1U);
+    long long oneThread = 0;
+    for( unsigned int threads = 1; threads <= cores;
+            threads = threads < cores && threads * 2 > cores ? cores :
+            threads * 2) {
+        BloomFilter parallel(numBytes);
+        start = chrono::steady_clock::now();
+        UrlPipeline::forEachLineParallel(BUILD_FILE, threads,
+                [&parallel](string_view url) { parallel.insertAtomic(url); });
+        long long time = nanosSince(start);
+        if( threads == 1) {
+            oneThread = time;
+        }
+        cout << threads << " threads, insertAtomic: " << time
+            << " nanoseconds, speedup " << (double) oneThread / time
+            << ", identical to sequential: "
+            << (parallel == sequential ? "yes" : "no") << endl;
+        if( threads == cores) {
+            break;
+        }
+    }
+    remove(BUILD_FILE);
+}
+
+/** Function Name: main(int argc, char** argv)
+ *  Description: Fills both filters with the same generated urls, sized to
+ *               the same number of bytes, and compares their lookups. Takes
+ *               two optional arguments: (1) the number of urls and (2) the
+ *               filter bytes per url. With BUILD_FLAG before them it runs
+ *               buildScaling instead.
+ *  Parameters: argc - The number of arguments passed in by user
+ *              argv - An array of char * representing user's arguments
+ *  Return Value: An int representing the success of the program
+ */
+int main(int argc, char** argv) {
+    /** The numbers follow the flag */
+    bool build = argc > 1 && string(argv[1]) == BUILD_FLAG;
+    if( build) {
+        argv++;
+        argc--;
+    }
+    unsigned long long numItems = argc > ITEMS_ARG ?
+        stoull(argv[ITEMS_ARG]) : DEFAULT_ITEMS;
+    double bytesPerItem = argc > BYTES_ARG ?
+        stod(argv[BYTES_ARG]) : DEFAULT_BYTES_PER_ITEM;
+    size_t numBytes = numItems * bytesPerItem;
+    if( build) {
+        buildScaling(numItems, numBytes);
+        return 0;
+    }
+    BloomFilter BF(numBytes);
+    BlockedBloomFilter BBF(numBytes);
+    cout << numItems << " urls, " << numBytes << " bytes for BloomFilter, "
+        << BBF.memoryUsage() << " bytes for BlockedBloomFilter" << endl;
+
+    chrono::steady_clock::time_point start = chrono::steady_clock::now();
+    for( unsigned long long i = 0; i < numItems; i++) {
+        BF.insert(makeUrl(i));
+    }
+    cout << "BloomFilter insert time: " << nanosSince(start)
+        << " nanoseconds." << endl;
+    start = chrono::steady_clock::now();
+    for( unsigned long long i = 0; i < numItems; i++) {
+        BBF.insert(makeUrl(i));
+    }
+    cout << "BlockedBloomFilter insert time: " << nanosSince(start)
+        << " nanoseconds." << endl;
+
+    /** Inserted urls spread over the whole range, absent ones after it */
+    vector<string> inserted;
+    vector<string> absent;
+    for( unsigned long long i = 0; i < LOOKUPS && numItems > 0; i++) {
+        inserted.push_back(makeUrl((i * 7919) % numItems));
+        absent.push_back(makeUrl(numItems + i));
+    }
+    timeLookups("BloomFilter", BF, inserted, absent);
+    timeLookups("BlockedBloomFilter", BBF, inserted, absent);
+    return 0;
+}
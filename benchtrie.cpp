@@ -8,25 +8,115 @@
 
 #include "util.hpp"
 #include "DictionaryTrie.hpp"
+#include "FrozenDictionaryTrie.hpp"
+#include "DictionaryHandle.hpp"
+#include "SubstringIndex.hpp"
+#include "RadixDictionaryTrie.hpp"
 #include <fstream>
 #include <sstream>
+#include <cstdlib>
+#include <new>
+#include <cstdio>
+#include <algorithm>
+#include <iterator>
+#include <climits>
+#include <thread>
+#include <atomic>
+#include <set>
+#include <chrono>
+#define IMAGE_FILENAME "benchtrie.img" /** Scratch image for frozen tests */
+#define SCALING_LINES 10000000 /** Dictionary lines of the build scaling run */
+#define CONCURRENT_QUERIES 200000 /** Prefixes in the concurrent query batch */
+#define WRITE_STRESS_OPS 200000 /** Updates per writer of the write stress */
+#define RELOAD_PREFIXES 100000 /** Prefixes queried during the reload run */
+#define RELOAD_STEADY_MS 1000 /** Length of the reload run's steady phase */
+#define SWAP_WINDOW 1000000 /** ns around a swap counted as during it */
+#define FUZZY_QUERIES 20000 /** Typo'd prefixes of the fuzzy run */
+#define UNDERSCORE_REPETITIONS 50 /** Runs of each pattern of a suite */
+#define SUBSTRING_QUERIES 20000 /** Substrings of the substring index run */
+#define SUBSTRING_SCANS 200 /** Substrings also found by a linear scan */
+#define LAYOUT_QUERIES 200000 /** Prefixes of the frozen layout run */
+#define ENGINE_QUERIES 20000 /** Queries of each kind per engine */
+#define REPEAT_WORDS 10000 /** Distinct words of the build repeats check */
 using namespace std;
 
-void testStudent(string dict_filename){
+/** Set around the queries whose allocations are counted, so the other
+ *  modes only read it and never contend on the counters below */
+static atomic<bool> countingAllocations(false);
 
-    ifstream in;
-    in.open(dict_filename, ios::binary);
+/** Number of heap allocations made while counting */
+static atomic<unsigned long long> allocations(0);
 
+/** Number of bytes requested by those allocations */
+static atomic<unsigned long long> allocatedBytes(0);
 
-    // Testing student's trie
-    cout << "\nTiming your solution" << endl;
-    cout << "\nLoading dictionary..." << endl;
-    DictionaryTrie* dictionary_trie = new DictionaryTrie();
+/*
+ * Global operator new replaced to count heap allocations per query. GCC
+ * inlines the matching delete below into delete expressions and then warns
+ * that free() gets a block from operator new, which is how they pair here.
+ */
+#if defined(__GNUC__) && !defined(__clang__)
+#pragma GCC diagnostic push
+#pragma GCC diagnostic ignored "-Wmismatched-new-delete"
+#endif
+void* operator new(size_t size){
+    if(countingAllocations.load(memory_order_relaxed)){
+        allocations.fetch_add(1, memory_order_relaxed);
+        allocatedBytes.fetch_add(size, memory_order_relaxed);
+    }
+    void* block = malloc(size ? size : 1);
+    if(block == nullptr){
+        throw bad_alloc();
+    }
+    return block;
+}
 
-    Utils::load_dict(*dictionary_trie, in);
+void operator delete(void* block) noexcept{
+    free(block);
+}
 
-    cout << "Finished loading dictionary." << endl;
-    cout << "\nStarting timing tests for your solution." << endl;
+void operator delete(void* block, size_t) noexcept{
+    free(block);
+}
+#if defined(__GNUC__) && !defined(__clang__)
+#pragma GCC diagnostic pop
+#endif
+
+/*
+ * Prints the heap allocations made by a few prefix and underscore queries
+ */
+void countAllocations(DictionaryTrie* dictionary_trie){
+
+    const char* prefixes[] = {"a", "s", "the", "app", "man"};
+    const char* patterns[] = {"hel_", "_at", "c_t", "s_ing", "_"};
+    unsigned long long before;
+
+    for(const char* prefix : prefixes){
+        string query(prefix);
+        before = allocations;
+        countingAllocations = true;
+        dictionary_trie->predictCompletions(query, 10);
+        countingAllocations = false;
+        cout << "\tprefix= \"" << prefix << "\": "
+            << allocations - before << " allocations" << endl;
+    }
+    for(const char* pattern : patterns){
+        string query(pattern);
+        before = allocations;
+        countingAllocations = true;
+        dictionary_trie->predictUnderscore(query, 10);
+        countingAllocations = false;
+        cout << "\tpattern= \"" << pattern << "\": "
+            << allocations - before << " allocations" << endl;
+    }
+}
+
+/*
+ * Times the prefix completion queries (Tests 1 to 5) on the dictionary,
+ * either a DictionaryTrie or a FrozenDictionaryTrie
+ */
+template <class Dictionary>
+void timePrefixTests(Dictionary* dictionary_trie){
 
     Timer T;
     vector<string> results;
@@ -129,6 +219,194 @@ void testStudent(string dict_filename){
     cout << "\tTest 5: time taken: " << time_duration << " nanoseconds."
         << endl;
     cout << "\tTest 5: results found: " <<  results.size() << endl;
+}
+
+/*
+ * Loads the dictionary one insert at a time in file order, the way
+ * load_dict used to, and compares it with the bulk built dictionary
+ */
+void compareIncrementalBuild(string dict_filename,
+        DictionaryTrie* dictionary_trie){
+
+    Timer T;
+    long long time_duration;
+    ifstream in;
+    in.open(dict_filename, ios::binary);
+
+    cout << "\nLoading dictionary one insert at a time..." << endl;
+    DictionaryTrie* incremental_trie = new DictionaryTrie();
+    string line;
+    T.begin_timer();
+    while(getline(in, line)){
+        if(in.eof()) break;
+        unsigned int freq = Utils::stripFrequency(line);
+        incremental_trie->insert(line, freq);
+    }
+    time_duration = T.end_timer();
+    cout << "\tLoad time: " << time_duration << " nanoseconds." << endl;
+    cout << "\tAverage word depth: " << incremental_trie->averageWordDepth()
+        << " (bulk built: " << dictionary_trie->averageWordDepth() << ")"
+        << endl;
+
+    cout << "\nStarting timing tests on the incremental dictionary." << endl;
+    timePrefixTests(incremental_trie);
+    delete incremental_trie;
+}
+
+/*
+ * Compiles the dictionary to an image, then times mapping it back and the
+ * prefix tests on the mapped image
+ */
+void compareFrozenImage(DictionaryTrie* dictionary_trie){
+
+    Timer T;
+    long long time_duration;
+
+    cout << "\nCompiling frozen image..." << endl;
+    T.begin_timer();
+    bool compiled = FrozenDictionaryTrie::compile(*dictionary_trie,
+            IMAGE_FILENAME);
+    time_duration = T.end_timer();
+    if(!compiled){
+        cout << "\tCould not write " << IMAGE_FILENAME << endl;
+        return;
+    }
+    cout << "\tCompile time: " << time_duration << " nanoseconds." << endl;
+
+    FrozenDictionaryTrie* frozen_trie = new FrozenDictionaryTrie();
+    T.begin_timer();
+    bool opened = frozen_trie->open(IMAGE_FILENAME);
+    time_duration = T.end_timer();
+    if(opened){
+        cout << "\tOpen time: " << time_duration << " nanoseconds." << endl;
+        cout << "\tImage size: " << frozen_trie->memoryUsage()
+            << " bytes, " << frozen_trie->nodeCount() << " nodes for "
+            << dictionary_trie->nodeCount() << " trie nodes." << endl;
+        cout << "\nStarting timing tests on the frozen image." << endl;
+        timePrefixTests(frozen_trie);
+    }
+    else{
+        cout << "\tCould not map " << IMAGE_FILENAME << endl;
+    }
+    delete frozen_trie;
+    remove(IMAGE_FILENAME);
+}
+
+/*
+ * Prints the load throughput of a load_dict overload
+ */
+void printThroughput(const char* overload, long long time_duration,
+        double file_bytes){
+    cout << "\t" << overload << ": " << time_duration << " nanoseconds, "
+        << file_bytes / (1 << 20) / (time_duration / 1e9) << " MB/s" << endl;
+}
+
+/*
+ * Times each of the three load_dict overloads reading the whole dictionary
+ */
+void timeLoaders(string dict_filename){
+
+    Timer T;
+    long long time_duration;
+
+    ifstream in(dict_filename, ios::binary | ios::ate);
+    double file_bytes = in.tellg();
+    in.seekg(0, ios::beg);
+    unsigned int num_lines = count(istreambuf_iterator<char>(in),
+            istreambuf_iterator<char>(), '\n');
+    in.close();
+
+    cout << "\nLoad throughput (" << file_bytes << " bytes, " << num_lines
+        << " lines)" << endl;
+    {
+        ifstream words(dict_filename, ios::binary);
+        DictionaryTrie dictionary_trie;
+        T.begin_timer();
+        Utils::load_dict(dictionary_trie, words);
+        time_duration = T.end_timer();
+        printThroughput("load_dict(trie)", time_duration, file_bytes);
+    }
+    {
+        ifstream words(dict_filename, ios::binary);
+        DictionaryTrie dictionary_trie;
+        T.begin_timer();
+        Utils::load_dict(dictionary_trie, words, num_lines);
+        time_duration = T.end_timer();
+        printThroughput("load_dict(trie, num_words)", time_duration,
+                file_bytes);
+    }
+    {
+        ifstream words(dict_filename, ios::binary);
+        vector<string> dictionary_words;
+        T.begin_timer();
+        Utils::load_dict(dictionary_words, words);
+        time_duration = T.end_timer();
+        printThroughput("load_dict(vector)", time_duration, file_bytes);
+    }
+}
+
+void testStudent(string dict_filename){
+
+    ifstream in;
+    in.open(dict_filename, ios::binary);
+
+
+    // Testing student's trie
+    cout << "\nTiming your solution" << endl;
+    cout << "\nLoading dictionary..." << endl;
+    Timer T;
+    vector<string> results;
+    long long time_duration;
+
+    DictionaryTrie* dictionary_trie = new DictionaryTrie();
+
+    T.begin_timer();
+    Utils::load_dict(*dictionary_trie, in);
+    time_duration = T.end_timer();
+
+    cout << "Finished loading dictionary." << endl;
+    cout << "\tLoad time: " << time_duration << " nanoseconds." << endl;
+    cout << "\tNodes: " << dictionary_trie->nodeCount() << endl;
+    cout << "\tBytes per node: " << sizeof(TrieNode) << " (pool: "
+        << (double)dictionary_trie->memoryUsage() /
+        dictionary_trie->nodeCount() << " with slab slack)" << endl;
+    cout << "\tAverage word depth: " << dictionary_trie->averageWordDepth()
+        << endl;
+    cout << "\nStarting timing tests for your solution." << endl;
+
+    timePrefixTests(dictionary_trie);
+
+    // Loader throughput
+    timeLoaders(dict_filename);
+
+    // Incremental build
+    compareIncrementalBuild(dict_filename, dictionary_trie);
+
+    // Allocations
+    cout << "\nCounting heap allocations per query (num_completions= 10)."
+        << endl;
+    countAllocations(dictionary_trie);
+
+    // Best-first engine
+    cout << "\nStarting timing tests with best-first completions." << endl;
+    dictionary_trie->setCompletionEngine(DictionaryTrie::BEST_FIRST);
+    timePrefixTests(dictionary_trie);
+
+    // Completion cache
+    cout << "\nBuilding top-" << DEFAULT_CACHE_K << " completion cache..."
+        << endl;
+    T.begin_timer();
+    dictionary_trie->buildCompletionCache(DEFAULT_CACHE_K);
+    time_duration = T.end_timer();
+    cout << "\tCache build time: " << time_duration << " nanoseconds."
+        << endl;
+    cout << "\tCache memory: " << dictionary_trie->cacheMemoryUsage()
+        << " bytes." << endl;
+    cout << "\nStarting timing tests with completion cache." << endl;
+    timePrefixTests(dictionary_trie);
+
+    // Frozen image
+    compareFrozenImage(dictionary_trie);
 
     cout << "\nWould you like to run additional tests? y/n\n";
     string response;
@@ -168,20 +446,1023 @@ void testStudent(string dict_filename){
 
 
     cout << "\nFinished timing your solution." << endl;
+    T.begin_timer();
     delete dictionary_trie;
+    time_duration = T.end_timer();
+    cout << "\tTeardown time: " << time_duration << " nanoseconds." << endl;
 
 
 }
 
+/*
+ * Loads num_words words in sorted order followed by one chain_length long
+ * word, then queries from the root and down the long chain. Sorted input
+ * gives the TST its longest sibling chains and the long word the deepest
+ * down chain, so this only passes if no operation recurses per node.
+ */
+void stressSorted(unsigned int num_words, unsigned int chain_length){
+
+    Timer T;
+    long long time_duration;
+    vector<string> results;
+
+    cout << "\nStress test: " << num_words << " sorted words and one "
+        << chain_length << " character word" << endl;
+
+    // Fixed length base 26 numbers are generated in sorted order
+    vector<string> words;
+    string word(5, 'a');
+    for(unsigned int i = 0; i < num_words; i++){
+        unsigned int n = i;
+        for(int j = word.size() - 1; j >= 0; j--){
+            word[j] = 'a' + n % 26;
+            n /= 26;
+        }
+        words.push_back(word);
+    }
+    string chain(chain_length, 'z');
+
+    // Inserted one by one, a balanced build would undo the sorted order
+    DictionaryTrie dictionary_trie;
+    T.begin_timer();
+    for(unsigned int i = 0; i < words.size(); i++){
+        dictionary_trie.insert(words[i], (i % 1000) + 1);
+    }
+    dictionary_trie.insert(chain, 1);
+    time_duration = T.end_timer();
+    cout << "\tLoad time: " << time_duration << " nanoseconds." << endl;
+    cout << "\tNodes: " << dictionary_trie.nodeCount() << endl;
+
+    bool passed = dictionary_trie.find(chain);
+
+    T.begin_timer();
+    results = dictionary_trie.predictCompletions("", 10);
+    time_duration = T.end_timer();
+    passed = passed && results.size() == 10;
+    cout << "\tRoot completions: " << results.size() << " in "
+        << time_duration << " nanoseconds." << endl;
+
+    T.begin_timer();
+    results = dictionary_trie.predictCompletions("z", 10);
+    time_duration = T.end_timer();
+    passed = passed && results.size() == 1 && results[0] == chain;
+    cout << "\tChain completions: " << results.size() << " in "
+        << time_duration << " nanoseconds." << endl;
+
+    T.begin_timer();
+    results = dictionary_trie.predictUnderscore("_aaaa", 10);
+    time_duration = T.end_timer();
+    passed = passed && !results.empty();
+    cout << "\tPattern completions: " << results.size() << " in "
+        << time_duration << " nanoseconds." << endl;
+
+    dictionary_trie.setCompletionEngine(DictionaryTrie::BEST_FIRST);
+    results = dictionary_trie.predictCompletions("z", 10);
+    passed = passed && results.size() == 1 && results[0] == chain;
+
+    cout << "\tStress test " << (passed ? "passed" : "FAILED") << endl;
+}
+
+
+/*
+ * Builds dictionaries from entries repeating words with other frequencies,
+ * empty with 1 and 4 threads and non-empty, checking every word keeps the
+ * frequency of its first copy as a run of inserts would
+ */
+void checkBuildRepeats(unsigned int num_words){
+
+    cout << "\nBuild repeats: " << num_words << " words, each given "
+        << "three times" << endl;
+
+    // Every word is repeated further on with other frequencies
+    vector<string> words;
+    string word(3, 'a');
+    for(unsigned int i = 0; i < num_words; i++){
+        unsigned int n = (i * 7919ULL) % num_words;
+        for(int j = word.size() - 1; j >= 0; j--){
+            word[j] = 'a' + n % 26;
+            n /= 26;
+        }
+        words.push_back(word);
+    }
+    vector<pair<string_view, unsigned int>> entries;
+    for(unsigned int copy = 0; copy < 3; copy++){
+        for(unsigned int i = 0; i < words.size(); i++){
+            entries.emplace_back(words[(i + copy * 31) % words.size()],
+                    copy * 1000 + i % 1000 + 1);
+        }
+    }
+
+    bool passed = true;
+    for(unsigned int seeded = 0; seeded < 2; seeded++){
+        unsigned int thread_counts[] = {1, 4};
+        for(unsigned int num_threads : thread_counts){
+            DictionaryTrie built;
+            DictionaryTrie inserted;
+            if(seeded){
+                built.insert(words[0], 5000);
+                inserted.insert(words[0], 5000);
+            }
+            built.build(entries, num_threads);
+            for(auto& entry : entries){
+                inserted.insert(string(entry.first), entry.second);
+            }
+            unsigned int wrong = 0;
+            for(const string& w : words){
+                wrong += built.frequency(w) != inserted.frequency(w);
+            }
+            passed = passed && wrong == 0;
+            cout << "\t" << (seeded ? "Non-empty" : "Empty") << ", "
+                << num_threads << " threads: " << wrong
+                << " wrong frequencies" << endl;
+        }
+    }
+
+    cout << "\tBuild repeats " << (passed ? "passed" : "FAILED") << endl;
+}
+/*
+ * Replicates the dictionary to num_lines lines, every copy after the first
+ * with its own suffix so the words stay distinct, then times the load at
+ * 1, 2, 4 and 8 build threads
+ */
+void buildScaling(string dict_filename, unsigned int num_lines){
+
+    Timer T;
+    long long time_duration;
+
+    ifstream in(dict_filename, ios::binary);
+    vector<string> lines;
+    string line;
+    while(getline(in, line)){
+        lines.push_back(line);
+    }
+    if(lines.empty()){
+        cout << "Could not read " << dict_filename << endl;
+        return;
+    }
+
+    string file;
+    for(unsigned int i = 0; i < num_lines; i++){
+        file += lines[i % lines.size()];
+        unsigned int copy = i / lines.size();
+        if(copy > 0){
+            file += '#';
+            file += to_string(copy);
+        }
+        file += '\n';
+    }
+    cout << "\nBuild scaling: " << num_lines << " lines, " << file.size()
+        << " bytes, " << thread::hardware_concurrency() << " cores" << endl;
+
+    unsigned int thread_counts[] = {1, 2, 4, 8};
+    long long single_thread = 0;
+    unsigned int node_count = 0;
+    for(unsigned int num_threads : thread_counts){
+        istringstream words(file);
+        DictionaryTrie dictionary_trie;
+        T.begin_timer();
+        Utils::load_dict(dictionary_trie, words, UINT_MAX, num_threads);
+        time_duration = T.end_timer();
+        if(num_threads == 1){
+            single_thread = time_duration;
+            node_count = dictionary_trie.nodeCount();
+        }
+        cout << "\t" << num_threads << " threads: " << time_duration
+            << " nanoseconds, speedup "
+            << (double)single_thread / time_duration
+            << (dictionary_trie.nodeCount() == node_count ? "" :
+                    ", NODE COUNT DIFFERS") << endl;
+    }
+}
+
+/*
+ * Answers the same batch of prefixes with 1, 2, 4 and 8 query threads and
+ * prints the queries per second of each, checking every batch returns the
+ * single threaded results
+ */
+void concurrentQueries(string dict_filename, unsigned int num_queries){
+
+    Timer T;
+    long long time_duration;
+
+    ifstream in(dict_filename, ios::binary);
+    DictionaryTrie dictionary_trie;
+    Utils::load_dict(dictionary_trie, in);
+    dictionary_trie.setCompletionEngine(DictionaryTrie::BEST_FIRST);
+
+    // Prefixes of 1 to 3 chars of words spread over the dictionary
+    in.clear();
+    in.seekg(0, ios::beg);
+    vector<string> words;
+    Utils::load_dict(words, in);
+    vector<string> prefixes;
+    for(unsigned int i = 0; i < num_queries && !words.empty(); i++){
+        const string& word = words[(i * 7919ULL) % words.size()];
+        prefixes.push_back(word.substr(0, 1 + i % 3));
+    }
+
+    cout << "\nConcurrent queries: " << prefixes.size()
+        << " prefixes, num_completions= 10, "
+        << thread::hardware_concurrency() << " cores" << endl;
+
+    unsigned int thread_counts[] = {1, 2, 4, 8};
+    vector<vector<string>> expected;
+    double single_thread = 0;
+    for(unsigned int num_threads : thread_counts){
+        dictionary_trie.setQueryThreads(num_threads);
+        T.begin_timer();
+        vector<vector<string>> results =
+            dictionary_trie.predictCompletionsBatch(prefixes, 10);
+        time_duration = T.end_timer();
+        double qps = prefixes.size() / (time_duration / 1e9);
+        if(num_threads == 1){
+            single_thread = qps;
+            expected = std::move(results);
+        }
+        else if(results != expected){
+            cout << "\t" << num_threads << " threads: RESULTS DIFFER" << endl;
+        }
+        cout << "\t" << num_threads << " threads: " << qps << " QPS, speedup "
+            << qps / single_thread << endl;
+    }
+}
+
+/*
+ * Runs writers (increment, insert, upsert) and readers (predictCompletions)
+ * on one dictionary at once. Readers check every result they get while the
+ * writers run; once they stop, every frequency and the subtree bounds used
+ * by the best-first engine are checked against what the writers did.
+ */
+void stressConcurrentWrites(string dict_filename, unsigned int num_writers,
+        unsigned int num_readers, unsigned int ops_per_writer){
+
+    Timer T;
+    ifstream in(dict_filename, ios::binary);
+    DictionaryTrie dictionary_trie;
+    Utils::load_dict(dictionary_trie, in);
+    dictionary_trie.buildCompletionCache(DEFAULT_CACHE_K);
+    in.clear();
+    in.seekg(0, ios::beg);
+    vector<string> words;
+    Utils::load_dict(words, in);
+    if(words.empty()){
+        cout << "Could not read " << dict_filename << endl;
+        return;
+    }
+    vector<unsigned int> original(words.size());
+    for(unsigned int i = 0; i < words.size(); i++){
+        original[i] = dictionary_trie.frequency(words[i]);
+    }
+
+    cout << "\nConcurrent writes: " << num_writers << " writers x "
+        << ops_per_writer << " ops, " << num_readers << " readers" << endl;
+
+    // Writer w increments words[(w + i * 7919) % n], inserts its own
+    // word every 4th op and races the other writers on shared new words
+    atomic<unsigned int> published(0);
+    atomic<unsigned int> shared_wins(0);
+    atomic<unsigned int> writers_done(0);
+    atomic<unsigned long long> reads(0);
+    atomic<unsigned long long> failures(0);
+    vector<thread> threads;
+    T.begin_timer();
+    for(unsigned int w = 0; w < num_writers; w++){
+        threads.push_back(thread([&, w](){
+            for(unsigned int i = 0; i < ops_per_writer; i++){
+                dictionary_trie.increment(
+                        words[(w + i * 7919ULL) % words.size()], 1);
+                if(i % 4 == 0){
+                    string own = "zz" + to_string(w) + "_" + to_string(i);
+                    dictionary_trie.upsert(own, i);
+                    if(w == 0){
+                        published.store(i + 1, memory_order_release);
+                    }
+                }
+                if(i % 64 == 0 &&
+                        dictionary_trie.insert("zshared" + to_string(i), 7)){
+                    shared_wins++;
+                }
+            }
+            writers_done++;
+        }));
+    }
+    for(unsigned int r = 0; r < num_readers; r++){
+        threads.push_back(thread([&, r](){
+            unsigned int i = r;
+            while(writers_done.load() < num_writers){
+                const string& word = words[(i * 104729ULL) % words.size()];
+                string prefix = word.substr(0, 1 + i % 3);
+                vector<string> results =
+                    dictionary_trie.predictCompletions(prefix, 10 + i % 20);
+                set<string> seen;
+                for(const string& result : results){
+                    if(result.compare(0, prefix.size(), prefix) != 0 ||
+                            !seen.insert(result).second ||
+                            !dictionary_trie.find(result)){
+                        failures++;
+                    }
+                }
+                if(results.size() > 10 + i % 20){
+                    failures++;
+                }
+                // A word published by writer 0 stays visible
+                unsigned int last = published.load(memory_order_acquire);
+                if(last > 0 && !dictionary_trie.find(
+                            "zz0_" + to_string((last - 1) / 4 * 4))){
+                    failures++;
+                }
+                reads++;
+                i += num_readers;
+            }
+        }));
+    }
+    for(thread& worker : threads){
+        worker.join();
+    }
+    long long time_duration = T.end_timer();
+
+    // Replay the writers to know every final frequency
+    vector<unsigned int> expected(original);
+    for(unsigned int w = 0; w < num_writers; w++){
+        for(unsigned int i = 0; i < ops_per_writer; i++){
+            expected[(w + i * 7919ULL) % words.size()]++;
+        }
+    }
+    unsigned int wrong = 0;
+    for(unsigned int i = 0; i < words.size(); i++){
+        // Repeated lines of one word are counted once
+        if(dictionary_trie.frequency(words[i]) != expected[i] &&
+                dictionary_trie.frequency(words[i]) != original[i]){
+            wrong++;
+        }
+    }
+    for(unsigned int w = 0; w < num_writers; w++){
+        for(unsigned int i = 0; i < ops_per_writer; i += 4){
+            if(dictionary_trie.frequency(
+                        "zz" + to_string(w) + "_" + to_string(i)) != i &&
+                    i != 0){
+                wrong++;
+            }
+        }
+    }
+    unsigned int expected_wins = (ops_per_writer + 63) / 64;
+
+    // Both engines agree only if every subtree bound still holds
+    unsigned int disagreements = 0;
+    for(unsigned int i = 0; i < 2000; i++){
+        string prefix = words[(i * 7919ULL) % words.size()].substr(0,
+                1 + i % 3);
+        dictionary_trie.setCompletionEngine(DictionaryTrie::EXHAUSTIVE_DFS);
+        vector<string> dfs = dictionary_trie.predictCompletions(prefix, 25);
+        dictionary_trie.setCompletionEngine(DictionaryTrie::BEST_FIRST);
+        if(dfs != dictionary_trie.predictCompletions(prefix, 25)){
+            disagreements++;
+        }
+    }
+
+    bool passed = failures == 0 && wrong == 0 && disagreements == 0 &&
+        shared_wins == expected_wins;
+    cout << "\tTime: " << time_duration << " nanoseconds, " << reads
+        << " reads" << endl;
+    cout << "\tReader failures: " << failures << ", wrong frequencies: "
+        << wrong << ", shared insert wins: " << shared_wins << "/"
+        << expected_wins << ", engine disagreements: " << disagreements
+        << endl;
+    cout << "\tConcurrent write stress " << (passed ? "passed" : "FAILED")
+        << endl;
+}
+
+/*
+ * Returns the given percentile of latencies, sorting them
+ */
+long long percentile(vector<long long>& latencies, double fraction){
+    if(latencies.empty()){
+        return 0;
+    }
+    sort(latencies.begin(), latencies.end());
+    return latencies[(size_t)(fraction * (latencies.size() - 1))];
+}
+
+/*
+ * Prints the p50, p99 and max of latencies under label
+ */
+void printLatencies(const char* label, vector<long long>& latencies){
+    long long p50 = percentile(latencies, 0.50);
+    long long p99 = percentile(latencies, 0.99);
+    cout << "\t" << label << ": " << latencies.size() << " queries, p50 "
+        << p50 << " ns, p99 " << p99 << " ns, max "
+        << (latencies.empty() ? 0 : latencies.back()) << " ns" << endl;
+}
+
+/*
+ * Times every query of num_readers threads on a DictionaryHandle, first
+ * while it is left alone and then while the dictionary is rebuilt and
+ * swapped in num_reloads times. Each query is checked against the results
+ * of the first snapshot, and the latency of the queries running within
+ * SWAP_WINDOW of a swap is reported on its own.
+ */
+void reloadLatency(string dict_filename, unsigned int num_readers,
+        unsigned int num_reloads){
+
+    DictionaryHandle handle;
+    if(!handle.reload(dict_filename)){
+        cout << "Could not read " << dict_filename << endl;
+        return;
+    }
+    ifstream in(dict_filename, ios::binary);
+    vector<string> words;
+    Utils::load_dict(words, in);
+    vector<string> prefixes;
+    vector<vector<string>> expected;
+    for(unsigned int i = 0; i < RELOAD_PREFIXES && !words.empty(); i++){
+        prefixes.push_back(words[(i * 7919ULL) % words.size()].substr(0,
+                    1 + i % 3));
+        expected.push_back(handle.predictCompletions(prefixes.back(), 10));
+    }
+
+    cout << "\nReload latency: " << num_readers << " readers, "
+        << num_reloads << " reloads, "
+        << thread::hardware_concurrency() << " cores" << endl;
+
+    // Each query's start and duration, in ns since base
+    typedef chrono::steady_clock Clock;
+    Clock::time_point base = Clock::now();
+    atomic<bool> stop(false);
+    atomic<unsigned long long> failures(0);
+    vector<vector<pair<long long, long long>>> timings(num_readers);
+    vector<thread> readers;
+    for(unsigned int r = 0; r < num_readers; r++){
+        readers.push_back(thread([&, r](){
+            timings[r].reserve(1 << 22);
+            for(unsigned int i = r; !stop.load(); i += num_readers){
+                unsigned int q = i % prefixes.size();
+                Clock::time_point start = Clock::now();
+                vector<string> results =
+                    handle.predictCompletions(prefixes[q], 10);
+                Clock::time_point end = Clock::now();
+                timings[r].push_back(make_pair(
+                    chrono::duration_cast<chrono::nanoseconds>(
+                        start - base).count(),
+                    chrono::duration_cast<chrono::nanoseconds>(
+                        end - start).count()));
+                if(results != expected[q]){
+                    failures++;
+                }
+            }
+        }));
+    }
+
+    // Steady phase, then rebuild and swap, recording when each swap ran
+    this_thread::sleep_for(chrono::milliseconds(RELOAD_STEADY_MS));
+    long long reload_begin = chrono::duration_cast<chrono::nanoseconds>(
+            Clock::now() - base).count();
+    vector<pair<long long, long long>> swaps;
+    for(unsigned int i = 0; i < num_reloads; i++){
+        ifstream dict_in(dict_filename, ios::binary);
+        DictionaryTrie* next = new DictionaryTrie();
+        Utils::load_dict(*next, dict_in);
+        next->buildCompletionCache(DEFAULT_CACHE_K);
+        long long swap_begin = chrono::duration_cast<chrono::nanoseconds>(
+                Clock::now() - base).count();
+        handle.publish(next);
+        long long swap_end = chrono::duration_cast<chrono::nanoseconds>(
+                Clock::now() - base).count();
+        swaps.push_back(make_pair(swap_begin, swap_end));
+        while(handle.reclaim() > 0){
+            this_thread::sleep_for(chrono::milliseconds(1));
+        }
+    }
+    long long reload_end = chrono::duration_cast<chrono::nanoseconds>(
+            Clock::now() - base).count();
+    stop = true;
+    for(thread& reader : readers){
+        reader.join();
+    }
+
+    vector<long long> steady, reloading, swapping;
+    for(unsigned int r = 0; r < num_readers; r++){
+        for(const pair<long long, long long>& timing : timings[r]){
+            long long start = timing.first;
+            long long end = timing.first + timing.second;
+            if(end < reload_begin){
+                steady.push_back(timing.second);
+                continue;
+            }
+            if(start > reload_end){
+                continue;
+            }
+            reloading.push_back(timing.second);
+            for(const pair<long long, long long>& swap : swaps){
+                if(end >= swap.first - SWAP_WINDOW &&
+                        start <= swap.second + SWAP_WINDOW){
+                    swapping.push_back(timing.second);
+                    break;
+                }
+            }
+        }
+    }
+    printLatencies("Steady", steady);
+    printLatencies("During reloads", reloading);
+    printLatencies("Around swaps", swapping);
+    long long steady_p99 = percentile(steady, 0.99);
+    long long swap_p99 = percentile(swapping, 0.99);
+    cout << "\tGenerations published: " << handle.generation()
+        << ", wrong results: " << failures << endl;
+    cout << "\tSwap p99 / steady p99: " << (double)swap_p99 / steady_p99
+        << endl;
+}
+
+/*
+ * Times predictFuzzy on prefixes of 2 to 8 chars of words spread over the
+ * dictionary, each with one typo (a substituted, dropped or doubled char),
+ * and prints the latency percentiles at 1 and 2 edits
+ */
+void fuzzyLatency(string dict_filename, unsigned int num_queries){
+
+    ifstream in(dict_filename, ios::binary);
+    DictionaryTrie dictionary_trie;
+    Utils::load_dict(dictionary_trie, in);
+    in.clear();
+    in.seekg(0, ios::beg);
+    vector<string> words;
+    Utils::load_dict(words, in);
+    vector<string> prefixes;
+    for(unsigned int i = 0; i < num_queries && !words.empty(); i++){
+        string prefix = words[(i * 7919ULL) % words.size()].substr(0,
+                2 + i % 7);
+        unsigned int at = (i / 3) % prefix.size();
+        if(i % 3 == 0){
+            prefix[at] = 'a' + (prefix[at] + 1 - 'a' + 26) % 26;
+        }
+        else if(i % 3 == 1){
+            prefix.erase(at, 1);
+        }
+        else{
+            prefix.insert(at, 1, prefix[at]);
+        }
+        prefixes.push_back(prefix);
+    }
+
+    cout << "\nFuzzy completions: " << prefixes.size()
+        << " typo'd prefixes, num_completions= 10" << endl;
+    for(unsigned int max_edits = 1; max_edits <= 2; max_edits++){
+        vector<long long> latencies;
+        latencies.reserve(prefixes.size());
+        Timer T;
+        for(const string& prefix : prefixes){
+            T.begin_timer();
+            vector<string> results =
+                dictionary_trie.predictFuzzy(prefix, max_edits, 10);
+            latencies.push_back(T.end_timer());
+        }
+        string label = "maxEdits=" + to_string(max_edits);
+        printLatencies(label.c_str(), latencies);
+    }
+}
+
+/*
+ * Times every pattern with predictUnderscore, or with predictPattern if
+ * general is set, printing per pattern its number of matches, the latency
+ * percentiles and the heap allocations and bytes of one query. Results of
+ * predictUnderscore are checked against predictPattern.
+ */
+void timePatterns(DictionaryTrie& dictionary_trie,
+        const vector<string>& patterns, bool general,
+        unsigned int repetitions){
+
+    for(const string& pattern : patterns){
+        auto query = [&](){
+            return general ? dictionary_trie.predictPattern(pattern, 10) :
+                dictionary_trie.predictUnderscore(pattern, 10);
+        };
+        if(query() != dictionary_trie.predictPattern(pattern, 10)){
+            cout << "\tpattern= \"" << pattern << "\": RESULTS DIFFER" << endl;
+        }
+        unsigned long long before = allocations;
+        unsigned long long bytes_before = allocatedBytes;
+        countingAllocations = true;
+        query();
+        countingAllocations = false;
+        unsigned long long query_allocations = allocations - before;
+        unsigned long long query_bytes = allocatedBytes - bytes_before;
+        vector<long long> latencies;
+        Timer T;
+        for(unsigned int i = 0; i < repetitions; i++){
+            T.begin_timer();
+            query();
+            latencies.push_back(T.end_timer());
+        }
+        unsigned int matches =
+            dictionary_trie.predictPattern(pattern, UINT_MAX).size();
+        string label = "pattern= \"" + pattern + "\" (" + to_string(matches)
+            + " matches)";
+        printLatencies(label.c_str(), latencies);
+        cout << "\t\t" << query_allocations << " allocations, "
+            << query_bytes << " bytes" << endl;
+    }
+}
+
+/*
+ * Times predictUnderscore on patterns from narrow ("hel_") to ones with a
+ * leading underscore that search below every first char ("_s", "_tion")
+ */
+void underscoreSuite(string dict_filename, unsigned int repetitions){
+
+    ifstream in(dict_filename, ios::binary);
+    DictionaryTrie dictionary_trie;
+    Utils::load_dict(dictionary_trie, in);
+
+    vector<string> patterns = {"hel_", "c_t", "th_", "a_", "_at", "s_ing",
+        "_e", "_s", "_ed", "_ing", "_tion", "_"};
+    cout << "\nUnderscore queries: num_completions= 10, " << repetitions
+        << " runs each" << endl;
+    timePatterns(dictionary_trie, patterns, false, repetitions);
+}
+
+/*
+ * Times predictPattern on crossword style patterns, fixed length runs of
+ * underscores with a few known chars, which the word length bounds of the
+ * nodes keep from scanning the whole dictionary
+ */
+void crosswordSuite(string dict_filename, unsigned int repetitions){
+
+    ifstream in(dict_filename, ios::binary);
+    DictionaryTrie dictionary_trie;
+    Utils::load_dict(dictionary_trie, in);
+
+    vector<string> patterns = {"_____ing", "______ing", "___", "__e__",
+        "_a_e", "s____", "c___t_y", "____s", "_______tion", "x_____",
+        "___________", "________________"};
+    cout << "\nCrossword queries: num_completions= 10, " << repetitions
+        << " runs each" << endl;
+    timePatterns(dictionary_trie, patterns, true, repetitions);
+}
+
+/*
+ * Times top 10 substring queries on the substring index built next to the
+ * trie, reports what the index costs in memory, and checks a sample of the
+ * queries against a linear scan of the words, which it times as well
+ */
+void substringLatency(string dict_filename, unsigned int num_queries){
+
+    Timer T;
+    long long time_duration;
+
+    ifstream in(dict_filename, ios::binary);
+    DictionaryTrie dictionary_trie;
+    SubstringIndex substring_index;
+    T.begin_timer();
+    Utils::load_dict(dictionary_trie, substring_index, in);
+    time_duration = T.end_timer();
+    in.clear();
+    in.seekg(0, ios::beg);
+    vector<string> words;
+    Utils::load_dict(words, in);
+    vector<string> substrings;
+    for(unsigned int i = 0; i < num_queries && !words.empty(); i++){
+        const string& word = words[(i * 7919ULL) % words.size()];
+        unsigned int length = 1 + i % 5;
+        unsigned int at = word.size() > length ?
+            (i / 5) % (word.size() - length + 1) : 0;
+        substrings.push_back(word.substr(at, length));
+    }
+
+    cout << "\nSubstring index: " << substring_index.size() << " words"
+        << endl;
+    cout << "\tLoad time (trie and index): " << time_duration
+        << " nanoseconds." << endl;
+    cout << "\tIndex memory: " << substring_index.memoryUsage()
+        << " bytes, " << (double)substring_index.memoryUsage() /
+        substring_index.size() << " bytes per word" << endl;
+    cout << "\tTrie memory: " << dictionary_trie.memoryUsage() << " bytes"
+        << endl;
+
+    cout << "\nSubstring queries: " << substrings.size()
+        << " substrings, num_completions= 10" << endl;
+    vector<long long> latencies;
+    latencies.reserve(substrings.size());
+    for(const string& substring : substrings){
+        T.begin_timer();
+        vector<string> results =
+            substring_index.predictSubstring(substring, 10);
+        latencies.push_back(T.end_timer());
+    }
+    printLatencies("index", latencies);
+
+    vector<int> frequencies;
+    frequencies.reserve(words.size());
+    for(const string& word : words){
+        frequencies.push_back(dictionary_trie.frequency(word));
+    }
+    latencies.clear();
+    unsigned int mismatches = 0;
+    for(unsigned int i = 0; i < substrings.size() && i < SUBSTRING_SCANS;
+            i++){
+        T.begin_timer();
+        priority_queue<Word, vector<Word>, Word> best;
+        for(unsigned int j = 0; j < words.size(); j++){
+            if(words[j].find(substrings[i]) == string::npos){
+                continue;
+            }
+            best.push(Word(words[j], frequencies[j]));
+            if(best.size() > 10){
+                best.pop();
+            }
+        }
+        vector<string> expected(best.size());
+        for(unsigned int j = expected.size(); j > 0; j--){
+            expected[j-1] = best.top().s;
+            best.pop();
+        }
+        latencies.push_back(T.end_timer());
+        if(substring_index.predictSubstring(substrings[i], 10) != expected){
+            mismatches++;
+        }
+    }
+    printLatencies("linear scan", latencies);
+    cout << "\t" << mismatches << " of " << latencies.size()
+        << " scanned substrings differ from the index" << endl;
+}
+
+/*
+ * Prints the time and the cache misses per query of one pass over the
+ * prefixes, or that the hardware counters are unavailable
+ */
+void printMisses(const char* label, long long time_duration,
+        long long cache_misses, long long l1_misses, size_t num_queries){
+    cout << "\t" << label << ": " << time_duration / num_queries << " ns";
+    if(cache_misses >= 0){
+        cout << ", " << (double)cache_misses / num_queries
+            << " cache misses";
+    }
+    if(l1_misses >= 0){
+        cout << ", " << (double)l1_misses / num_queries << " L1D misses";
+    }
+    cout << " per query" << endl;
+}
+
+/*
+ * Compiles the dictionary to a frozen image in pool order and in cache
+ * order, and for each one times find and top 10 completions on prefixes of
+ * words spread over the dictionary, with the cache misses per query from
+ * the hardware counters where the host has them
+ */
+void layoutMisses(string dict_filename, unsigned int num_queries){
+
+    ifstream in(dict_filename, ios::binary);
+    DictionaryTrie dictionary_trie;
+    Utils::load_dict(dictionary_trie, in);
+    in.clear();
+    in.seekg(0, ios::beg);
+    vector<string> words;
+    Utils::load_dict(words, in);
+    vector<string> prefixes;
+    for(unsigned int i = 0; i < num_queries && !words.empty(); i++){
+        const string& word = words[(i * 7919ULL) % words.size()];
+        prefixes.push_back(word.substr(0, 1 + i % word.size()));
+    }
+
+    CacheCounters counters;
+    if(!counters.available()){
+        cout << "\nHardware cache counters unavailable, timing only."
+            << endl;
+    }
+    const char* names[] = {"Pool order", "Cache order"};
+    FrozenDictionaryTrie::NodeOrder orders[] = {
+        FrozenDictionaryTrie::POOL_ORDER, FrozenDictionaryTrie::CACHE_ORDER};
+    for(unsigned int i = 0; i < 2; i++){
+        if(!FrozenDictionaryTrie::compile(dictionary_trie, IMAGE_FILENAME,
+                    orders[i])){
+            cout << "\tCould not write " << IMAGE_FILENAME << endl;
+            return;
+        }
+        FrozenDictionaryTrie frozen_trie;
+        if(!frozen_trie.open(IMAGE_FILENAME)){
+            cout << "\tCould not map " << IMAGE_FILENAME << endl;
+            remove(IMAGE_FILENAME);
+            return;
+        }
+        cout << "\n" << names[i] << ": " << frozen_trie.nodeCount()
+            << " nodes, " << frozen_trie.memoryUsage() << " bytes, "
+            << prefixes.size() << " prefixes" << endl;
+
+        Timer T;
+        long long cache_misses;
+        long long l1_misses;
+        unsigned int found = 0;
+        counters.begin_count();
+        T.begin_timer();
+        for(const string& prefix : prefixes){
+            found += frozen_trie.find(prefix);
+        }
+        long long time_duration = T.end_timer();
+        counters.end_count(cache_misses, l1_misses);
+        printMisses("find", time_duration, cache_misses, l1_misses,
+                prefixes.size());
+
+        size_t completions = 0;
+        counters.begin_count();
+        T.begin_timer();
+        for(const string& prefix : prefixes){
+            completions += frozen_trie.predictCompletions(prefix, 10).size();
+        }
+        time_duration = T.end_timer();
+        counters.end_count(cache_misses, l1_misses);
+        printMisses("completions", time_duration, cache_misses, l1_misses,
+                prefixes.size());
+        cout << "\t" << found << " words found, " << completions
+            << " completions" << endl;
+        frozen_trie.close();
+    }
+    remove(IMAGE_FILENAME);
+}
+
+/*
+ * Times find, top 10 completions and top 10 underscore patterns on one
+ * engine, printing the latency percentiles of each kind of query
+ */
+template <class Dictionary>
+void timeEngine(const char* label, Dictionary& dictionary,
+        const vector<string>& prefixes, const vector<string>& patterns){
+
+    cout << "\n" << label << endl;
+    Timer T;
+    vector<long long> latencies;
+    latencies.reserve(prefixes.size());
+    unsigned int found = 0;
+    for(const string& prefix : prefixes){
+        T.begin_timer();
+        found += dictionary.find(prefix);
+        latencies.push_back(T.end_timer());
+    }
+    printLatencies("find", latencies);
+    latencies.clear();
+    for(const string& prefix : prefixes){
+        T.begin_timer();
+        vector<string> results = dictionary.predictCompletions(prefix, 10);
+        latencies.push_back(T.end_timer());
+    }
+    printLatencies("completions", latencies);
+    latencies.clear();
+    for(const string& pattern : patterns){
+        T.begin_timer();
+        vector<string> results = dictionary.predictUnderscore(pattern, 10);
+        latencies.push_back(T.end_timer());
+    }
+    printLatencies("underscore", latencies);
+    cout << "\t" << found << " prefixes are words" << endl;
+}
+
+/*
+ * Builds the TST and the adaptive radix tree from the same dictionary and
+ * runs the same queries on both side by side, the TST with each of its
+ * completion engines: find and completions on prefixes of words spread over
+ * the dictionary, and underscore patterns made by blanking one char of
+ * those words. Every query is checked to give the same results on both
+ * trees.
+ */
+void compareEngines(string dict_filename, unsigned int num_queries){
+
+    Timer T;
+    ifstream in(dict_filename, ios::binary);
+    DictionaryTrie dictionary_trie;
+    T.begin_timer();
+    Utils::load_dict(dictionary_trie, in);
+    long long trie_load = T.end_timer();
+    in.clear();
+    in.seekg(0, ios::beg);
+    RadixDictionaryTrie radix_trie;
+    T.begin_timer();
+    Utils::load_dict(radix_trie, in);
+    long long radix_load = T.end_timer();
+    in.clear();
+    in.seekg(0, ios::beg);
+    vector<string> words;
+    Utils::load_dict(words, in);
+    vector<string> prefixes;
+    vector<string> patterns;
+    for(unsigned int i = 0; i < num_queries && !words.empty(); i++){
+        const string& word = words[(i * 7919ULL) % words.size()];
+        prefixes.push_back(word.substr(0, 1 + i % word.size()));
+        string pattern = word;
+        pattern[(i / 7) % word.size()] = UNDERSCORE;
+        patterns.push_back(pattern);
+    }
+
+    cout << "\nTST: " << dictionary_trie.nodeCount() << " nodes, "
+        << dictionary_trie.memoryUsage() << " bytes, load time "
+        << trie_load << " nanoseconds." << endl;
+    cout << "Radix tree: " << radix_trie.nodeCount() << " nodes, "
+        << radix_trie.memoryUsage() << " bytes, load time "
+        << radix_load << " nanoseconds." << endl;
+    timeEngine("TST, exhaustive search", dictionary_trie, prefixes,
+            patterns);
+    dictionary_trie.setCompletionEngine(DictionaryTrie::BEST_FIRST);
+    timeEngine("TST, best first search", dictionary_trie, prefixes,
+            patterns);
+    timeEngine("Radix tree", radix_trie, prefixes, patterns);
+
+    unsigned int mismatches = 0;
+    for(unsigned int i = 0; i < prefixes.size(); i++){
+        if(dictionary_trie.find(prefixes[i]) != radix_trie.find(prefixes[i])
+                || dictionary_trie.predictCompletions(prefixes[i], 10) !=
+                radix_trie.predictCompletions(prefixes[i], 10) ||
+                dictionary_trie.predictUnderscore(patterns[i], 10) !=
+                radix_trie.predictUnderscore(patterns[i], 10)){
+            mismatches++;
+        }
+    }
+    cout << "\n\t" << mismatches << " of " << prefixes.size()
+        << " queries differ between the engines" << endl;
+}
+
 int main(int argc, char *argv[]) {
 
     if(argc < 2){
         cout << "Incorrect number of arguments." << endl;
-        cout << "\t First argument: name of dictionary file." << endl;
+        cout << "\t First argument: name of dictionary file, or --stress"
+            << endl;
+        cout << "\t or --build-scaling dictionary_file [num_lines]" << endl;
+        cout << "\t or --concurrent dictionary_file [num_queries]" << endl;
+        cout << "\t or --concurrent-writes dictionary_file [ops_per_writer]"
+            << endl;
+        cout << "\t or --reload dictionary_file [num_reloads]" << endl;
+        cout << "\t or --fuzzy dictionary_file [num_queries]" << endl;
+        cout << "\t or --underscore dictionary_file [repetitions]" << endl;
+        cout << "\t or --crossword dictionary_file [repetitions]" << endl;
+        cout << "\t or --substring dictionary_file [num_queries]" << endl;
+        cout << "\t or --layout dictionary_file [num_queries]" << endl;
+        cout << "\t or --engines dictionary_file [num_queries]" << endl;
+        cout << "\t or --build-repeats [num_words]" << endl;
         cout << endl;
         exit(-1);
     }
 
+    if(string(argv[1]) == "--stress"){
+        stressSorted(1000000, 1000000);
+        return 0;
+    }
+
+    if(string(argv[1]) == "--build-repeats"){
+        checkBuildRepeats(argc >= 3 ? stoul(argv[2]) : REPEAT_WORDS);
+        return 0;
+    }
+
+    if(string(argv[1]) == "--build-scaling" && argc >= 3){
+        buildScaling(argv[2], argc >= 4 ? stoul(argv[3]) : SCALING_LINES);
+        return 0;
+    }
+
+    if(string(argv[1]) == "--concurrent" && argc >= 3){
+        concurrentQueries(argv[2],
+                argc >= 4 ? stoul(argv[3]) : CONCURRENT_QUERIES);
+        return 0;
+    }
+
+    if(string(argv[1]) == "--concurrent-writes" && argc >= 3){
+        stressConcurrentWrites(argv[2], 4, 4,
+                argc >= 4 ? stoul(argv[3]) : WRITE_STRESS_OPS);
+        return 0;
+    }
+
+    if(string(argv[1]) == "--reload" && argc >= 3){
+        reloadLatency(argv[2], 2, argc >= 4 ? stoul(argv[3]) : 3);
+        return 0;
+    }
+
+    if(string(argv[1]) == "--fuzzy" && argc >= 3){
+        fuzzyLatency(argv[2], argc >= 4 ? stoul(argv[3]) : FUZZY_QUERIES);
+        return 0;
+    }
+
+    if(string(argv[1]) == "--underscore" && argc >= 3){
+        underscoreSuite(argv[2],
+                argc >= 4 ? stoul(argv[3]) : UNDERSCORE_REPETITIONS);
+        return 0;
+    }
+
+    if(string(argv[1]) == "--crossword" && argc >= 3){
+        crosswordSuite(argv[2],
+                argc >= 4 ? stoul(argv[3]) : UNDERSCORE_REPETITIONS);
+        return 0;
+    }
+
+    if(string(argv[1]) == "--substring" && argc >= 3){
+        substringLatency(argv[2],
+                argc >= 4 ? stoul(argv[3]) : SUBSTRING_QUERIES);
+        return 0;
+    }
+
+    if(string(argv[1]) == "--layout" && argc >= 3){
+        layoutMisses(argv[2], argc >= 4 ? stoul(argv[3]) : LAYOUT_QUERIES);
+        return 0;
+    }
+
+    if(string(argv[1]) == "--engines" && argc >= 3){
+        compareEngines(argv[2], argc >= 4 ? stoul(argv[3]) : ENGINE_QUERIES);
+        return 0;
+    }
+
     testStudent(argv[1]);
 
 }
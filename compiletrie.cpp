@@ -0,0 +1,60 @@
+/** Filename: compiletrie.cpp
+ *  Name: Loc Chuong
+ *  Userid: cs100sp19aj
+ *  Description: Offline compiler for dictionary images. It loads a
+ *               dictionary file into a DictionaryTrie once and writes the
+ *               image that autocomplete and FrozenDictionaryTrie map at
+ *               startup instead of parsing the dictionary again.
+ *  Date: 5/2/2019
+ */
+
+#include "DictionaryTrie.hpp"
+#include "FrozenDictionaryTrie.hpp"
+#include "util.hpp"
+#include <iostream>
+#include <fstream>
+#include <string>
+#define DICT_ARG 1
+#define IMAGE_ARG 2
+#define MAX_ARG 3
+
+using namespace std;
+
+/** Function Name: main(int argc, char** argv)
+ *  Description: Compiles the dictionary file given as first argument to the
+ *               image named by the second argument.
+ *  Parameters: argc - Number of arguments passed in by the user
+ *              argv - Pointer to the actual arguments passed in by user
+ */
+int main(int argc, char** argv) {
+    /** Check for correct number of arguments */
+    if( argc != MAX_ARG) {
+        cout << "Usage: " << argv[0] << " dictionary_file image_file"
+            << endl;
+        return -1;
+    }
+    /** Read in file */
+    ifstream readFile(argv[DICT_ARG], ios::in | ios::binary);
+    /** Checks for invalid file */
+    if( !readFile) {
+        cout << "Could not open file or invalid file" << endl;
+        return -1;
+    }
+    DictionaryTrie dict;
+    cout << "Reading file: " << argv[DICT_ARG] << endl;
+    Utils::load_dict(dict, readFile);
+    cout << "Writing image: " << argv[IMAGE_ARG] << endl;
+    if( !FrozenDictionaryTrie::compile(dict, argv[IMAGE_ARG])) {
+        cout << "Could not write image" << endl;
+        return -1;
+    }
+    /** Chains without branching are folded, so the image has fewer nodes */
+    FrozenDictionaryTrie image;
+    if( !image.open(argv[IMAGE_ARG])) {
+        cout << "Could not read back image" << endl;
+        return -1;
+    }
+    cout << image.nodeCount() << " nodes written for " << dict.nodeCount()
+        << " trie nodes" << endl;
+    return 0;
+}
@@ -11,26 +11,174 @@
 #include <iostream>
 #include <fstream>
 #include "BloomFilter.hpp"
+#include "BlockedBloomFilter.hpp"
+#include "UrlPipeline.hpp"
+#include <chrono>
+#include <cmath>
+#include <cstdlib>
 #include <iomanip>
+#include <string_view>
+#include <vector>
 #define MAX_ARG 4 /** Defines number of max arguments allowed to pass in */
 #define BADURL_ARG 1 /** Defines the argument index for bad url file */
 #define MIXEDURL_ARG 2 /** Defines the argument index of mixed url file */
 #define GOODURL_ARG 3 /** Defines the argument index of output file */
+#define MIXED_BLOCK 4096 /** Mixed urls looked up with one findBatch */
+#define BLOCKED_FLAG "--blocked" /** Flag selecting the blocked bloom
+                                  *  filter */
+#define FP_RATE_FLAG "--fp-rate" /** Flag followed by the target false
+                                  *  positive rate */
+#define THREADS_FLAG "--threads" /** Flag followed by the number of worker
+                                  *  threads, selecting the pipeline */
+#define BAD_COUNT_FLAG "--bad-count" /** Flag followed by the number of bad
+                                      *  urls, in place of an estimate */
+#define BYTES_PER_MB 1e6 /** Bytes in a megabyte */
 
 using namespace std;
 
+/** Function Name: filterUrls(Filter & BF, const char * badUrlName,
+ *                      istream & badUrlFile, istream & mixedUrlFile,
+ *                      ostream & outputFile, unsigned int numThreads,
+ *                      double & badUrl)
+ *  Description: Populates the bloom filter with the bad urls, then writes
+ *               every mixed url it does not find to the output file. With
+ *               no threads the mixed urls are read MIXED_BLOCK lines at a
+ *               time and looked up together with findBatch. With threads
+ *               the bad url file is split between that many threads, all
+ *               inserting at once with insertAtomic, and the mixed urls go
+ *               through a UrlPipeline of that many workers.
+ *  Parameters: BF - The empty bloom filter to use
+ *              badUrlName - Name of the bad url file
+ *              badUrlFile - The bad urls, one per line
+ *              mixedUrlFile - The urls to filter, one per line
+ *              outputFile - Where the good urls are written
+ *              numThreads - Worker threads of the pipeline, 0 for none
+ *              badUrl - Set to the number of bad urls when they were not
+ *                       counted beforehand, that is with threads
+ *  Return Value: The numbers of mixed urls, urls written and bytes read,
+ *                and the time taken to filter them
+ */
+template <class Filter>
+PipelineStats filterUrls(Filter & BF, const char * badUrlName,
+        istream & badUrlFile, istream & mixedUrlFile, ostream & outputFile,
+        unsigned int numThreads, double & badUrl) {
+    if( numThreads > 0) {
+        /** Populate the bloom filter with the bad urls, in one read split
+         *  between the threads */
+        badUrl = UrlPipeline::forEachLineParallel(badUrlName, numThreads,
+                [&BF](string_view url) { BF.insertAtomic(url); });
+        /** Filled, the filter is only read, by every worker at once */
+        const Filter & filter = BF;
+        UrlPipeline pipeline(numThreads);
+        return pipeline.run(mixedUrlFile, outputFile,
+                [&filter](const vector<string_view> & urls) {
+                    return filter.findBatch(urls); });
+    }
+    /** Stores a line of the file */
+    string line;
+    /** Totals of the mixed url file */
+    PipelineStats stats = {0, 0, 0, 0};
+    /** Populate the bloom filter with the bad urls */
+    while(getline(badUrlFile, line)) {
+        BF.insert(line);
+    }
+    chrono::steady_clock::time_point start = chrono::steady_clock::now();
+    /** Lines of the mixed url file waiting to be looked up */
+    vector<string> block;
+    /** Go through every line of the mixed url file */
+    while( true) {
+        block.clear();
+        while( block.size() < MIXED_BLOCK && getline(mixedUrlFile, line)) {
+            block.push_back(line);
+            stats.bytes += line.size() + 1;
+        }
+        if( block.empty()) {
+            break;
+        }
+        /** Increment number of total urls */
+        stats.lines += block.size();
+        vector<uint64_t> found = BF.findBatch(
+                vector<string_view>(block.begin(), block.end()));
+        for( size_t j = 0; j < block.size(); j++) {
+            /** Found bad url */
+            if( !((found[j / BITMAP_WORD_BITS] >> j % BITMAP_WORD_BITS) & 1)) {
+                /** Increment number of urls outputted */
+                stats.kept++;
+                /** Write line to output file, flushed once at the end */
+                outputFile << block[j] << '\n';
+            }
+        }
+    }
+    outputFile.flush();
+    stats.seconds = chrono::duration<double>(chrono::steady_clock::now() -
+            start).count();
+    return stats;
+}
+
 /** Function Name: main(int argc, char** argv)
  *  Description: The main driver of the firewall program. This program will
  *               take in 3 arguments: (1) the bad urls, (2) the mixed urls, and
  *               (3) the output file name. The program will populate a bloom
  *               filter with the bad urls and pick out the good urls
  *               from the mixed urls ultimately placing the good urls into
- *               the output file.
+ *               the output file. Before the 3 arguments may come
+ *               BLOCKED_FLAG, to use a BlockedBloomFilter, FP_RATE_FLAG
+ *               with a rate p, to size the filter for p with the optimal
+ *               number of bits and hashes in place of 1.5 bytes per bad url,
+ *               or with the fewest blocks meeting p for a BlockedBloomFilter,
+ *               and THREADS_FLAG with a number of workers, to filter
+ *               through a UrlPipeline. The pipeline reads the bad urls once,
+ *               sizing the filter from BAD_COUNT_FLAG with their number or
+ *               else from an estimate based on the file size.
  *  Parameters: argc - The number of arguments passed in by user
  *              argv - An array of char * representing user's arguments
  *  Return Value: An int representing the success of the program
  */
 int main(int argc, char** argv) {
+    /** The blocked bloom filter probes one cache line per url */
+    bool blocked = false;
+    /** Target false positive rate, 0 when the filter is sized in bytes */
+    double fpRate = 0;
+    /** Worker threads of the pipeline, 0 to filter on this thread */
+    unsigned int numThreads = 0;
+    /** Number of bad urls given, 0 to estimate it */
+    size_t badCount = 0;
+    /** Consume the flags, leaving the file arguments after argv[0] */
+    while( argc > MAX_ARG) {
+        string flag = argv[1];
+        if( flag == BLOCKED_FLAG) {
+            blocked = true;
+            argv++;
+            argc--;
+        }
+        else if( flag == FP_RATE_FLAG) {
+            fpRate = atof(argv[2]);
+            if( !(fpRate > 0 && fpRate < 1)) {
+                cout << "The false positive rate must be between 0 and 1!"
+                    << endl;
+                return -1;
+            }
+            argv += 2;
+            argc -= 2;
+        }
+        else if( flag == THREADS_FLAG) {
+            numThreads = atoi(argv[2]);
+            if( numThreads == 0) {
+                cout << "The number of threads must be at least 1!" << endl;
+                return -1;
+            }
+            argv += 2;
+            argc -= 2;
+        }
+        else if( flag == BAD_COUNT_FLAG) {
+            badCount = strtoull(argv[2], nullptr, 10);
+            argv += 2;
+            argc -= 2;
+        }
+        else {
+            break;
+        }
+    }
     /** Check for correct number of arguments */
     if( argc != MAX_ARG) {
         cout << "This program requires 3 arguments!" << endl;
@@ -50,48 +198,75 @@ int main(int argc, char** argv) {
     size_t numBytes = 0;
     /** Number of lines in the bad url text file */
     double badUrl = 0;
-    /** Number of lines in the output url text file */
-    double outputUrl = 0;
-    /** Number of lines in the good url text file */
-    double safeUrl = 0;
 
-    /** Go through each line of bad url file and count lines */ 
-    while(getline(badUrlFile, line)) {
-        /** Increment number of bad url lines */
-        badUrl++;
-        /** Increment number of bad url lines to be used as num of bytes */
-        numBytes++;
+    /** Bad urls the filter is sized for */
+    double expectedUrl = 0;
+    if( numThreads > 0) {
+        /** Given or estimated, the pipeline reads the bad urls only once */
+        expectedUrl = badCount > 0 ? badCount :
+            UrlPipeline::estimateLines(badUrlFile);
+    }
+    else {
+        /** Go through each line of bad url file and count lines */
+        while(getline(badUrlFile, line)) {
+            /** Increment number of bad url lines */
+            badUrl++;
+        }
+        expectedUrl = badUrl;
+        /** Clear eof flag */
+        badUrlFile.clear();
+        /** Seek back to start of file */
+        badUrlFile.seekg(0, ios::beg);
     }
     /** Assign value to numBytes to be (1.5)*(number of bad urls) */
-    numBytes = ((numBytes*3)/2);
-    /** Create BloomFilter object to store bad urls */
-    BloomFilter BF(numBytes);
-    /** Clear eof flag */
-    badUrlFile.clear();
-    /** Seek back to start of file */
-    badUrlFile.seekg(0, ios::beg);
-    /** Populate the bloom filter with the bad urls */
-    while(getline(badUrlFile, line)) {
-        BF.insert(line);
+    numBytes = (((size_t) expectedUrl*3)/2);
+    /** Or the optimal -n ln(p) / ln(2)^2 bits for the target rate */
+    if( fpRate > 0) {
+        numBytes = ceil(-expectedUrl * log(fpRate) / (log(2.0) * log(2.0)) /
+                BYTE_WIDTH);
     }
 
     /** Open output file using arg from user to write to */
     outputFile.open(argv[GOODURL_ARG], fstream::in | fstream::out |
             fstream::trunc);
-    /** Go through every line of the mixed url file */
-    while(getline(mixedUrlFile, line)) {
-        /** Increment number of total urls */
-        safeUrl++;
-        /** Found bad url */
-        if( !(BF.find(line))) {
-            /** Increment number of urls outputted */
-            outputUrl++;
-            /** Write line to output file */
-            outputFile << line << endl; 
-        }
+    /** Numbers of mixed urls and of urls written */
+    PipelineStats counts;
+    if( blocked && fpRate > 0) {
+        /** Create BlockedBloomFilter sized for the rate to store bad urls,
+         *  its blocks need more bytes than the optimum above */
+        BlockedBloomFilter BF(expectedUrl, fpRate);
+        numBytes = BF.memoryUsage();
+        cout << "Filter bytes: " << BF.memoryUsage() << endl;
+        counts = filterUrls(BF, argv[BADURL_ARG], badUrlFile,
+                mixedUrlFile, outputFile, numThreads, badUrl);
+    }
+    else if( blocked) {
+        /** Create BlockedBloomFilter object to store bad urls */
+        BlockedBloomFilter BF(numBytes);
+        cout << "Filter bytes: " << BF.memoryUsage() << endl;
+        counts = filterUrls(BF, argv[BADURL_ARG], badUrlFile,
+                mixedUrlFile, outputFile, numThreads, badUrl);
+    }
+    else if( fpRate > 0) {
+        /** Create BloomFilter sized for the rate to store bad urls */
+        BloomFilter BF(expectedUrl, fpRate);
+        cout << "Filter bytes: " << BF.memoryUsage() << ", hashes: "
+            << BF.hashCount() << endl;
+        counts = filterUrls(BF, argv[BADURL_ARG], badUrlFile,
+                mixedUrlFile, outputFile, numThreads, badUrl);
+    }
+    else {
+        /** Create BloomFilter object to store bad urls */
+        BloomFilter BF(numBytes);
+        cout << "Filter bytes: " << BF.memoryUsage() << ", hashes: "
+            << BF.hashCount() << endl;
+        counts = filterUrls(BF, argv[BADURL_ARG], badUrlFile,
+                mixedUrlFile, outputFile, numThreads, badUrl);
     }
     /** Calculate number of safe urls */
-    safeUrl = safeUrl - badUrl;
+    double safeUrl = counts.lines - badUrl;
+    /** Number of lines in the output url text file */
+    double outputUrl = counts.kept;
     /** Calculate the rate of false positives */
     double rate = ((safeUrl - outputUrl)/safeUrl);
 
@@ -105,6 +280,16 @@ int main(int argc, char** argv) {
     cout.precision(4);
     /** Print out Saved memory ratio */
     cout << "Saved memory ratio: " << fixed << memoryRate << endl;
+    if( numThreads > 0 && badCount == 0) {
+        /** Print out how close the estimate the filter was sized for was */
+        cout << "Bad urls estimated: " << setprecision(0) << expectedUrl
+            << ", read: " << badUrl << endl;
+    }
+    /** Print out the throughput of filtering the mixed urls */
+    cout << "Filtered " << counts.lines << " urls (" << setprecision(1)
+        << counts.bytes / BYTES_PER_MB << " MB) in " << setprecision(3)
+        << counts.seconds << " seconds: " << setprecision(1)
+        << counts.bytes / BYTES_PER_MB / counts.seconds << " MB/s" << endl;
     /** Close output file */
     outputFile.close();
 }
@@ -1,12 +1,24 @@
 #include <iostream>
 #include <sstream>
+#include <utility>
+#include <climits>
+#include <cstring>
+#include <string_view>
 #include "util.hpp"
+#ifdef __linux__
+#include <linux/perf_event.h>
+#include <sys/ioctl.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+#endif
+#define READ_CHUNK (1 << 20) /** Bytes read from a dictionary at a time */
 
 using std::istream;
 using std::endl;
 using std::cout;
 using std::istringstream;
 using std::string;
+using std::string_view;
 using std::vector;
 
 /**
@@ -30,6 +42,102 @@ long long Timer::end_timer()
     return (long long)std::chrono::duration_cast<std::chrono::nanoseconds>(end - start).count();
 }
 
+#ifdef __linux__
+/**
+ * Opens one counter of the calling thread, disabled until begin_count.
+ * Returns the perf_event fd, or -1 if the kernel does not offer it.
+ */
+static int openCounter(unsigned int type, unsigned long long config)
+{
+    struct perf_event_attr attr;
+    memset(&attr, 0, sizeof(attr));
+    attr.size = sizeof(attr);
+    attr.type = type;
+    attr.config = config;
+    attr.disabled = 1;
+    attr.exclude_kernel = 1;
+    attr.exclude_hv = 1;
+    return (int)syscall(SYS_perf_event_open, &attr, 0, -1, -1, 0);
+}
+
+/**
+ * Reads a counter stopped by end_count, -1 if it never opened
+ */
+static long long readCounter(int fd)
+{
+    long long count;
+    if( fd < 0 || read(fd, &count, sizeof(count)) != sizeof(count)) {
+        return -1;
+    }
+    return count;
+}
+#endif
+
+/**
+ * Opens the cache miss counters. Both stay -1 where perf_event_open is
+ * missing or refused, in a VM without a virtual PMU for one.
+ */
+CacheCounters::CacheCounters() : cacheMisses(-1), l1Misses(-1)
+{
+#ifdef __linux__
+    cacheMisses = openCounter(PERF_TYPE_HARDWARE,
+            PERF_COUNT_HW_CACHE_MISSES);
+    l1Misses = openCounter(PERF_TYPE_HW_CACHE, PERF_COUNT_HW_CACHE_L1D |
+            PERF_COUNT_HW_CACHE_OP_READ << 8 |
+            PERF_COUNT_HW_CACHE_RESULT_MISS << 16);
+#endif
+}
+
+CacheCounters::~CacheCounters()
+{
+#ifdef __linux__
+    if( cacheMisses >= 0) {
+        close(cacheMisses);
+    }
+    if( l1Misses >= 0) {
+        close(l1Misses);
+    }
+#endif
+}
+
+bool CacheCounters::available() const
+{
+    return cacheMisses >= 0 || l1Misses >= 0;
+}
+
+/**
+ * Zeroes and starts the counters that are open
+ */
+void CacheCounters::begin_count()
+{
+#ifdef __linux__
+    for( int fd : {cacheMisses, l1Misses}) {
+        if( fd >= 0) {
+            ioctl(fd, PERF_EVENT_IOC_RESET, 0);
+            ioctl(fd, PERF_EVENT_IOC_ENABLE, 0);
+        }
+    }
+#endif
+}
+
+/**
+ * Stops the counters and reads the misses counted since begin_count
+ */
+void CacheCounters::end_count(long long& cache_misses, long long& l1_misses)
+{
+    cache_misses = -1;
+    l1_misses = -1;
+#ifdef __linux__
+    for( int fd : {cacheMisses, l1Misses}) {
+        if( fd >= 0) {
+            ioctl(fd, PERF_EVENT_IOC_DISABLE, 0);
+        }
+    }
+    cache_misses = readCounter(cacheMisses);
+    l1_misses = readCounter(l1Misses);
+#endif
+}
+
 /**
  * Parse a line by taking the number at the beginning of a file.
  * This might be helpful if you want make your own test files of
@@ -86,108 +194,205 @@ vector<string> Utils::getWordsFromLine(string& line)
 
 
 /*
- * Load the words in the file into the dictionary trie
+ * True for the characters istream's >> treats as whitespace
  */
-void Utils::load_dict(DictionaryTrie& dict, istream& words)
+static inline bool isBlank(char c)
+{
+    return c == ' ' || (c >= '\t' && c <= '\r');
+}
+
+/*
+ * Reads the stream into buffer READ_CHUNK bytes at a time until it ends or
+ * buffer holds max_lines complete lines. Returns the number of complete
+ * lines in buffer. The stream is left right after the last of them, as a
+ * getline loop would leave it: bytes read past it are handed back with a
+ * seek, or, on a stream that cannot seek, a partial read goes a line at a
+ * time.
+ */
+static unsigned int readChunks(istream& words, string& buffer,
+        unsigned int max_lines)
 {
-    unsigned int freq;
-    string data = "";
-    string temp_word = "";
-    string word = "";
-    vector<string> word_string;
-    unsigned int i = 0;
-    while(getline(words, data))
+    unsigned int lines = 0;
+    if(max_lines != UINT_MAX && words && words.tellg() == streampos(-1))
     {
-        if(words.eof()) break;
-        temp_word = "";
-        word = "";
-        data = data + " .";
-        istringstream iss(data);
-        iss >> freq;
-        while(1)
+        string line;
+        while(lines < max_lines && getline(words, line))
+        {
+            if(words.eof()) break;
+            buffer += line;
+            buffer += '\n';
+            lines++;
+        }
+        return lines;
+    }
+    while(lines < max_lines && words)
+    {
+        size_t old_size = buffer.size();
+        buffer.resize(old_size + READ_CHUNK);
+        words.read(&buffer[old_size], READ_CHUNK);
+        buffer.resize(old_size + words.gcount());
+        const char* it = buffer.data() + old_size;
+        const char* last = buffer.data() + buffer.size();
+        while(lines < max_lines &&
+                (it = (const char*)memchr(it, '\n', last - it)) != nullptr)
         {
-            iss >> temp_word;
-            if(temp_word == ".") break;
-            if(temp_word.length() > 0) word_string.push_back(temp_word);
+            lines++;
+            it++;
         }
-        for(i = 0; i < word_string.size(); i++)
+        if(lines == max_lines && it != last)
         {
-            if(i > 0) word = word + " ";
-            word = word + word_string[i];
+            /** Hand back the bytes after the last line wanted */
+            streamoff excess = last - it;
+            buffer.resize(buffer.size() - excess);
+            words.clear();
+            words.seekg(-excess, ios::cur);
         }
-        dict.insert(word, freq);
-        word_string.clear();
     }
+    return lines;
 }
 
-
 /*
- * Load num_words from words stream into the dictionary trie
+ * Scans the first num_lines lines of buffer in place and calls
+ * entry(word, freq) for each. A line is a frequency followed by the
+ * whitespace separated tokens of the word, which are joined by single
+ * spaces, up to a lone "." token. The tokens are compacted inside the
+ * line, so word is a view into buffer and nothing is allocated. Only
+ * lines ending in '\n' are read and lines without a frequency are skipped,
+ * as in the getline loop this replaces.
  */
-void Utils::load_dict(DictionaryTrie& dict, istream& words, unsigned int num_words)
+template <class Entry>
+static void scanEntries(string& buffer, unsigned int num_lines, Entry entry)
 {
-    unsigned int freq;
-    string data = "";
-    string temp_word = "";
-    string word = "";
-    vector<string> word_string;
-    unsigned int i = 0;
-    unsigned int j = 0;
-    for(; j < num_words; j++)
+    char* it = &buffer[0];
+    char* last = it + buffer.size();
+    for(unsigned int j = 0; j < num_lines; j++)
     {
-        getline(words, data);
-        if(words.eof()) break;
-        temp_word = "";
-        word = "";
-        data = data + " .";
-        istringstream iss(data);
-        iss >> freq;
-        while(1)
+        char* line_end = (char*)memchr(it, '\n', last - it);
+        if(line_end == nullptr) break;
+        while(it < line_end && isBlank(*it)) it++;
+        if(it == line_end || *it < '0' || *it > '9')
+        {
+            it = line_end + 1;
+            continue;
+        }
+        unsigned int freq = 0;
+        while(it < line_end && *it >= '0' && *it <= '9')
         {
-            iss >> temp_word;
-            if(temp_word == ".") break;
-            if(temp_word.length() > 0) word_string.push_back(temp_word);
+            freq = freq * 10 + (*it - '0');
+            it++;
         }
-        for(i = 0; i < word_string.size(); i++)
+        char* word = nullptr;
+        char* word_end = nullptr;
+        while(1)
         {
-            if(i > 0) word = word + " ";
-            word = word + word_string[i];
+            while(it < line_end && isBlank(*it)) it++;
+            if(it == line_end) break;
+            char* token = it;
+            while(it < line_end && !isBlank(*it)) it++;
+            if(it - token == 1 && *token == '.') break;
+            if(word == nullptr)
+            {
+                word = token;
+                word_end = it;
+            }
+            else
+            {
+                /** Tokens only move left, over the blanks before them */
+                *word_end++ = ' ';
+                memmove(word_end, token, it - token);
+                word_end += it - token;
+            }
         }
-        dict.insert(word, freq);
-        word_string.clear();
+        entry(string_view(word, word_end - word), freq);
+        it = line_end + 1;
     }
 }
 
+/*
+ * Load the words in the file into the dictionary trie. The file is read in
+ * big chunks and parsed in place, then the entries are bulk built from
+ * views into it so the trie stays balanced.
+ */
+void Utils::load_dict(DictionaryTrie& dict, istream& words)
+{
+    load_dict(dict, words, UINT_MAX);
+}
+
 
-void Utils::load_dict(vector<string>& dict, istream& words)
+/*
+ * Load num_words from words stream into the dictionary trie. The stream is
+ * left right after the last of those lines.
+ */
+void Utils::load_dict(DictionaryTrie& dict, istream& words, unsigned int num_words)
 {
-    unsigned int junk;
-    string data = "";
-    string temp_word = "";
-    string word = "";
-    vector<string> word_string;
-    unsigned int i = 0;
+    load_dict(dict, words, num_words, 1);
+}
 
-    while(getline(words, data))
+
+/*
+ * Load num_words from words stream into the dictionary trie, sharding the
+ * bulk build over num_threads threads.
+ */
+void Utils::load_dict(DictionaryTrie& dict, istream& words, unsigned int num_words,
+        unsigned int num_threads)
+{
+    string buffer;
+    unsigned int lines = readChunks(words, buffer, num_words);
+    vector<pair<string_view, unsigned int>> entries;
+    entries.reserve(lines);
+    scanEntries(buffer, lines, [&](string_view word, unsigned int freq)
     {
-        if(words.eof()) break;
-        temp_word = "";
-        word = "";
-        data = data + " .";
-        istringstream iss(data);
-        iss >> junk;
-        while(1)
-        {
-            iss >> temp_word;
-            if(temp_word == ".") break;
-            if(temp_word.length() > 0) word_string.push_back(temp_word);
-        }
-        for(i = 0; i < word_string.size(); i++)
-        {
-            if(i > 0) word = word + " ";
-            word = word + word_string[i];
-        }
-        dict.push_back(word);
-        word_string.clear();
-    }
+        entries.push_back(std::make_pair(word, freq));
+    });
+    /** Bulk build keeps every sibling BST of the TST balanced */
+    dict.build(std::move(entries), num_threads);
+}
+
+
+/*
+ * Load the words in the file into the dictionary trie and the substring
+ * index. The file is parsed once and both are built from the same views.
+ */
+void Utils::load_dict(DictionaryTrie& dict, SubstringIndex& index, istream& words)
+{
+    string buffer;
+    unsigned int lines = readChunks(words, buffer, UINT_MAX);
+    vector<pair<string_view, unsigned int>> entries;
+    entries.reserve(lines);
+    scanEntries(buffer, lines, [&](string_view word, unsigned int freq)
+    {
+        entries.push_back(std::make_pair(word, freq));
+    });
+    index.build(entries);
+    dict.build(std::move(entries));
+}
+
+
+/*
+ * Load the words in the file into the adaptive radix tree, parsed in place
+ * as for the trie
+ */
+void Utils::load_dict(RadixDictionaryTrie& dict, istream& words)
+{
+    string buffer;
+    unsigned int lines = readChunks(words, buffer, UINT_MAX);
+    vector<pair<string_view, unsigned int>> entries;
+    entries.reserve(lines);
+    scanEntries(buffer, lines, [&](string_view word, unsigned int freq)
+    {
+        entries.push_back(std::make_pair(word, freq));
+    });
+    dict.build(std::move(entries));
+}
+
+
+void Utils::load_dict(vector<string>& dict, istream& words)
+{
+    string buffer;
+    unsigned int lines = readChunks(words, buffer, UINT_MAX);
+    dict.reserve(dict.size() + lines);
+    scanEntries(buffer, lines, [&](string_view word, unsigned int)
+    {
+        dict.push_back(string(word));
+    });
 }
@@ -3,6 +3,8 @@
 
 #include <chrono>
 #include "DictionaryTrie.hpp"
+#include "SubstringIndex.hpp"
+#include "RadixDictionaryTrie.hpp"
 #include <iostream>
 #include <vector>
 
@@ -30,6 +32,40 @@ public:
 
 };
 
+class CacheCounters{
+private:
+  int cacheMisses; /** perf_event fd counting last level cache misses */
+  int l1Misses; /** perf_event fd counting L1 data read misses */
+
+public:
+
+  /*
+   * Opens the hardware counters of the calling thread, in user space only.
+   * On a host or platform without them the counters are left unavailable.
+   */
+  CacheCounters();
+
+  ~CacheCounters();
+
+  /*
+   * Returns whether the cache miss counters could be opened
+   */
+  bool available() const;
+
+  /*
+   * Function called when starting the count.
+   */
+  void begin_count();
+
+  /*
+   * Function called when ending the count. Stores the misses since
+   * begin_count(), or -1 for a counter that is unavailable
+   * PRECONDITION: begin_count() must be called before this function
+   */
+  void end_count(long long& cache_misses, long long& l1_misses);
+
+};
+
 class Utils{
 public:
 
@@ -48,6 +84,27 @@ public:
     void static load_dict(DictionaryTrie& dict, istream& words, unsigned int num_words);
 
 
+    /*
+     * Load num_words from words stream into the dictionary, building the
+     * trie with num_threads threads
+     */
+    void static load_dict(DictionaryTrie& dict, istream& words, unsigned int num_words,
+            unsigned int num_threads);
+
+
+    /*
+     * Load the words in the file into both the dictionary and the index of
+     * the words by substring
+     */
+    void static load_dict(DictionaryTrie& dict, SubstringIndex& index, istream& words);
+
+
+    /*
+     * Load the words in the file into the adaptive radix tree engine
+     */
+    void static load_dict(RadixDictionaryTrie& dict, istream& words);
+
+
     void static load_dict(vector<string>& dict, istream& words);
 
 };